@@ -0,0 +1,3 @@
+
+#include "Cigar.cpp"
+
@@ -0,0 +1,3 @@
+
+#include "MapperStats.cpp"
+
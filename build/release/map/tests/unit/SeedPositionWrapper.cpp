@@ -0,0 +1,4 @@
+
+#include "SeedPositionMocks.hpp"
+#include "SeedPosition.cpp"
+
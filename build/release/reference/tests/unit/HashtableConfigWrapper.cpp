@@ -0,0 +1,4 @@
+
+#include "HashtableConfigMocks.hpp"
+#include "HashtableConfig.cpp"
+
@@ -0,0 +1,4 @@
+
+#include "CrcHasherMocks.hpp"
+#include "CrcHasher.cpp"
+
@@ -0,0 +1,4 @@
+
+#include "CrcPolynomialMocks.hpp"
+#include "CrcPolynomial.cpp"
+
@@ -0,0 +1,4 @@
+
+#include "SeedMocks.hpp"
+#include "Seed.cpp"
+
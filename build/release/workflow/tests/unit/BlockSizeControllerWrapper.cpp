@@ -0,0 +1,3 @@
+
+#include "BlockSizeController.cpp"
+
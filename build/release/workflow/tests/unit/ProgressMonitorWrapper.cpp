@@ -0,0 +1,4 @@
+
+#include "ProgressMonitorMocks.hpp"
+#include "ProgressMonitor.cpp"
+
@@ -60,6 +60,17 @@ GTEST_INCLUDEDIR?=$(GTEST_ROOT)/include
 GTEST_LIBRARYDIR?=$(GTEST_ROOT)/lib
 endif # ifneq(,$(GTEST_ROOT))
 
+############################################################
+##
+## Google benchmark, only needed for "make bench"
+##
+############################################################
+
+ifneq (,$(BENCHMARK_ROOT))
+BENCHMARK_INCLUDEDIR?=$(BENCHMARK_ROOT)/include
+BENCHMARK_LIBRARYDIR?=$(BENCHMARK_ROOT)/lib
+endif # ifneq(,$(BENCHMARK_ROOT))
+
 ############################################################
 ##
 ## Bamtools
@@ -209,6 +220,16 @@ endif # ifneq (,$(GTEST_LIBRARYDIR))
 
 GTEST_LDFLAGS+= -lgtest_main -lgtest
 
+ifneq (,$(BENCHMARK_INCLUDEDIR))
+BENCHMARK_CPPFLAGS+= -I $(BENCHMARK_INCLUDEDIR)
+endif
+
+ifneq (,$(BENCHMARK_LIBRARYDIR))
+BENCHMARK_LDFLAGS+= -L $(BENCHMARK_LIBRARYDIR)
+endif # ifneq (,$(BENCHMARK_LIBRARYDIR))
+
+BENCHMARK_LDFLAGS+= -lbenchmark_main -lbenchmark
+
 ############################################################
 ##
 ## Basic verification
@@ -0,0 +1,26 @@
+# building and running the microbenchmarks of the hot kernels
+#
+# make bench runs all of them from the root of the source tree and writes the results to
+# BENCH_OUT in json. BENCH_ARGS is passed as is to the benchmark, e.g.:
+#   make bench BENCH_ARGS=--benchmark_filter=SmithWaterman
+# The reference defaults to data/small/small-20k-repeats.v8 and can be changed with DRAGEN_OS_BENCH_REFERENCE
+
+BENCH_BUILD_DIR=$(BUILD)/bench
+BENCH_OUT?=$(BENCH_BUILD_DIR)/dragen-os-bench.json
+BENCH_ARGS?=
+
+bench_sources:=$(wildcard $(DRAGEN_OS_TEST_DIR)/bench/*.cpp)
+bench_objects:=$(bench_sources:$(DRAGEN_OS_TEST_DIR)/bench/%.cpp=$(BENCH_BUILD_DIR)/%.o)
+
+$(BENCH_BUILD_DIR)/%.o: $(DRAGEN_OS_TEST_DIR)/bench/%.cpp $(BENCH_BUILD_DIR)/%.d $(BENCH_BUILD_DIR)/.sentinel
+	$(CXX) $(DEPFLAGS) $(CPPFLAGS) $(BENCHMARK_CPPFLAGS) $(CXXFLAGS) -c -o $@ $<
+	$(POSTCOMPILE)
+
+$(BENCH_BUILD_DIR)/dragen-os-bench: $(bench_objects) $(libraries)
+	$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $(bench_objects) $(libraries) $(BENCHMARK_LDFLAGS) $(LDFLAGS)
+
+.PHONY: bench
+bench: $(BENCH_BUILD_DIR)/dragen-os-bench
+	cd $(DRAGEN_OS_ROOT_DIR) && $< --benchmark_out=$(BENCH_OUT) --benchmark_out_format=json $(BENCH_ARGS)
+
+include $(wildcard $(bench_objects:%.o=%.d))
@@ -0,0 +1,71 @@
+SHELL:=/bin/bash -o pipefail
+
+# end-to-end throughput of dragen-os on reads simulated from any reference,
+# self contained and runnable offline. After "make", e.g.:
+#   make -f make/throughput.mk FASTA=/path/to/genome.fa THREADS="1 4 16"
+# builds the hash table once, simulates the paired and single-end reads, runs
+# dragen-os with each thread count and writes the reports into
+# $(OUTPUT)/{pe,se}/throughput.{json,tsv}
+
+DRAGENOS_DIR:=$(shell pwd)
+DRAGEN:=$(DRAGENOS_DIR)/build/release/dragen-os
+SIMULATE:=$(DRAGENOS_DIR)/build/release/test/simulate
+THROUGHPUT:=$(DRAGENOS_DIR)/build/release/test/throughput
+
+FASTA:=
+OUTPUT:=$(DRAGENOS_DIR)/build/throughput
+REFERENCE:=$(OUTPUT)/reference
+THREADS:=1 2 4 8
+MODES:=pe se
+
+READS:=1000000
+READ_LENGTH:=151
+ERROR_RATE:=0.002
+INDEL_RATE:=0.0002
+INSERT_MEAN:=350
+INSERT_STDDEV:=50
+SEED:=1
+SIMULATE_PARAMS:=-n $(READS) -l $(READ_LENGTH) --error-rate $(ERROR_RATE) --indel-rate $(INDEL_RATE) \
+--insert-mean $(INSERT_MEAN) --insert-stddev $(INSERT_STDDEV) --seed $(SEED)
+
+#USER_PARAMS:= --Aligner.sw-all 1
+PARAMS:=--RGID rgid --RGSM rgsm $(USER_PARAMS)
+
+empty:=
+space:=$(empty) $(empty)
+comma:=,
+
+default: all
+
+ifeq (,$(FASTA))
+$(error FASTA must point to the reference to simulate the reads from)
+endif
+
+$(REFERENCE)/hash_table.cfg.bin:
+	mkdir -p $(REFERENCE) && $(DRAGEN) --build-hash-table true --ht-reference $(FASTA) \
+	--output-directory $(REFERENCE) > $(REFERENCE)/build.log 2>&1
+
+$(OUTPUT)/reads/pe_1.fastq:
+	mkdir -p $(@D) && $(SIMULATE) -f $(FASTA) -o $(@D)/pe --paired true $(SIMULATE_PARAMS)
+
+# both mates are simulated together
+$(OUTPUT)/reads/pe_2.fastq: $(OUTPUT)/reads/pe_1.fastq ;
+
+$(OUTPUT)/reads/se.fastq:
+	mkdir -p $(@D) && $(SIMULATE) -f $(FASTA) -o $(@D)/se --paired false $(SIMULATE_PARAMS)
+
+$(OUTPUT)/pe/throughput.json: $(REFERENCE)/hash_table.cfg.bin $(OUTPUT)/reads/pe_1.fastq $(OUTPUT)/reads/pe_2.fastq
+	$(THROUGHPUT) --dragen-os $(DRAGEN) -r $(REFERENCE) -1 $(OUTPUT)/reads/pe_1.fastq -2 $(OUTPUT)/reads/pe_2.fastq \
+	-o $(@D) -n $(READS) -t $(subst $(space),$(comma),$(strip $(THREADS))) -- $(PARAMS)
+
+$(OUTPUT)/se/throughput.json: $(REFERENCE)/hash_table.cfg.bin $(OUTPUT)/reads/se.fastq
+	$(THROUGHPUT) --dragen-os $(DRAGEN) -r $(REFERENCE) -1 $(OUTPUT)/reads/se.fastq \
+	-o $(@D) -n $(READS) -t $(subst $(space),$(comma),$(strip $(THREADS))) -- $(PARAMS)
+
+all: $(MODES:%=$(OUTPUT)/%/throughput.json)
+	for mode in $(MODES); do echo $$mode; cat $(OUTPUT)/$$mode/throughput.tsv; done
+
+clean:
+	-rm -r $(OUTPUT)/pe $(OUTPUT)/se $(OUTPUT)/reads
+
+.PHONY: default all clean
@@ -17,6 +17,8 @@
 
 #include <sys/mman.h>
 #include <functional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -24,9 +26,12 @@
 #include "align/AlignmentGenerator.hpp"
 #include "align/AlignmentRescue.hpp"
 #include "align/Alignments.hpp"
+#include "align/Database.hpp"
 #include "align/InsertSizeParameters.hpp"
 #include "align/PairBuilder.hpp"
+#include "align/Pairs.hpp"
 #include "align/SinglePicker.hpp"
+#include "align/SlowReadLog.hpp"
 #include "map/Mapper.hpp"
 #include "reference/Hashtable.hpp"
 #include "reference/HashtableConfig.hpp"
@@ -57,7 +62,9 @@ public:
       const int                      aln_cfg_mapq_min_len,
       const uint32_t                 alignerUnpairedPen,
       const double                   aln_cfg_filter_len_ratio,
-      const bool                     vectorizedSW);
+      const bool                     vectorizedSW,
+      const bool                     wavefrontSW,
+      const int                      wfaMaxEdits);
   typedef sequences::Read     Read;
   typedef sequences::ReadPair ReadPair;
   typedef align::Alignment    Alignment;
@@ -65,13 +72,32 @@ public:
   //typedef std::vector<Alignment> Alignments;
   //typedef align::AlignmentPair AlignmentPair;
   //typedef std::vector<AlignmentPair> AlignmentPairs;
-  void                     getAlignments(const Read& read, Alignments& alignments);
+  void getAlignments(const Read& read, Alignments& alignments, const SinglePicker& singlePicker);
   AlignmentPairs::iterator getAlignments(
       const ReadPair&             readPair,
       AlignmentPairs&             alignmentPairs,
       const InsertSizeParameters& insertSizeParameters,
       const PairBuilder&          pairBuilder);
   Alignments& unpaired(std::size_t readPosition) { return unpairedAlignments_.at(readPosition); }
+  /// number of Smith-Waterman alignments that turned out not to be needed for the output so far
+  std::size_t getSmithWatermanSkipped() const { return smithWatermanSkipped_; }
+  /// false to run Smith-Waterman on all the worthy alignments of single reads, in chain order, as a
+  /// reference for the output. true by default
+  void setSmithWatermanSkip(bool skip) { smithWatermanSkip_ = skip; }
+  /// bytes held by the Smith-Waterman query profiles of the current reads
+  std::size_t getSmithWatermanProfileBytes() const { return vectorSmithWaterman_.getProfileBytes(); }
+  /// hash table access counters of the reads mapped so far
+  const map::MapperStats& getMapperStats() const { return mapper_.getStats(); }
+  /// record the calls to getAlignments that take at least the threshold of the log. nullptr for none
+  void setSlowReadLog(SlowReadLog* slowReadLog) { slowReadLog_ = slowReadLog; }
+  /// hold the slow reads back into pending instead of recording them. nullptr to record them
+  void setSlowReadPending(SlowReadLog::Pending* pending) { slowReadPending_ = pending; }
+  /// true if the chains of the read at readPosition in the last call to getAlignments have random
+  /// samples, which makes the results depend on the read name
+  bool hasRandomSamples(std::size_t readPosition) const
+  {
+    return 0 != chainBuilders_.at(readPosition).getRandomSampleHits();
+  }
   /// generate ungapped alignments from the seed chains
   void generateUngappedAlignments(const Read& read, map::ChainBuilder& chainBuilder, Alignments& alignments);
   void runSmithWatermanAll(
@@ -121,6 +147,10 @@ public:
   /// calculate potential score, assuming that the soft clip regions are improved with a gap
   unsigned calculatePotentialScore(
       const Read& read, const unsigned score, const unsigned softClipTo, const unsigned softClipFrom) const;
+  /// upper bound of the Smith-Waterman score of an ungapped alignment: improving on the ungapped score of
+  /// the aligned bases or aligning a soft clip region takes at least a gap. Unlike the potential score,
+  /// it is never exceeded
+  ScoreType calculateMaxScore(const Alignment& ungapped) const;
   /// filter overlapping alignments sharing a start or end position
   void filter(Alignments& alignments);
   /**
@@ -157,11 +187,43 @@ private:
   const int                 aln_cfg_unpaired_pen_;
   SmithWaterman             smithWaterman_;
   VectorSmithWaterman       vectorSmithWaterman_;
+  WfaAligner                wfaAligner_;
   std::array<Alignments, 2> unpairedAlignments_;
+  /// mate alignment being rescued, reused to keep the storage of its cigar
+  Alignment rescued_;
   AlignmentGenerator        alignmentGenerator_;
 
   std::array<map::ChainBuilder, 2> chainBuilders_;
 
+  /// seed chains of read 1 indexed for pairMatch
+  PairMatchFinder       pairMatchFinder_;
+  std::vector<unsigned> pairMatches_;
+  std::vector<unsigned> pairCandidates_;
+  /// alignment winning at each reference position while filtering
+  std::unordered_map<uint64_t, unsigned> filterWinners_;
+  /// reference window of the ungapped alignment being scored, the part of it the cigar covers and
+  /// the operations of the cigar
+  Database    ungappedReference_;
+  Database    ungappedDatabase_;
+  std::string ungappedOperations_;
+
+  /// order in which the alignments go through Smith-Waterman
+  std::vector<unsigned> smithWatermanSchedule_;
+  /// alignments still waiting for Smith-Waterman. For read pairs, the alignments of read 1 follow the
+  /// ones of read 0
+  std::vector<bool> smithWatermanPending_;
+  /// the alignments of the read that went through Smith-Waterman or did not need it
+  SinglePicker::SettledAlignments smithWatermanSettled_;
+  std::size_t                     smithWatermanSkipped_;
+  bool                            smithWatermanSkip_;
+
+  SlowReadLog*          slowReadLog_;
+  SlowReadLog::Pending* slowReadPending_;
+  /// rescue attempts so far
+  std::size_t rescues_;
+  /// times a call to getAlignments, for the slow read log
+  class SlowReadTimer;
+
   /// generate all the ungapped allignments for the seed chains
   void buildUngappedAlignments(map::ChainBuilder& chainBuilder, const Read& read, Alignments& alignments);
 
@@ -196,7 +258,17 @@ private:
       Alignment&                  anchoredAlignment,
       const AlignmentRescue       alignmentRescue,
       AlignmentPairs&             alignmentPairs);
-  void runSmithWatermanWorthy(const Read& read, map::ChainBuilder& chainBuilder, Alignments& alignments);
+  /**
+   ** \brief Smith-Waterman on the alignments that could improve, by decreasing potential score
+   **
+   ** Stops as soon as the potential score of the next alignment can't change anything that the
+   ** singlePicker would produce from the alignments.
+   **/
+  void runSmithWatermanWorthy(
+      const Read&         read,
+      map::ChainBuilder&  chainBuilder,
+      Alignments&         alignments,
+      const SinglePicker& singlePicker);
   void updateIneligibility(
       const reference::HashtableConfig& hashtableConfig,
       const size_t                      referenceOffset,
@@ -14,6 +14,7 @@
 
 #ifndef ALIGN_ALIGNMENT_HPP
 #define ALIGN_ALIGNMENT_HPP
+#include <array>
 
 #include <boost/iterator/reverse_iterator.hpp>
 #include <string>
@@ -176,6 +177,16 @@ public:
   }
 
   const AlignmentHeader& header() const { return *this; }
+  AlignmentHeader&       header() { return *this; }
+
+  /// back to the state of a default constructed alignment, keeping the storage of the cigar
+  void reset(FlagType flags = 0, ScoreType score = -1)
+  {
+    header() = AlignmentHeader(flags, score);
+    cigar_.clear();
+    sa_         = 0;
+    ineligible_ = false;
+  }
 
   int64_t getUnclippedAlignmentCoordinate() const
   {
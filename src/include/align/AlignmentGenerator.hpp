@@ -15,8 +15,12 @@
 #ifndef ALIGN_ALIGNMENT_GENERATOR_HPP
 #define ALIGN_ALIGNMENT_GENERATOR_HPP
 
+#include <string>
+
 #include "align/Alignments.hpp"
+#include "align/Database.hpp"
 #include "align/VectorSmithWaterman.hpp"
+#include "align/WfaAligner.hpp"
 #include "map/ChainBuilder.hpp"
 #include "reference/ReferenceDir.hpp"
 #include "sequences/Read.hpp"
@@ -32,28 +36,44 @@ public:
       const reference::ReferenceDir& referenceDir,
       SmithWaterman&                 smithWaterman,
       VectorSmithWaterman&           vectorSmithWaterman,
-      bool                           vectorizedSW)
+      WfaAligner&                    wfaAligner,
+      bool                           vectorizedSW,
+      bool                           wavefrontSW)
     : referenceDir_(referenceDir),
       smithWaterman_(smithWaterman),
       vectorSmithWaterman_(vectorSmithWaterman),
-      vectorizedSW_(vectorizedSW)
+      wfaAligner_(wfaAligner),
+      vectorizedSW_(vectorizedSW),
+      wavefrontSW_(wavefrontSW),
+      alignmentCount_(0)
   {
   }
   /// delegate for the Aligner generateAlignments method
   void generateAlignments(
       const Read& read, const map::ChainBuilder& chainBuilder, Alignments& alignments, const int readIdx);
   bool generateAlignment(
-      const ScoreType alnMinScore,
-      const Read&     read,
-      map::SeedChain  seedChain,
-      Alignment&      alignment,
-      const int       readIdx);
+      const ScoreType       alnMinScore,
+      const Read&           read,
+      const map::SeedChain& seedChain,
+      Alignment&            alignment,
+      const int             readIdx);
+  /// number of gapped alignments attempted on unfiltered seed chains so far
+  std::size_t getAlignmentCount() const { return alignmentCount_; }
 
 private:
   const reference::ReferenceDir& referenceDir_;
   SmithWaterman&                 smithWaterman_;
   VectorSmithWaterman&           vectorSmithWaterman_;
+  WfaAligner&                    wfaAligner_;
   const bool                     vectorizedSW_;
+  /// try the wavefront alignment first, falling back to Smith-Waterman beyond its edit limit
+  const bool  wavefrontSW_;
+  std::size_t alignmentCount_;
+  /// scratch storage of generateAlignment, reused from one call to the next: the seed chain adjusted
+  /// to the fetch window, the reference bases of the window and the operations of the alignment
+  map::SeedChain fetchChain_;
+  Database       database_;
+  std::string    operations_;
   void updateFetchChain(const Read& read, map::SeedChain& seedChain, Alignment& alignment);
 };  // class AlignmentGenerator
 
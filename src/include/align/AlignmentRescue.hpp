@@ -188,13 +188,34 @@ public:
    **/
   std::array<RescueKmer, 2> getRescueKmers(const Read& rescuedRead, signed modOffset) const;
 
+  /// one bit vector per bit of the 4 bits base encoding, indexed by position in the reference interval
+  typedef std::array<std::vector<uint64_t>, 4> BitPlanes;
   /**
-   ** \brief load the rescue kmer into a mm128i vector for SIMD scanning
+   ** \brief transpose the reference interval into bit planes for the bit-parallel scan
+   **
+   ** Ns on the reference are cleared so that they never match. The planes are padded with enough zero
+   ** words to extract 64 bits at any position of the interval.
    **/
+  void getBitPlanes(const std::vector<unsigned char>& referenceBases, BitPlanes& bitPlanes) const;
 
-  __m128i loadRescueKmer(AlignmentRescue::RescueKmer rescueKmer) const;
-
-  __m128i loadRefKmer(std::vector<unsigned char>::const_iterator refIter, size_t size) const;
+  /**
+   ** \brief bit-parallel scan of a rescue kmer over scanLength consecutive offsets of the reference
+   **
+   ** The number of matching bits between the kmer and the reference is accumulated for 64 offsets at a
+   ** time into bit-sliced counters. Only the offsets that could improve bestCount are extracted and
+   ** checked, in increasing order, which yields the same bestCount, bestOffset and conflict as checking
+   ** every offset one after the other.
+   **
+   ** \param start position of the first offset in the reference interval
+   **/
+  void scanKmer(
+      const RescueKmer& rescueKmer,
+      const BitPlanes&  bitPlanes,
+      const size_t      start,
+      const int         scanLength,
+      int&              bestCount,
+      int&              bestOffset,
+      bool&             conflict) const;
 
   /**
    ** \brief count mismatches between the kmer and the reference
@@ -15,6 +15,10 @@
 #ifndef ALIGN_ALIGNMENTS_HPP
 #define ALIGN_ALIGNMENTS_HPP
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
 #include "align/Alignment.hpp"
 #include "align/SimilarityScores.hpp"
 #include "align/SmithWaterman.hpp"
@@ -29,23 +33,85 @@ namespace align {
  ** The container exposes a range of valid alignments via the begin() and end()
  ** methods. Otherwise, management of the underlying collection of Alignment
  ** instances is hidden to enable localized caching.
+ **
+ ** The Alignment instances are never destroyed by clear() or by shrinking: they
+ ** are reset and reused, together with the storage of their cigar, when the
+ ** container grows again. Reused from one read to the next by the same thread,
+ ** the container stops allocating once it has seen the largest read.
  **/
-class Alignments : public std::vector<Alignment> {
+class Alignments {
+  typedef std::vector<Alignment> Storage;
+
 public:
-  Alignments()
+  typedef Storage::value_type      value_type;
+  typedef Storage::reference       reference;
+  typedef Storage::const_reference const_reference;
+  typedef Storage::iterator        iterator;
+  typedef Storage::const_iterator  const_iterator;
+  typedef Storage::size_type       size_type;
+
+  Alignments() : size_(0)
   {
     // TODO: fix the resizing issue in pair builder
     reserve(100000);
   }
-  typedef std::vector<Alignment>::iterator       iterator;
-  typedef std::vector<Alignment>::const_iterator const_iterator;
-  Alignment&                                     addAlignment()
+  Alignments(const Alignments& that) : storage_(that.begin(), that.end()), size_(that.size_) {}
+  Alignments& operator=(const Alignments& that)
+  {
+    resize(that.size_);
+    std::copy(that.begin(), that.end(), begin());
+    return *this;
+  }
+
+  iterator        begin() { return storage_.begin(); }
+  iterator        end() { return storage_.begin() + size_; }
+  const_iterator  begin() const { return storage_.begin(); }
+  const_iterator  end() const { return storage_.begin() + size_; }
+  size_type       size() const { return size_; }
+  bool            empty() const { return !size_; }
+  reference       at(size_type i) { return storage_[checkIndex(i)]; }
+  const_reference at(size_type i) const { return storage_[checkIndex(i)]; }
+  reference       operator[](size_type i) { return storage_[i]; }
+  const_reference operator[](size_type i) const { return storage_[i]; }
+  reference       front() { return storage_.front(); }
+  const_reference front() const { return storage_.front(); }
+  reference       back() { return storage_[size_ - 1]; }
+  const_reference back() const { return storage_[size_ - 1]; }
+  void            reserve(size_type capacity) { storage_.reserve(capacity); }
+  /// forget the alignments, keeping the instances for reuse
+  void clear() { size_ = 0; }
+  /// the new alignments are in their default state
+  void resize(size_type size)
+  {
+    for (size_type i = size_; size > i && storage_.size() > i; ++i) {
+      storage_[i].reset();
+    }
+    if (size > storage_.size()) {
+      storage_.resize(size);
+    }
+    size_ = size;
+  }
+
+  Alignment& addAlignment()
   {
-    resize(size() + 1);
+    resize(size_ + 1);
     return back();
   }
 
-  void append(const Alignment& a) { push_back(a); }
+  void append(const Alignment& a) { addAlignment() = a; }
+  void pop_back() { --size_; }
+
+private:
+  Storage   storage_;
+  size_type size_;
+
+  size_type checkIndex(size_type i) const
+  {
+    if (size_ <= i) {
+      throw std::out_of_range("Alignments::at");
+    }
+    return i;
+  }
 };
 
 }  // namespace align
@@ -15,6 +15,9 @@
 #ifndef ALIGN_INSERT_SIZE_DISTRIBUTION_HPP
 #define ALIGN_INSERT_SIZE_DISTRIBUTION_HPP
 
+#include <iostream>
+#include <string>
+
 #include "align/InsertSizeParameters.hpp"
 
 #include "host/dragen_api/sampling/readgroup_insert_stats.hpp"
@@ -24,6 +27,7 @@ namespace align {
 
 class InsertSizeDistribution {
   bool                 samplingEnabled_;
+  uint32_t             peOrientation_;
   ReadGroupInsertStats dragenInsertStats_;
   StatsInterval        fixedStats_;
 
@@ -52,9 +56,28 @@ public:
   //  const InsertSizeParameters& getInsertSizeParameters() const { return insertSizeParameters_; }
   InsertSizeParameters getInsertSizeParameters(std::size_t r1ReadLen);
   void add(const align::SerializedAlignment& aln, const dragenos::sequences::SerializedRead& read);
+  /// false when the parameters are fixed and add has nothing to do
+  bool isSamplingEnabled() const { return samplingEnabled_; }
   bool notGoingToBlock() { return !dragenInsertStats_.justSentAllInitRecords(); }
   void forceInitDoneSending();
 
+  /**
+   ** \brief write the insert size model of the read group
+   **
+   ** One header line and one tab-separated line with the read group, the orientation
+   ** and the stats currently in use, for loadModel in later runs on the same library.
+   **/
+  void saveModel(std::ostream& os, const std::string& readGroup) const;
+  void saveModel(const std::string& path, const std::string& readGroup) const;
+  /**
+   ** \brief start from a model saved by a previous run instead of sampling the first pairs
+   **
+   ** Must be called before getInsertSizeParameters. With sampling enabled, the model
+   ** keeps updating when continuous update is on. Otherwise the model is used as is.
+   **/
+  void loadModel(std::istream& is, const std::string& readGroup);
+  void loadModel(const std::string& path, const std::string& readGroup);
+
   friend std::ostream& operator<<(std::ostream& os, InsertSizeDistribution& d)
   {
     if (d.samplingEnabled_) {
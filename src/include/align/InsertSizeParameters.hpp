@@ -84,6 +84,15 @@ struct InsertSizeParameters {
   {
   }
 
+  /// same parameters produce the same pairing, rescue and MAPQ decisions
+  bool operator==(const InsertSizeParameters& that) const
+  {
+    return min_ == that.min_ && max_ == that.max_ && mean_ == that.mean_ && rescueMin_ == that.rescueMin_ &&
+           rescueMax_ == that.rescueMax_ && sigmaFactor_ == that.sigmaFactor_ &&
+           orientation_ == that.orientation_ && isInitStatDone_ == that.isInitStatDone_;
+  }
+  bool operator!=(const InsertSizeParameters& that) const { return !(*this == that); }
+
   friend std::ostream& operator<<(std::ostream& os, const InsertSizeParameters& isp)
   {
     return os << "InsertSizeParameters(" << isp.min_ << "," << isp.max_ << "," << isp.mean_ << ","
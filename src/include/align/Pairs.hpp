@@ -15,13 +15,36 @@
 #ifndef ALIGN_PAIRS_HPP
 #define ALIGN_PAIRS_HPP
 
+#include <vector>
+
+#include "align/Alignment.hpp"
 #include "align/InsertSizeParameters.hpp"
+#include "map/ChainBuilder.hpp"
 #include "map/SeedChain.hpp"
 #include "sequences/ReadPair.hpp"
 
 namespace dragenos {
 namespace align {
 
+/**
+ ** \brief constraints on the second seed chain for a pair match with the first one
+ **
+ ** The second seed chain matches if it has the expected orientation and either its effective
+ ** begin is in [minBegin, maxBegin] or its effective end is at least minEnd while its effective
+ ** begin is at most maxEnd.
+ **/
+struct PairMatchWindow {
+  bool reverseComplement;
+  int  minBegin;
+  int  maxBegin;
+  int  minEnd;
+  int  maxEnd;
+};
+
+PairMatchWindow getPairMatchWindow(
+    const InsertSizeParameters& insertSizeParameters,
+    const sequences::ReadPair&  readPair,
+    const map::SeedChain&       first);
 bool pairMatch(
     const InsertSizeParameters& insertSizeParameters,
     const sequences::ReadPair&  readPair,
@@ -29,6 +52,41 @@ bool pairMatch(
     const map::SeedChain&       second);
 std::pair<int, int> calculateEffBegEnd(const sequences::Read& read, const map::SeedChain& chain);
 
+/**
+ ** \brief finds the seed chains of the second read that pairMatch a seed chain of the first read
+ **
+ ** The seed chains of the second read are sorted by orientation and effective begin once, so that
+ ** each lookup only checks the chains within the insert size window of the first seed chain.
+ **/
+class PairMatchFinder {
+public:
+  /// index the seed chains of the second read
+  void reset(
+      const InsertSizeParameters& insertSizeParameters,
+      const sequences::ReadPair&  readPair,
+      const map::ChainBuilder&    secondChains);
+  /// indexes of the seed chains of the second read that pairMatch first, in increasing order
+  void find(const map::SeedChain& first, std::vector<unsigned>& matches) const;
+
+private:
+  struct Mate {
+    bool     reverseComplement;
+    int      begin;
+    int      end;
+    unsigned index;
+    bool     operator<(const Mate& other) const
+    {
+      return reverseComplement < other.reverseComplement ||
+             (reverseComplement == other.reverseComplement && begin < other.begin);
+    }
+  };
+  const InsertSizeParameters* insertSizeParameters_ = nullptr;
+  const sequences::ReadPair*  readPair_             = nullptr;
+  std::vector<Mate>           mates_;
+  /// largest effective end - effective begin amongst the mates
+  int maxSpan_ = 0;
+};
+
 bool pairMatch(
     const InsertSizeParameters& insert_stats, const Alignment& inp_result, const Alignment& result_rrec);
 
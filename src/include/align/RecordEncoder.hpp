@@ -0,0 +1,51 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef ALIGN_RECORD_ENCODER_HPP
+#define ALIGN_RECORD_ENCODER_HPP
+
+#include <iostream>
+#include <string>
+
+#include "align/Alignment.hpp"
+#include "align/Sam.hpp"
+#include "sequences/Read.hpp"
+
+namespace dragenos {
+namespace align {
+
+/**
+ ** \brief formats the records of a RecordStream into the output file format
+ **/
+class RecordEncoder {
+public:
+  virtual ~RecordEncoder() {}
+  virtual void encode(
+      std::ostream& os, const sequences::SerializedRead& read, const SerializedAlignment& alignment) = 0;
+};
+
+class SamRecordEncoder : public RecordEncoder {
+  const Sam&        sam_;
+  const std::string rgid_;
+
+public:
+  SamRecordEncoder(const Sam& sam, const std::string& rgid) : sam_(sam), rgid_(rgid) {}
+  void encode(
+      std::ostream& os, const sequences::SerializedRead& read, const SerializedAlignment& alignment) override;
+};
+
+}  // namespace align
+}  // namespace dragenos
+
+#endif  // #ifndef ALIGN_RECORD_ENCODER_HPP
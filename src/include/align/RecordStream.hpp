@@ -0,0 +1,68 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef ALIGN_RECORD_STREAM_HPP
+#define ALIGN_RECORD_STREAM_HPP
+
+#include <vector>
+
+#include "align/Alignment.hpp"
+#include "sequences/Read.hpp"
+
+namespace dragenos {
+namespace align {
+
+/**
+ ** \brief compact binary output records, each a SerializedRead followed by its SerializedAlignment
+ **
+ ** Produced once per alignment by the aligning thread. The same records then feed the mapping
+ ** metrics, the insert size sampling and the RecordEncoder that formats the output.
+ **/
+class RecordStream {
+public:
+  void        clear() { buffer_.clear(); }
+  bool        empty() const { return buffer_.empty(); }
+  std::size_t getByteSize() const { return buffer_.size(); }
+
+  void append(const sequences::Read& read, const Alignment& alignment)
+  {
+    const std::size_t readOffset      = buffer_.size();
+    const std::size_t alignmentOffset = readOffset + sequences::SerializedRead::getByteSize(read);
+    buffer_.resize(alignmentOffset + SerializedAlignment::getByteSize(alignment));
+    // resize can invalidate references...
+    *reinterpret_cast<sequences::SerializedRead*>(&buffer_[readOffset]) << read;
+    *reinterpret_cast<SerializedAlignment*>(&buffer_[alignmentOffset]) << alignment;
+  }
+
+  /// call f(const SerializedRead&, const SerializedAlignment&) for each record, in the order of append
+  template <typename F>
+  void forEach(F f) const
+  {
+    for (const char* p = buffer_.data(); buffer_.data() + buffer_.size() != p;) {
+      const sequences::SerializedRead& read = *reinterpret_cast<const sequences::SerializedRead*>(p);
+      p += read.getByteSize();
+      const SerializedAlignment& alignment = *reinterpret_cast<const SerializedAlignment*>(p);
+      p += alignment.getByteSize();
+      f(read, alignment);
+    }
+  }
+
+private:
+  std::vector<char> buffer_;
+};
+
+}  // namespace align
+}  // namespace dragenos
+
+#endif  // #ifndef ALIGN_RECORD_STREAM_HPP
@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include "align/Alignment.hpp"
+#include "reference/HashtableConfig.hpp"
 #include "sequences/Read.hpp"
 
 namespace dragenos {
@@ -80,10 +80,7 @@ public:
   template <typename StoreOp>
   bool findSecondary(const int readLength, Alignments& alignments, const Alignment* best, StoreOp store) const
   {
-    const int m2a_scale = mapq2aln(similarity_.getSnpCost(), std::max(aln_cfg_mapq_min_len_, readLength));
-    const ScoreType scaled_max_pen = (m2a_scale * aln_cfg_sec_phred_delta_) >> 10;  //27;
-    const ScoreType sec_aln_delta  = std::max(scaled_max_pen, aln_cfg_sec_score_delta_);
-    //    std::cerr << "scaled_max_pen:" << scaled_max_pen << std::endl;
+    const ScoreType sec_aln_delta = getSecAlnDelta(readLength);
 
     if (aln_cfg_sec_aligns_hard_) {
       int secAligns = 0;
@@ -112,8 +109,75 @@ public:
     return true;
   }
 
+  /**
+   * \brief the alignments that are no longer pending, with the ones getMinRelevantScore looks at
+   *
+   * Kept up to date as the alignments settle one at a time, so that going through the pending alignments
+   * does not rescan all of them for each one. Only a new best alignment or a new supplementary candidate
+   * triggers a rescan. Settled alignments must not change. Reused from one read to the next to keep the
+   * storage.
+   */
+  class SettledAlignments {
+  public:
+    /// start over with the alignments that are not pending
+    void reset(const Alignments& alignments, const std::vector<bool>& pending);
+    /// the pending alignment at index i is final
+    void settle(std::size_t i);
+
+    /// highest scoring settled alignment, first one on ties. nullptr if none
+    const Alignment* getBest() const { return best_; }
+    /// highest scoring settled alignment findSecondBestScore could pick for the best one. nullptr if none
+    const Alignment* getSecondBest() const { return secondBest_; }
+    /// settled alignment findSupplementary would pick for the best one. nullptr if none
+    const Alignment* getSupplementary() const { return supplementary_; }
+    /// highest scoring settled alignment findSecondBestScore could pick for the supplementary one
+    const Alignment* getSupplementarySecondBest() const { return supplementarySecondBest_; }
+    /// true if a pending alignment does not overlap the best one, or has no cigar yet
+    bool hasPendingOutsideBest() const { return 0 != pendingOutsideBest_; }
+
+  private:
+    const Alignments* alignments_ = nullptr;
+    std::vector<bool> pending_;
+    /// pending alignments counted in pendingOutsideBest_
+    std::vector<bool> outsideBest_;
+    std::size_t       pendingOutsideBest_      = 0;
+    const Alignment*  best_                    = nullptr;
+    const Alignment*  secondBest_              = nullptr;
+    const Alignment*  supplementary_           = nullptr;
+    const Alignment*  supplementarySecondBest_ = nullptr;
+
+    /// rescan the alignments for everything that depends on the best one
+    void updateBest();
+    /// highest scoring settled alignment compatible with the primary, as findSecondBestScore and
+    /// findSupplementary see them. First one on ties
+    const Alignment* findSettledBest(const Alignment& primary, const bool overlap) const;
+  };
+
+  /**
+   * \brief lowest score at which a pending alignment could still change the primary, secondary or
+   * supplementary alignments, their MAPQ or their XS, given the alignments that are not pending
+   *
+   * The caller compares it with an upper bound of the final score of each pending alignment. Pending
+   * alignments that already overlap the primary are assumed to not become supplementary.
+   * The sub_count contribution to the MAPQ is ignored as the resulting penalty is always 0 for any
+   * practical number of alignments.
+   *
+   * \return INVALID_SCORE if all the alignments are pending
+   */
+  ScoreType getMinRelevantScore(const int readLength, const SettledAlignments& settled) const;
+  /// same as above, from scratch
+  ScoreType getMinRelevantScore(
+      const int readLength, const Alignments& alignments, const std::vector<bool>& pending) const;
+
 private:
-  void updateMapq(const int readLength, Alignments& alignments, Alignments::iterator best) const;
+  void      updateMapq(const int readLength, Alignments& alignments, Alignments::iterator best) const;
+  ScoreType getSecAlnDelta(const int readLength) const
+  {
+    const int m2a_scale = mapq2aln(similarity_.getSnpCost(), std::max(aln_cfg_mapq_min_len_, readLength));
+    const ScoreType scaled_max_pen = (m2a_scale * aln_cfg_sec_phred_delta_) >> 10;  //27;
+    //    std::cerr << "scaled_max_pen:" << scaled_max_pen << std::endl;
+    return std::max(scaled_max_pen, aln_cfg_sec_score_delta_);
+  }
 };
 
 ScoreType findSecondBestScore(
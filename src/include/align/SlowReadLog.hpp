@@ -0,0 +1,90 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef ALIGN_SLOW_READ_LOG_HPP
+#define ALIGN_SLOW_READ_LOG_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "sequences/Read.hpp"
+
+namespace dragenos {
+namespace align {
+
+/**
+ ** \brief tab separated record of the reads that take too long to align
+ **
+ ** One line per read (or pair) for which Aligner::getAlignments takes at least the threshold,
+ ** with the work that went into it: the seed chains, including the rescued ones, the calls to
+ ** the Smith-Waterman (or wavefront) aligner and the rescue attempts. Meant to collect the
+ ** pathological reads of real inputs, to build regression inputs out of them.
+ **
+ ** Shared by the aligners of all the threads. Only the slow reads take the lock. The reads aligned
+ ** speculatively can be held back in a Pending until the alignment turns out to be the final one.
+ **/
+class SlowReadLog {
+public:
+  /// work done by the aligner for one read or pair
+  struct Counters {
+    std::size_t chains             = 0;
+    std::size_t smithWatermanCalls = 0;
+    std::size_t rescues            = 0;
+  };
+
+  /// lines held back, for instance while the alignment of a block might still be redone
+  class Pending {
+  public:
+    /// drop the lines held so far
+    void clear();
+
+  private:
+    friend class SlowReadLog;
+    std::mutex  mutex_;
+    std::string lines_;
+    std::size_t count_ = 0;
+  };
+
+  /// \param threshold nanoseconds from which a read gets recorded
+  SlowReadLog(std::ostream& os, uint64_t threshold);
+  SlowReadLog(const SlowReadLog&) = delete;
+  SlowReadLog& operator=(const SlowReadLog&) = delete;
+
+  uint64_t getThreshold() const { return threshold_; }
+  bool     isSlow(uint64_t nanoseconds) const { return threshold_ <= nanoseconds; }
+  /// record the read and its mate, if any, or hold them back into pending if not nullptr
+  void add(
+      const sequences::Read& read,
+      const sequences::Read* mate,
+      const Counters&        counters,
+      uint64_t               nanoseconds,
+      Pending*               pending = nullptr);
+  /// record the lines held back into pending and clear it
+  void record(Pending& pending);
+  /// number of reads (or pairs) recorded so far
+  std::size_t getCount() const;
+
+private:
+  std::ostream&      os_;
+  const uint64_t     threshold_;
+  mutable std::mutex mutex_;
+  std::size_t        count_;
+};
+
+}  // namespace align
+}  // namespace dragenos
+
+#endif  // #ifndef ALIGN_SLOW_READ_LOG_HPP
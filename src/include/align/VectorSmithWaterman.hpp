@@ -78,6 +78,8 @@ public:
 
   void initReadContext(const unsigned char* queryBegin, const unsigned char* queryEnd, int readIdx);
   void destroyReadContext(int readIdx);
+  /// bytes held by the query profiles of the reads in context
+  std::size_t getProfileBytes() const;
 
 private:
   std::string convert_cigar(const s_align& s_al, const int& query_len);
@@ -0,0 +1,123 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef ALIGN_WFA_ALIGNER_HPP
+#define ALIGN_WFA_ALIGNER_HPP
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "align/Score.hpp"
+#include "align/SimilarityScores.hpp"
+
+namespace dragenos {
+namespace align {
+
+/**
+ ** \brief gap-affine wavefront alignment (WFA) of a read against a reference window
+ **
+ ** The whole query is aligned, with soft clips allowed at both ends, against any
+ ** portion of the database. The scoring is the same as for the Smith-Waterman
+ ** implementations: similarity scores, gap init and gap extend and the unclip score
+ ** rewarding the alignments that reach the ends of the query.
+ **
+ ** The maximization of the score is turned into the minimization of a penalty, the
+ ** difference to the score of a perfect match over the whole query:
+ **   - mismatch: match - mismatch (match - nScore when an N is involved)
+ **   - insertion of L bases: gapInit + (L - 1) * gapExtend + L * match
+ **   - deletion of L bases: gapInit + (L - 1) * gapExtend
+ **   - soft clip of L bases: unclipScore + L * match
+ ** The wavefronts hold, for each penalty and each diagonal, the furthest reaching
+ ** database offset. The cost is proportional to the read length times the penalty
+ ** of the alignment, instead of the read length times the band width.
+ **
+ ** Only the diagonals in the given range are explored. The search is abandonned
+ ** when the penalty exceeds maxEdits mismatches, leaving the alignment to one of
+ ** the Smith-Waterman implementations.
+ **/
+class WfaAligner {
+public:
+  WfaAligner(
+      const SimilarityScores& similarity,
+      const int               gapInit,
+      const int               gapExtend,
+      const int               unclipScore,
+      const int               maxEdits);
+
+  /**
+   ** \brief align the query against the database
+   **
+   ** \param reverseQuery align the query from end to begin
+   ** \param diagonalBegin first diagonal to explore, as database offset - query offset
+   ** \param diagonalEnd one past the last diagonal to explore
+   ** \param operations on success, the operations in the same format as VectorSmithWaterman::align:
+   **        one 'N' for each database base before the alignment, then one operation per base
+   ** \param score on success, the alignment score without the unclip bonus, as returned by
+   **        VectorSmithWaterman::align
+   ** \return false if the alignment could not be found within maxEdits
+   **/
+  bool align(
+      const unsigned char* queryBegin,
+      const unsigned char* queryEnd,
+      const unsigned char* databaseBegin,
+      const unsigned char* databaseEnd,
+      const bool           reverseQuery,
+      const int            diagonalBegin,
+      const int            diagonalEnd,
+      std::string&         operations,
+      ScoreType&           score);
+
+private:
+  /// the operation that reached a cell of the wavefronts
+  enum Source : unsigned char { START, MISMATCH, MISMATCH_N, INSERTION, DELETION, OPEN, EXTEND };
+
+  const SimilarityScores similarity_;
+  const int              gapInit_;
+  const int              gapExtend_;
+  const int              unclipScore_;
+  const int              mismatchPenalty_;
+  const int              mismatchNPenalty_;
+  const int              insertionOpenPenalty_;
+  const int              insertionExtendPenalty_;
+  const int              deletionOpenPenalty_;
+  const int              deletionExtendPenalty_;
+  const int              maxPenalty_;
+
+  // the current alignment problem
+  std::vector<unsigned char> query_;
+  const unsigned char*       database_;
+  int                        databaseSize_;
+  int                        diagonalBegin_;
+  int                        width_;
+
+  // furthest reaching database offsets for each penalty and diagonal
+  std::vector<int>    m_;
+  std::vector<int>    i_;
+  std::vector<int>    d_;
+  std::vector<Source> mSource_;
+  std::vector<Source> iSource_;
+  std::vector<Source> dSource_;
+
+  static bool isN(const unsigned char base) { return 0xF == base || 0 == base; }
+  int         get(const std::vector<int>& wavefront, const int penalty, const int diagonal) const;
+  void        computeWavefront(const int penalty);
+  void        traceback(int penalty, int diagonal, std::string& operations) const;
+  ScoreType   getScore(const std::string& operations) const;
+};
+
+}  // namespace align
+}  // namespace dragenos
+
+#endif  // #ifndef ALIGN_WFA_ALIGNER_HPP
@@ -0,0 +1,100 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_ASYNC_WRITER_HPP
+#define COMMON_ASYNC_WRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace dragenos {
+namespace common {
+
+/**
+ ** \brief writes the buffers handed over by the workers from a dedicated thread
+ **
+ ** The workers only block when the queue holds maxQueueBytes already, which is the backpressure
+ ** from a slow filesystem or downstream pipe. The buffer being written counts in the queue until
+ ** its write completes, so that the queued bytes never exceed the larger of maxQueueBytes and
+ ** the largest buffer. The buffers are written in the order they are handed over and their
+ ** storage is recycled back to the workers.
+ **/
+class AsyncWriter {
+public:
+  struct Stats {
+    uint64_t    bytes          = 0;
+    uint64_t    writes         = 0;
+    double      writeSeconds   = 0.0;
+    /// number of times and total time the workers were blocked on the full queue
+    uint64_t    stalls         = 0;
+    double      stallSeconds   = 0.0;
+    std::size_t peakQueueBytes = 0;
+  };
+
+  AsyncWriter(std::ostream& os, std::size_t maxQueueBytes);
+  /// stops the writer thread. Errors are only reported by close
+  ~AsyncWriter();
+  AsyncWriter(const AsyncWriter&) = delete;
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+  /**
+   ** \brief queue the content of the buffer for writing
+   **
+   ** buffer comes back empty, possibly with the capacity of a buffer already written.
+   ** Blocks while the queue is full. Throws the IoException of a failed earlier write.
+   **/
+  void write(std::vector<char>& buffer);
+  /// write what is still queued, flush and stop the writer thread. Throws IoException on failure
+  void close();
+  /// restrict the writer thread to the cpus. Throws IoException
+  void setCpus(const std::vector<int>& cpus);
+
+  /// consistent once closed
+  const Stats& getStats() const { return stats_; }
+  /// bytes waiting for or being written by the writer thread. Can be called from any thread
+  std::size_t getQueuedBytes() const { return queuedBytes_.load(std::memory_order_relaxed); }
+
+  friend std::ostream& operator<<(std::ostream& os, const AsyncWriter& writer);
+
+private:
+  /// buffers kept for recycling beyond that are freed
+  static const std::size_t MAX_FREE_BUFFERS = 64;
+
+  std::ostream&                  os_;
+  const std::size_t              maxQueueBytes_;
+  std::mutex                     mutex_;
+  std::condition_variable        notEmpty_;
+  std::condition_variable        notFull_;
+  std::deque<std::vector<char>>  queue_;
+  std::vector<std::vector<char>> free_;
+  std::atomic<std::size_t>       queuedBytes_{0};
+  bool                           closing_     = false;
+  std::exception_ptr             error_;
+  Stats                          stats_;
+  std::thread                    thread_;
+
+  void run();
+};
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_ASYNC_WRITER_HPP
@@ -0,0 +1,84 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_CPU_TOPOLOGY_HPP
+#define COMMON_CPU_TOPOLOGY_HPP
+
+#include <pthread.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dragenos {
+namespace common {
+
+/// a logical cpu and the physical core it belongs to
+struct LogicalCpu {
+  int cpu;
+  int package;
+  int core;
+  friend std::ostream& operator<<(std::ostream& os, const LogicalCpu& c)
+  {
+    return os << c.cpu << "(package " << c.package << " core " << c.core << ")";
+  }
+};
+
+/**
+ ** \brief logical cpus of the system, grouped by physical core
+ **
+ ** The topology is read from the core_id and physical_package_id files of
+ ** <sysCpuDir>/cpu<N>/topology. The cpus without topology information are treated as
+ ** cores of their own.
+ **/
+class CpuTopology {
+public:
+  /**
+   ** \param cpus logical cpus to consider, in any order
+   ** \param sysCpuDir where to read the topology from
+   **/
+  explicit CpuTopology(
+      const std::vector<int>& cpus, const std::string& sysCpuDir = "/sys/devices/system/cpu");
+
+  const std::vector<LogicalCpu>& getCpus() const { return cpus_; }
+  /// number of distinct physical cores
+  std::size_t getCoreCount() const;
+
+  /**
+   ** \brief order in which the threads should be placed on the cpus
+   **
+   ** \param spread if true, one cpu of each physical core before any of the SMT siblings.
+   **        Otherwise, the SMT siblings of a core are next to each other.
+   **/
+  std::vector<LogicalCpu> getPlacement(bool spread) const;
+
+private:
+  /// sorted by package, core, cpu
+  std::vector<LogicalCpu> cpus_;
+};
+
+/// parse a list of cpus such as "0-3,8,10-11". Throws InvalidParameterException
+std::vector<int> parseCpuList(const std::string& list);
+/// the cpus the calling thread is allowed to run on
+std::vector<int> getAllowedCpus();
+/// restrict the calling thread, and the threads it creates from now on, to the cpus. Throws IoException
+void setAllowedCpus(const std::vector<int>& cpus);
+/// the cpus the thread is allowed to run on. Throws IoException
+std::vector<int> getThreadCpus(pthread_t thread);
+/// restrict the thread to the cpus. Throws IoException
+void setThreadCpus(pthread_t thread, const std::vector<int>& cpus);
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_CPU_TOPOLOGY_HPP
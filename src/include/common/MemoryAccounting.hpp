@@ -0,0 +1,125 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_MEMORY_ACCOUNTING_HPP
+#define COMMON_MEMORY_ACCOUNTING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace dragenos {
+namespace common {
+
+/// the components of the memory of an alignment run, in the order of the report
+enum class MemoryComponent : uint8_t {
+  HASH_TABLE = 0,
+  EXTEND_TABLE,
+  REFERENCE,
+  WORKERS,           ///< per thread aligner state, Smith-Waterman query profiles and read cache
+  BLOCKS_IN_FLIGHT,  ///< input, records and output of the blocks read and not stored yet
+  OUTPUT_QUEUE,      ///< output waiting for the writer thread
+  COUNT
+};
+
+const char* getMemoryComponentName(MemoryComponent component);
+
+/**
+ ** \brief bytes held by each component of the run, with their peaks
+ **
+ ** The hash table, extend table and reference are regions registered once, mapped or loaded:
+ ** the report tells how much of them is actually resident, with mincore. The other components
+ ** are counters updated by the threads that own the memory. The counters are relaxed atomics,
+ ** consistent enough for the status and the memory limit but not exact while they change.
+ **
+ ** The limit, if any, is enforced by the workflows: they stop reading new blocks while the
+ ** total leaves no room for one more, and size the blocks to the room left by the rest.
+ **/
+class MemoryAccounting {
+public:
+  /// memory of the whole process, as the kernel and the allocator see it
+  struct ProcessMemory {
+    uint64_t rss        = 0;
+    uint64_t peakRss    = 0;
+    /// allocated, free and directly mapped bytes of the malloc heap
+    uint64_t heapInUse  = 0;
+    uint64_t heapFree   = 0;
+    uint64_t heapMapped = 0;
+  };
+
+  /// \param limit maximum total bytes, 0 for no limit
+  explicit MemoryAccounting(uint64_t limit = 0);
+  MemoryAccounting(const MemoryAccounting&) = delete;
+  MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+
+  /// register a region of a fixed component. The bytes count towards the component from now on
+  void addRegion(MemoryComponent component, const void* data, uint64_t bytes);
+  /// change a counted component by the given bytes
+  void add(MemoryComponent component, int64_t bytes);
+  /// set a counted component to the given bytes
+  void set(MemoryComponent component, uint64_t bytes);
+
+  uint64_t get(MemoryComponent component) const
+  {
+    return bytes_[static_cast<std::size_t>(component)].load(std::memory_order_relaxed);
+  }
+  uint64_t getPeak(MemoryComponent component) const
+  {
+    return peaks_[static_cast<std::size_t>(component)].load(std::memory_order_relaxed);
+  }
+  /// sum of all the components
+  uint64_t getTotal() const;
+  uint64_t getPeakTotal() const { return peakTotal_.load(std::memory_order_relaxed); }
+  /// bytes of the registered regions of the component currently in memory
+  uint64_t getResident(MemoryComponent component) const;
+
+  uint64_t getLimit() const { return limit_; }
+  /// true if the limit leaves no room for the given bytes more
+  bool isOverLimit(uint64_t bytes) const { return limit_ && getTotal() + bytes > limit_; }
+  /// room left by the limit for the blocks in flight and the output queue. 0 without limit
+  uint64_t getBlocksBudget() const;
+
+  /// bytes of the pages of [data, data + bytes) currently in memory
+  static uint64_t      getResidentBytes(const void* data, uint64_t bytes);
+  static ProcessMemory getProcessMemory();
+
+  /// breakdown per component with the peaks, the residency of the regions and the process memory
+  void report(std::ostream& os) const;
+
+private:
+  typedef std::array<std::atomic<uint64_t>, static_cast<std::size_t>(MemoryComponent::COUNT)> Counters;
+
+  struct Region {
+    MemoryComponent component;
+    const void*     data;
+    uint64_t        bytes;
+  };
+
+  const uint64_t        limit_;
+  Counters              bytes_;
+  Counters              peaks_;
+  std::atomic<uint64_t> peakTotal_;
+  mutable std::mutex    mutex_;
+  std::vector<Region>   regions_;
+
+  void updatePeaks(std::size_t component, uint64_t bytes);
+};
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_MEMORY_ACCOUNTING_HPP
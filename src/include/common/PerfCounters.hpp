@@ -0,0 +1,85 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_PERF_COUNTERS_HPP
+#define COMMON_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dragenos {
+namespace common {
+
+/**
+ ** \brief group of perf_event_open counters of the calling thread
+ **
+ ** The counters only count the user space of the thread that opened them, which is allowed
+ ** with the default perf_event_paranoid settings. The first event leads the group: the members
+ ** are scheduled together with it, so that the ratios between them are consistent, and all of
+ ** them are read with a single read(). When the kernel has to multiplex the groups onto the
+ ** hardware counters, the values are scaled by the fraction of the time the group was running.
+ **
+ ** The members that the kernel or the hardware does not support are left out of the group and
+ ** read as 0. If the leader itself can not be opened, the group is not valid and getError()
+ ** and getErrno() tell why.
+ **/
+class PerfCounters {
+public:
+  static const std::size_t MAX_EVENTS = 6;
+
+  struct Event {
+    std::string name;
+    uint32_t    type;
+    uint64_t    config;
+  };
+  typedef std::array<uint64_t, MAX_EVENTS> Values;
+
+  /// cycles, instructions, last level cache read misses, data TLB read misses and branch misses
+  static const std::vector<Event>& getHardwareEvents();
+
+  explicit PerfCounters(const std::vector<Event>& events);
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool               isValid() const { return -1 != fds_[0]; }
+  const std::string& getError() const { return error_; }
+  /// errno of the failure to open the leader, 0 if valid
+  int getErrno() const { return errno_; }
+  /// perf_event_open forbidden by perf_event_paranoid, seccomp or the kernel configuration
+  bool isDenied() const
+  {
+    return !isValid() && (EPERM == errno_ || EACCES == errno_ || ENOSYS == errno_);
+  }
+  /// whether the event i was opened. The values of the others are always 0
+  bool isOpen(std::size_t i) const { return -1 != fds_[i]; }
+  /// counts since the counters were opened, in the order of the events. 0 if not valid
+  Values read() const;
+
+private:
+  std::array<int, MAX_EVENTS> fds_;
+  /// position of each opened event in the group read
+  std::array<std::size_t, MAX_EVENTS> slots_;
+  std::size_t                         opened_;
+  std::string                         error_;
+  int                                 errno_;
+};
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_PERF_COUNTERS_HPP
@@ -0,0 +1,278 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_PROFILER_HPP
+#define COMMON_PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/PerfCounters.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace dragenos {
+namespace common {
+
+/// the stages of the processing, in the order of the report
+enum class Stage : uint8_t {
+  IDLE = 0,  ///< waiting for the other threads, or outside of any stage
+  READ,      ///< reading and decompressing the input
+  TOKENIZE,  ///< parsing the input records into reads
+  MAP,       ///< seed chains from the hash table
+  UNGAPPED,  ///< ungapped alignments of the seed chains
+  SMITH_WATERMAN,
+  RESCUE,        ///< mate rescue scans
+  PAIRING,       ///< pairing, picking, MAPQ and anything else around the alignment of a read
+  INSERT_SIZES,  ///< insert size statistics of the blocks
+  ENCODE,        ///< output formatting and mapping metrics
+  STORE,         ///< handing the output over to the writer in the input order
+  WRITE,         ///< writing the output stream
+  COUNT
+};
+
+const char* getStageName(Stage stage);
+
+/// timestamp in the units of the cycle counter
+inline uint64_t readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/**
+ ** \brief log scale histogram of durations, 8 buckets per power of 2
+ **
+ ** The quantiles are the lower bounds of the buckets, which are within 12.5% of the values
+ **/
+class LatencyHistogram {
+public:
+  static const unsigned SUB_BITS     = 3;
+  static const unsigned BUCKET_COUNT = (64 - SUB_BITS + 1) << SUB_BITS;
+
+  LatencyHistogram() : counts_(), count_(0), max_(0) {}
+
+  void add(uint64_t value)
+  {
+    ++counts_[getBucket(value)];
+    ++count_;
+    max_ = std::max(max_, value);
+  }
+  void          add(const LatencyHistogram& that);
+  std::uint64_t getCount() const { return count_; }
+  std::uint64_t getMax() const { return max_; }
+  /// lower bound of the bucket holding the quantile q in [0, 1]
+  std::uint64_t getQuantile(double q) const;
+
+  static unsigned getBucket(uint64_t value)
+  {
+    if (value < (1u << SUB_BITS)) {
+      return value;
+    }
+    const unsigned log2 = 63 - __builtin_clzll(value);
+    return ((log2 - SUB_BITS + 1) << SUB_BITS) | ((value >> (log2 - SUB_BITS)) & ((1u << SUB_BITS) - 1));
+  }
+  static uint64_t getBucketLowerBound(unsigned bucket);
+
+private:
+  std::array<std::uint64_t, BUCKET_COUNT> counts_;
+  std::uint64_t                           count_;
+  std::uint64_t                           max_;
+};
+
+/// cycles spent by one thread in each stage, and the durations of the reads it aligned
+struct ThreadProfile {
+  typedef std::array<uint64_t, static_cast<std::size_t>(Stage::COUNT)>             Cycles;
+  typedef std::array<PerfCounters::Values, static_cast<std::size_t>(Stage::COUNT)> Counts;
+
+  ThreadProfile(const std::string& name, uint64_t now)
+    : name(name),
+      cycles(),
+      counted(false),
+      counts(),
+      lastCounts(),
+      current(Stage::IDLE),
+      started(now),
+      last(now)
+  {
+  }
+
+  std::string                   name;
+  Cycles                        cycles;
+  LatencyHistogram              reads;
+  /// hardware counters of the thread while it is attached, if enabled and available
+  std::unique_ptr<PerfCounters> perf;
+  bool                          counted;
+  Counts                        counts;
+  PerfCounters::Values          lastCounts;
+  Stage                         current;
+  uint64_t                      started;
+  uint64_t                      last;
+
+  /// charge the cycles since the last switch to the current stage and switch to the stage
+  Stage enter(Stage stage)
+  {
+    const uint64_t now = readCycles();
+    const Stage    ret = current;
+    cycles[static_cast<std::size_t>(current)] += now - last;
+    if (perf) {
+      chargeCounters();
+    }
+    last    = now;
+    current = stage;
+    return ret;
+  }
+  /// opens the counters for the calling thread, which must be the thread profiled
+  void openCounters(const std::vector<PerfCounters::Event>& events);
+
+private:
+  /// charge the counts since the last switch to the current stage
+  void chargeCounters();
+};
+
+/**
+ ** \brief low overhead accounting of the time spent in the stages, per thread
+ **
+ ** Disabled unless enable() gets called. The threads attach with a ProfileThread and mark
+ ** their stages with StageTimer. The stages nest: the time of a stage excludes the time of
+ ** the stages nested in it. When the profiler is disabled, the timers only check a thread local
+ ** pointer.
+ **
+ ** The time is measured with the cycle counter and converted to seconds with the rate
+ ** observed between enable() and report().
+ **
+ ** Optionally, each thread also reads a group of hardware counters (see PerfCounters) at each
+ ** switch of stage and the report gives their totals per stage. The counters cost a system call
+ ** per switch, which inflates the short stages, so they are only worth it to compare the
+ ** stages on cache, TLB and branch behavior, not for the timings.
+ **/
+class Profiler {
+public:
+  static Profiler& instance();
+
+  /**
+   ** \brief starts profiling, with the given hardware counters if any
+   **
+   ** The counters are tried on the calling thread first: if they can not be opened, the
+   ** profile goes on without them and getCountersError() tells why
+   **/
+  void enable(const std::vector<PerfCounters::Event>& counters = std::vector<PerfCounters::Event>());
+  bool isEnabled() const { return enabled_; }
+  /// why the requested counters are not available, empty if they are or if none were requested
+  const std::string& getCountersError() const { return countersError_; }
+
+  /// the profile of the calling thread, nullptr if it is not attached
+  static ThreadProfile* getThreadProfile() { return threadProfile_; }
+
+  /// json with the totals per stage, the per thread utilization and the read duration quantiles,
+  /// and the counts per stage if the counters are enabled
+  void report(std::ostream& os) const;
+
+private:
+  friend class ProfileThread;
+  Profiler() = default;
+
+  void attach(const std::string& name);
+  void detach();
+  void reportCounters(std::ostream& os, const ThreadProfile::Counts& counts, std::size_t countedThreads) const;
+
+  bool                                        enabled_     = false;
+  uint64_t                                    startCycles_ = 0;
+  std::chrono::steady_clock::time_point       startTime_;
+  mutable std::mutex                          mutex_;
+  std::vector<std::unique_ptr<ThreadProfile>> threads_;
+  std::vector<PerfCounters::Event>            counters_;
+  std::string                                 countersError_;
+
+  static thread_local ThreadProfile* threadProfile_;
+};
+
+/// accounts the time of the calling thread for as long as it lives, if the profiler is enabled
+class ProfileThread {
+public:
+  explicit ProfileThread(const std::string& name)
+  {
+    if (Profiler::instance().isEnabled()) {
+      Profiler::instance().attach(name);
+    }
+  }
+  ~ProfileThread()
+  {
+    if (Profiler::getThreadProfile()) {
+      Profiler::instance().detach();
+    }
+  }
+  ProfileThread(const ProfileThread&) = delete;
+  ProfileThread& operator=(const ProfileThread&) = delete;
+};
+
+/// charges the time of the calling thread to the stage for as long as it lives
+class StageTimer {
+public:
+  explicit StageTimer(Stage stage) : profile_(Profiler::getThreadProfile()), previous_(Stage::IDLE)
+  {
+    if (profile_) {
+      previous_ = profile_->enter(stage);
+    }
+  }
+  ~StageTimer()
+  {
+    if (profile_) {
+      profile_->enter(previous_);
+    }
+  }
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+  ThreadProfile* const profile_;
+  Stage                previous_;
+};
+
+/// records the duration of the alignment of a read (or pair) in the profile of the calling thread
+class ReadTimer {
+public:
+  ReadTimer() : profile_(Profiler::getThreadProfile()), start_(profile_ ? readCycles() : 0) {}
+  ~ReadTimer()
+  {
+    if (profile_) {
+      profile_->reads.add(readCycles() - start_);
+    }
+  }
+  ReadTimer(const ReadTimer&) = delete;
+  ReadTimer& operator=(const ReadTimer&) = delete;
+
+private:
+  ThreadProfile* const profile_;
+  const uint64_t       start_;
+};
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_PROFILER_HPP
@@ -22,6 +22,8 @@
 #include <thread>
 #include <vector>
 
+#include "common/CpuTopology.hpp"
+
 namespace dragenos {
 namespace common {
 
@@ -143,6 +145,20 @@ public:
     }
   }
 
+  /**
+   * \brief restricts all the threads of the pool to the cpus. The calling thread is left alone.
+   *
+   * The threads of the pool are interchangeable: any of them can end up aligning, so they all get
+   * the same cpus and the scheduler balances the busy ones over them.
+   */
+  void setCpus(const std::vector<int>& cpus)
+  {
+    lock_type lock(mutex_);
+    for (std::thread& thread : threads_) {
+      setThreadCpus(thread.native_handle(), cpus);
+    }
+  }
+
   /**
    * \brief Constructs a vector of size threads. All memory allocations that are required happen
    *        at this point.
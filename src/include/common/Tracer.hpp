@@ -0,0 +1,182 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef COMMON_TRACER_HPP
+#define COMMON_TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dragenos {
+namespace common {
+
+/// the spans of the timeline of the pipeline
+enum class TraceSpan : uint8_t {
+  MEMORY_WAIT,       ///< waiting for the blocks in flight to be stored before reading more
+  READ,              ///< reading an input block
+  CPU_WAIT,          ///< waiting for a cpu, or for the turn of the block to be aligned
+  ALIGN,             ///< aligning the reads of a block, or of a batch of the block of another thread
+  INSERT_SIZE_WAIT,  ///< waiting for the insert size statistics of the previous blocks
+  INSERT_SIZES,      ///< updating the insert size statistics with the block
+  ENCODE,            ///< formatting the output of a block
+  ORDERING_WAIT,     ///< waiting for the turn of the block to be stored
+  STORE,             ///< handing the output of a block over to the writer
+  WRITE,             ///< writing a buffer into the output stream
+  COUNT
+};
+
+const char* getTraceSpanName(TraceSpan span);
+
+/// one complete span, in nanoseconds since the tracer was enabled
+struct TraceEvent {
+  uint64_t  begin;
+  uint64_t  end;
+  int32_t   block;
+  TraceSpan span;
+};
+
+/**
+ ** \brief the latest events of one thread
+ **
+ ** Only written by the thread that owns it, so that recording an event takes no lock and no
+ ** atomic read-modify-write. When full, the oldest events get overwritten.
+ **/
+class TraceBuffer {
+public:
+  TraceBuffer(const std::string& name, uint32_t tid, std::size_t capacity)
+    : name_(name), tid_(tid), capacity_(capacity), events_(new TraceEvent[capacity]), written_(0)
+  {
+  }
+
+  void add(const TraceEvent& event)
+  {
+    const uint64_t written       = written_.load(std::memory_order_relaxed);
+    events_[written % capacity_] = event;
+    written_.store(written + 1, std::memory_order_release);
+  }
+
+  const std::string& getName() const { return name_; }
+  uint32_t           getTid() const { return tid_; }
+  /// events recorded, including the ones overwritten
+  uint64_t getWritten() const { return written_.load(std::memory_order_acquire); }
+  /// the events still in the buffer, oldest first
+  std::vector<TraceEvent> getEvents() const;
+
+private:
+  const std::string             name_;
+  const uint32_t                tid_;
+  const std::size_t             capacity_;
+  std::unique_ptr<TraceEvent[]> events_;
+  std::atomic<uint64_t>         written_;
+};
+
+/**
+ ** \brief opt-in timeline of the pipeline, in the Chrome trace event format
+ **
+ ** Disabled unless enable() gets called. The threads attach with a TraceThread and mark their
+ ** spans with TraceScope, which only check a thread local pointer when the tracer is disabled.
+ ** Each thread records into a TraceBuffer of its own and write() dumps all of them, once the
+ ** threads are done, as json that chrome://tracing and https://ui.perfetto.dev load directly.
+ **/
+class Tracer {
+public:
+  static Tracer& instance();
+
+  /// \param eventsPerThread capacity of the buffer of each thread
+  void enable(std::size_t eventsPerThread);
+  bool isEnabled() const { return enabled_; }
+
+  /// the buffer of the calling thread, nullptr if it is not attached
+  static TraceBuffer* getThreadBuffer() { return threadBuffer_; }
+  /// nanoseconds since the tracer was enabled
+  uint64_t now() const
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  /// the events of all the threads, with the names of the threads and the events overwritten
+  void write(std::ostream& os) const;
+
+private:
+  friend class TraceThread;
+  Tracer() = default;
+
+  void attach(const std::string& name);
+  void detach();
+
+  bool                                      enabled_         = false;
+  std::size_t                               eventsPerThread_ = 0;
+  std::chrono::steady_clock::time_point     start_;
+  mutable std::mutex                        mutex_;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+
+  static thread_local TraceBuffer* threadBuffer_;
+};
+
+/// records the spans of the calling thread for as long as it lives, if the tracer is enabled
+class TraceThread {
+public:
+  explicit TraceThread(const std::string& name)
+  {
+    if (Tracer::instance().isEnabled()) {
+      Tracer::instance().attach(name);
+    }
+  }
+  ~TraceThread()
+  {
+    if (Tracer::getThreadBuffer()) {
+      Tracer::instance().detach();
+    }
+  }
+  TraceThread(const TraceThread&) = delete;
+  TraceThread& operator=(const TraceThread&) = delete;
+};
+
+/// records a span of the calling thread from construction to destruction
+class TraceScope {
+public:
+  explicit TraceScope(TraceSpan span, int block = -1)
+    : buffer_(Tracer::getThreadBuffer()),
+      span_(span),
+      block_(block),
+      begin_(buffer_ ? Tracer::instance().now() : 0)
+  {
+  }
+  ~TraceScope()
+  {
+    if (buffer_) {
+      buffer_->add(TraceEvent{begin_, Tracer::instance().now(), block_, span_});
+    }
+  }
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  TraceBuffer* const buffer_;
+  const TraceSpan    span_;
+  const int          block_;
+  const uint64_t     begin_;
+};
+
+}  // namespace common
+}  // namespace dragenos
+
+#endif  // #ifndef COMMON_TRACER_HPP
@@ -24,11 +24,8 @@ namespace io {
 
 class BamToReadTransformer {
 public:
-  sequences::Read::Name      tmpName_;
-  sequences::Read::Bases     tmpBases_;
-  sequences::Read::Qualities tmpQscores_;
-  static const char          DEFAULT_QNAME_DELIM = ' ';
-  char                       qnameSuffixDelim_   = DEFAULT_QNAME_DELIM;
+  static const char DEFAULT_QNAME_DELIM = ' ';
+  char              qnameSuffixDelim_   = DEFAULT_QNAME_DELIM;
 
   // testability hook
   template <typename DumpT>
@@ -39,35 +36,32 @@ public:
 
   void operator()(const bam::BamRecordAccessor& bra, unsigned pos, uint64_t fragmentId, sequences::Read& read)
   {
-    const auto name    = bra.getName(qnameSuffixDelim_);
-    const auto bases   = bra.getBases();
-    const auto qscores = bra.getQscores();
-    tmpName_.assign(name.first, name.second - 1);
-    tmpBases_.clear();
-    if (bra.reverse()) {
-      for (auto it = bases.first; bases.second != it; ++it) {
-        unsigned char b = *it;
-        b               = (b & 0xCC) >> 2 | (b & 0x33) << 2;
-        b               = (b & 0xAA) >> 1 | (b & 0x55) << 1;
-
-        tmpBases_.push_back(b >> 4);
-        tmpBases_.push_back(b & 0x0f);
-      }
-    } else {
-      for (auto it = bases.first; bases.second != it; ++it) {
-        tmpBases_.push_back(*it >> 4);
-        tmpBases_.push_back(*it & 0x0f);
-      }
+    const auto        name    = bra.getName(qnameSuffixDelim_);
+    const auto        bases   = bra.getBases();
+    const auto        qscores = bra.getQscores();
+    const std::size_t length  = bra.readLength();
+    assert(std::size_t(qscores.second - qscores.first) == length);
+    // unpack in place, in the storage of the read
+    read.prepare(name.first, name.second - 1, length, fragmentId, pos);
+    sequences::Read::Base*   b = read.getBasesBuffer();
+    sequences::Read::Qscore* q = read.getQualitiesBuffer();
+    for (std::size_t i = 0; length != i; ++i) {
+      const unsigned char packed = bases.first[i / 2];
+      b[i]                       = (i % 2) ? (packed & 0x0f) : (packed >> 4);
     }
-    tmpBases_.resize(bra.readLength());
-    tmpQscores_.assign(qscores.first, qscores.second);
+    std::copy(qscores.first, qscores.second, q);
     if (bra.reverse()) {
-      std::reverse(tmpBases_.begin(), tmpBases_.end());
-      std::reverse(tmpQscores_.begin(), tmpQscores_.end());
+      // complement: reverse the bits of each 4 bits base, then restore the original orientation
+      for (std::size_t i = 0; length != i; ++i) {
+        unsigned char c = b[i];
+        c               = (c & 0xC) >> 2 | (c & 0x3) << 2;
+        b[i]            = (c & 0xA) >> 1 | (c & 0x5) << 1;
+      }
+      std::reverse(b, b + length);
+      std::reverse(q, q + length);
     }
-    assert(tmpBases_.size() == tmpQscores_.size());
 
-    read.init(std::move(tmpName_), std::move(tmpBases_), std::move(tmpQscores_), fragmentId, pos);
+    read.complete();
   }
 };
 
@@ -29,17 +29,9 @@ public:
   static const char DEFAULT_QNAME_DELIM = ' ';
   char              qnameSuffixDelim_   = DEFAULT_QNAME_DELIM;
 
-  sequences::Read::Name      tmpName_;
-  sequences::Read::Bases     tmpBases_;
-  sequences::Read::Qualities tmpQscores_;
-
   sequences::Read::Qscore q0_[VECTOR_REGISTER_WIDTH ? VECTOR_REGISTER_WIDTH : 1];
   sequences::Read::Qscore q2_[VECTOR_REGISTER_WIDTH ? VECTOR_REGISTER_WIDTH : 1];
 
-  // testability hook
-  template <typename DumpT>
-  friend DumpT& dump(DumpT& dump, const FastqToReadTransformer& transformer);
-
 public:
   FastqToReadTransformer(const char qnameSuffixDelim = DEFAULT_QNAME_DELIM, const char q0 = DEFAULT_Q0)
     : qnameSuffixDelim_(qnameSuffixDelim)
@@ -51,32 +43,28 @@ public:
   void operator()(
       const fastq::Tokenizer::Token& fastqToken, unsigned pos, uint64_t fragmentId, sequences::Read& read)
   {
-    const auto name    = fastqToken.getName(qnameSuffixDelim_);
-    const auto bases   = fastqToken.getBases();
-    const auto qscores = fastqToken.getQscores();
-    tmpName_.assign(name.first, name.second);
-    tmpBases_.assign(bases.first, bases.second);
-    tmpQscores_.assign(qscores.first, qscores.second);
+    const auto        name    = fastqToken.getName(qnameSuffixDelim_);
+    const auto        bases   = fastqToken.getBases();
+    const auto        qscores = fastqToken.getQscores();
+    const std::size_t length  = std::distance(bases.first, bases.second);
+    // convert in place, in the storage of the read
+    read.prepare(name.first, name.second, length, fragmentId, pos);
+    std::copy(bases.first, bases.second, read.getBasesBuffer());
+    std::copy(qscores.first, qscores.second, read.getQualitiesBuffer());
 
 #if VECTOR_REGISTER_WIDTH
-    const std::size_t minCapacity =
-        ((tmpBases_.size() + VECTOR_REGISTER_WIDTH - 1) / VECTOR_REGISTER_WIDTH) * VECTOR_REGISTER_WIDTH;
-    const std::size_t size = tmpBases_.size();
-    tmpBases_.resize(minCapacity);
-    tmpBases_.resize(size);
-    tmpQscores_.resize(minCapacity);
-    tmpQscores_.resize(size);
-    convertBasesAndQualities();
+    convertBasesAndQualities(read.getBasesBuffer(), read.getQualitiesBuffer(), length);
 #else
-    convertBasesAndQualities(q0_[0]);
+    convertBasesAndQualities(read.getBasesBuffer(), read.getQualitiesBuffer(), length, q0_[0]);
 #endif  // VECTOR_REGISTER_WIDTH
 
-    read.init(std::move(tmpName_), std::move(tmpBases_), std::move(tmpQscores_), fragmentId, pos);
+    read.complete();
   }
 
 private:
-  void convertBasesAndQualities();
-  void convertBasesAndQualities(const char q0);
+  void convertBasesAndQualities(sequences::Read::Base* b, sequences::Read::Qscore* q, const std::size_t size);
+  void convertBasesAndQualities(
+      sequences::Read::Base* b, sequences::Read::Qscore* q, const std::size_t size, const char q0);
 
   void convertBases(sequences::Read::Base* b, const std::size_t size);
   void convertBases2(sequences::Read::Base* b, const std::size_t size);
@@ -40,7 +40,11 @@ namespace map {
 class ChainBuilder {
 public:
   ChainBuilder(double chainFilterRatio) : seedChainCount_(0), chainFilterRatio_(chainFilterRatio) {}
-  void                                   clear() { seedChainCount_ = 0; }
+  void clear()
+  {
+    seedChainCount_      = 0;
+    numRandomSampleHits_ = 0;
+  }
   std::vector<SeedChain>::const_iterator begin() const { return seedChains_.begin(); }
   std::vector<SeedChain>::const_iterator end() const { return seedChains_.begin() + seedChainCount_; }
 
@@ -55,6 +59,8 @@ public:
   size_t size() const { return seedChainCount_; }
   void   addSeedPosition(const SeedPosition& seedPosition, bool reverseComplement, bool randomSample);
   void   addSeedChain(const SeedChain& seedChain);
+  /// number of random samples added since the last clear. The samples depend on the read name
+  int    getRandomSampleHits() const { return numRandomSampleHits_; }
   void   filterChains();
   template <class F>
   void sort(F compare)
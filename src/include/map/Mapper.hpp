@@ -22,6 +22,7 @@
 
 #include "BestIntervalTracker.hpp"
 #include "common/Exceptions.hpp"
+#include "map/MapperStats.hpp"
 #include "reference/HashRecord.hpp"
 #include "reference/Hashtable.hpp"
 #include "sequences/Read.hpp"
@@ -132,6 +133,8 @@ public:
     return (hash & extensionIdBinMask_) << EXTENSION_ID_BIN_SHIFT;
   }
   const Hashtable* getHashtable() const { return hashtable_; }
+  /// hash table access counters of all the reads mapped so far
+  const MapperStats& getStats() const { return stats_; }
   /**
    ** \brief output the seed chains without mapping
    **
@@ -190,6 +193,8 @@ private:
   const uint64_t   extensionIdBinMask_;
   /// mask used to keep all related hashes (probing region, chains, extensions) in the same memory segment
   const uint64_t addressSegmentMask_;
+  /// counting doesn't change the results of the mapping
+  mutable MapperStats stats_;
 };
 
 }  // namespace map
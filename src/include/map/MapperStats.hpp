@@ -0,0 +1,88 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef MAP_MAPPER_STATS_HPP
+#define MAP_MAPPER_STATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+namespace dragenos {
+namespace map {
+
+/**
+ ** \brief hash table access counters of a Mapper
+ **
+ ** These are the counters listed in the header of Mapper::generateMapperCigar, summed over all
+ ** the reads mapped instead of being reported per read. Each thread counts into its own instance
+ ** and the instances get summed at the end of the run.
+ **
+ ** Primary accesses and results relate to the lookup of the primary seeds, secondary ones to the
+ ** lookups of the extended seeds. The "first" access is the initial bucket of each lookup, "probe"
+ ** and "chain" are the additional buckets read when the initial bucket overflows.
+ **/
+struct MapperStats {
+  /// lower bounds of the seed frequency classes: 1, 2, 3, 4+, 6+, ... 128+
+  static const unsigned FREQUENCY_CLASS_COUNT = 14;
+  static const uint32_t FREQUENCY_CLASSES[FREQUENCY_CLASS_COUNT];
+
+  uint64_t reads               = 0;
+  uint64_t seedAttempts        = 0;
+  uint64_t primaryFirst        = 0;
+  uint64_t primaryProbe        = 0;
+  uint64_t primaryChain        = 0;
+  uint64_t secondaryFirst      = 0;
+  uint64_t secondaryProbe      = 0;
+  uint64_t secondaryChain      = 0;
+  uint64_t primaryMiss         = 0;
+  uint64_t primaryHit          = 0;
+  uint64_t primaryHifreq       = 0;
+  uint64_t primaryExtend       = 0;
+  uint64_t secondaryMiss       = 0;
+  uint64_t secondaryHit        = 0;
+  uint64_t largestMissInterval = 0;
+  uint64_t longestExtension    = 0;
+  uint64_t extensionSum        = 0;
+  uint64_t chains              = 0;
+  /// seeds per frequency class, the class being the number of reference positions of the seed
+  std::array<uint64_t, FREQUENCY_CLASS_COUNT> seedFrequencies = {{}};
+
+  void addSeedFrequency(uint32_t frequency)
+  {
+    if (!frequency) {
+      return;
+    }
+    unsigned i = 0;
+    while (FREQUENCY_CLASS_COUNT != i + 1 && FREQUENCY_CLASSES[i + 1] <= frequency) {
+      ++i;
+    }
+    ++seedFrequencies[i];
+  }
+  void addExtension(uint64_t extension)
+  {
+    longestExtension = std::max(longestExtension, extension);
+    extensionSum += extension;
+  }
+
+  MapperStats& operator+=(const MapperStats& that);
+  /// csv in the format of the mapping metrics, one counter per line, with the count per read
+  void write(std::ostream& os) const;
+};
+
+}  // namespace map
+}  // namespace dragenos
+
+#endif  // #ifndef MAP_MAPPER_STATS_HPP
@@ -54,6 +54,7 @@ public:
   int  swAll_ = 0;  // Aligner.sw-all
 
   std::string methodSmithWaterman_   = "mengyao";  // "mengyao" : vectorized SW library /   "dragen" for legacy code
+  int         wfaMaxEdits_           = 8;  // Aligner.wfa-max-edits
   bool        samplingEnabled_       = true;  // sampling-enabled
   double      alignerPeMeanInsert_   = 0.0;   // Aligner.pe-stat-mean-insert
   double      alignerPeStddevInsert_ = 0.0;   // Aligner.pe-stat-stddev-insert
@@ -68,6 +69,9 @@ public:
   bool     peStatsContinuousUpdate_ = false;   // pe-stats-continuous-update
   bool     peStatsUpdateLogOnly_    = false;   // pe-stats-update-log-only
 
+  std::string peStatsIn_;   // pe-stats-in
+  std::string peStatsOut_;  // pe-stats-out
+
   double mapperFilterLenRatio_ = 4.0;  // Mapper.filter-len-ratio
 
   uint32_t alignerPeOrientation_    = 0;    // Aligner.pe-orientation
@@ -87,6 +91,8 @@ public:
   bool alignerSecAlignsHard_ = false;  // Aligner.sec-aligns-hard
   int  mapperNumThreads_ =
       0;  // Maximum worker threads for map /align. If not defined, then use maximum on system.
+  std::string cpuList_;              // cpu-list
+  std::string pinThreads_ = "none";  // pin-threads
   const int matchScore_       = 1;
   const int mismatchScore_    = -4;
   const int gapExtendPenalty_ = 1;
@@ -101,6 +107,33 @@ public:
 
   bool preserveMapAlignOrder_ = false;
 
+  // bounds of the adaptive size of the input blocks
+  uint64_t inputBlockMinRecords_  = 10000;             // input-block-min-records
+  uint64_t inputBlockMaxRecords_  = 400000;            // input-block-max-records
+  uint64_t inputBlockMinBytes_    = 64 * 1024;         // input-block-min-bytes
+  uint64_t inputBlockMaxBytes_    = 16 * 1024 * 1024;  // input-block-max-bytes
+  uint64_t inputBlockMemoryLimit_ = 0;                 // input-block-memory-limit
+  // bytes accounted for the reference, hash table, aligners and blocks in flight. 0 for no limit
+  uint64_t memoryLimit_ = 0;  // memory-limit
+  // output buffers waiting for the writer thread before the workers block
+  uint64_t outputQueueBytes_ = 256 * 1024 * 1024;  // output-queue-bytes
+  // slots of the alignment cache of each worker thread. 0 disables the cache
+  uint64_t readCacheEntries_ = 0;  // read-cache-entries
+  // account the time of the threads per stage and write <prefix>.perf.json
+  bool profile_ = false;
+  // also count cycles, instructions, cache, TLB and branch misses per stage. Implies profile
+  bool profileCounters_ = false;  // profile-counters
+  // timeline of the pipeline in the chrome trace event format. Empty for none
+  std::string traceFile_;              // trace-file
+  uint64_t    traceEvents_ = 1 << 16;  // trace-events
+  // reads that take at least the threshold to align, with the work they took. Empty for none
+  std::string slowReadLog_;                // slow-read-log
+  uint64_t    slowReadThreshold_ = 10000;  // slow-read-threshold, in microseconds
+  // seconds between the status lines printed while aligning. 0 disables them
+  double progressInterval_ = 60.0;  // progress-interval
+  // status in json rewritten at each interval. Empty for none
+  std::string progressFile_;  // progress-file
+
   bool        verbose_        = false;
   bool        buildHashTable_ = false;
   bool        htUncompress_   = false;
@@ -49,6 +49,11 @@ public:
   typedef sequences::CrcHasher       CrcHasher;
   typedef reference::HashtableConfig HashtableConfig;
   typedef HashtableTraits            Traits;
+  /// buckets read by getHits in addition to the initial bucket
+  struct BucketAccesses {
+    unsigned probes = 0;
+    unsigned chains = 0;
+  };
   /**
    ** \brief consttructor
    **
@@ -122,8 +127,9 @@ public:
    ** of bits from the secondary CRC).
    **
    ** \param bucketIndex the index of the initial bucket
+   ** \return the number of neighbor buckets read
    **/
-  void probeNeighborBuckets(
+  unsigned probeNeighborBuckets(
       const uint64_t                    initialBucketIndex,
       const uint64_t                    matchBits,
       const uint8_t                     hashThreadId,
@@ -187,8 +193,10 @@ public:
    ** CHAIN_BEG_MASK or CHAIN_BEG_LIST record in the initial bucket that matches the query
    ** hash key. Probing is triggered when reaching the end of a bucket without finding any
    ** relevant record with the "Last in thread" flag set and without chaining.
+   **
+   ** \return the number of buckets read for probing and chaining
    **/
-  void getHits(
+  BucketAccesses getHits(
       const Hash&                       hash,
       bool                              isExtended,
       std::vector<HashRecord>&          hits,
@@ -118,6 +118,17 @@ public:
     }
   }
 
+  /**
+   ** \brief bulk fetch of the bases in [beginPosition, endPosition) into a caller buffer
+   **
+   ** Equivalent to calling getBase on each position but unpacks 32 bases (16 bytes of
+   ** reference.bin) per iteration with SSSE3 shuffles. The buffer must have room for
+   ** (endPosition - beginPosition) bases.
+   **/
+  void getBases(size_t beginPosition, size_t endPosition, unsigned char* out) const;
+  /// bulk fetch of the complemented bases - equivalent to calling getRcBase on each position
+  void getRcBases(size_t beginPosition, size_t endPosition, unsigned char* out) const;
+
   unsigned char        getBase(size_t position) const;
   unsigned char        getRcBase(size_t position) const;
   const unsigned char* getData() const { return data_; }
@@ -15,13 +15,46 @@
 #ifndef SEQUENCES_READ_HPP
 #define SEQUENCES_READ_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <vector>
 
 namespace dragenos {
 namespace sequences {
 
+/**
+ ** \brief read-only view of a contiguous range of T, such as a field of a Read
+ **/
+template <typename T>
+class ConstSpan {
+public:
+  typedef T                                     value_type;
+  typedef const T*                              iterator;
+  typedef const T*                              const_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  ConstSpan() : begin_(nullptr), size_(0) {}
+  ConstSpan(const T* begin, std::size_t size) : begin_(begin), size_(size) {}
+
+  const T*               data() const { return begin_; }
+  std::size_t            size() const { return size_; }
+  bool                   empty() const { return 0 == size_; }
+  const_iterator         begin() const { return begin_; }
+  const_iterator         end() const { return begin_ + size_; }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  const T&               operator[](std::size_t i) const { return begin_[i]; }
+  const T&               front() const { return *begin_; }
+  const T&               back() const { return begin_[size_ - 1]; }
+
+private:
+  const T*    begin_;
+  std::size_t size_;
+};
+
 class Read {
 public:
   typedef std::vector<char>   Name;
@@ -29,8 +62,20 @@ public:
   typedef std::vector<Base>   Bases;
   typedef unsigned char       Qscore;
   typedef std::vector<Qscore> Qualities;
+  typedef ConstSpan<char>     NameSpan;
+  typedef ConstSpan<Base>     BasesSpan;
+  typedef ConstSpan<Qscore>   QualitiesSpan;
+
+  /// the bases, rc bases and qualities each start at a multiple of PADDING and can be written
+  /// by blocks of PADDING bytes
+  static const std::size_t PADDING = 16;
+  /// initial size of the storage: enough for the name and the fields of a short read
+  static const std::size_t INLINE_CAPACITY = 1024;
 
-  explicit Read() : id_(0), position_(0) {}
+  explicit Read() : id_(0), position_(0), nameLength_(0), length_(0), stride_(0)
+  {
+    storage_.reserve(INLINE_CAPACITY);
+  }
 
   // The expected usage pattern is to create a bunch of persistent Read objects
   // and init them for each new input sequence from the corresponding parser.
@@ -40,13 +85,34 @@ public:
   // move is ok
   Read& operator=(Read&& that);
 
-  void init(Name&& name, Bases&& bases, Qualities&& qualities, uint64_t id, unsigned position);
+  /// copy the fields into the storage of the read
+  void init(const Name& name, const Bases& bases, const Qualities& qualities, uint64_t id, unsigned position);
+
+  /**
+   ** \brief lay out the storage for a new sequence of the given length and copy its name
+   **
+   ** The storage only grows, so that a persistent Read stops allocating once it has seen the
+   ** longest read of the input. The parser then writes the bases and qualities in place through
+   ** getBasesBuffer() and getQualitiesBuffer(), and calls complete() to produce the rc bases.
+   **/
+  template <typename NameIt>
+  void prepare(NameIt nameBegin, NameIt nameEnd, std::size_t length, uint64_t id, unsigned position)
+  {
+    layout(std::distance(nameBegin, nameEnd), length, id, position);
+    std::copy(nameBegin, nameEnd, storage_.begin());
+  }
+  /// getLength() bases followed by the padding up to a multiple of PADDING
+  Base* getBasesBuffer() { return storage_.data() + basesOffset(); }
+  /// getLength() qualities followed by the padding up to a multiple of PADDING
+  Qscore* getQualitiesBuffer() { return storage_.data() + qualitiesOffset(); }
+  /// compute the reverse complement once the bases are written
+  void complete();
 
   uint64_t          getId() const { return id_; }
   unsigned          getPosition() const { return position_; }
-  const Name&       getName() const { return name_; }
-  const std::string getNameAsString() const { return std::string(name_.begin(), name_.end()); }
-  Base              getBase4bpb(size_t i) const { return bases_[i]; }
+  NameSpan          getName() const { return NameSpan(reinterpret_cast<const char*>(storage_.data()), nameLength_); }
+  const std::string getNameAsString() const { return std::string(getName().begin(), getName().end()); }
+  Base              getBase4bpb(size_t i) const { return storage_[basesOffset() + i]; }
   Base              getBase2bpb(size_t i) const
   {
     constexpr char    A           = 0;
@@ -57,10 +123,10 @@ public:
     static const char bases2bpb[] = {N, A, C, N, G, N, N, N, T, N, N, N, N, N, N, N};
     return bases2bpb[getBase4bpb(i)];
   }
-  const Bases&     getBases() const { return bases_; }
-  const Bases&     getRcBases() const { return rcBases_; }
-  const Qualities& getQualities() const { return qualities_; }
-  static char      decodeBase(unsigned int b)
+  BasesSpan     getBases() const { return BasesSpan(storage_.data() + basesOffset(), length_); }
+  BasesSpan     getRcBases() const { return BasesSpan(storage_.data() + rcBasesOffset(), length_); }
+  QualitiesSpan getQualities() const { return QualitiesSpan(storage_.data() + qualitiesOffset(), length_); }
+  static char   decodeBase(unsigned int b)
   {
     static const char bases[] = {
         'N', 'A', 'C', 'M', 'G', 'R', 'S', 'V', 'T', 'W', 'Y', 'H', 'K', 'D', 'B', 'N'};
@@ -72,24 +138,31 @@ public:
         'N', 'T', 'G', 'K', 'C', 'Y', 'S', 'B', 'A', 'W', 'R', 'D', 'M', 'H', 'V', 'N'};
     return b >= sizeof(bases) ? 'N' : bases[b];
   }
-  size_t               getLength() const { return bases_.size(); }
+  size_t               getLength() const { return length_; }
   friend std::ostream& operator<<(std::ostream& os, const Read& read)
   {
-    return os << "Read(" << read.id_ << "," << read.position_ << ","
-              << std::string(read.name_.begin(), read.name_.end()) << "," << read.getLength() << ","
-              << (read.bases_.empty() ? std::string("empty") : decodeBase(read.bases_[0]) + std::string(".."))
-              << ","
-              << (read.qualities_.empty() ? std::string("empty") : std::to_string(read.qualities_[0]) + "..")
-              << ")";
+    const BasesSpan     bases     = read.getBases();
+    const QualitiesSpan qualities = read.getQualities();
+    return os << "Read(" << read.id_ << "," << read.position_ << "," << read.getNameAsString() << ","
+              << read.getLength() << ","
+              << (bases.empty() ? std::string("empty") : decodeBase(bases[0]) + std::string("..")) << ","
+              << (qualities.empty() ? std::string("empty") : std::to_string(qualities[0]) + "..") << ")";
   }
 
 private:
-  uint64_t  id_;
-  unsigned  position_;
-  Name      name_;
-  Bases     bases_;
-  Bases     rcBases_;
-  Qualities qualities_;
+  uint64_t    id_;
+  unsigned    position_;
+  std::size_t nameLength_;
+  std::size_t length_;
+  /// length rounded up to a multiple of PADDING
+  std::size_t stride_;
+  /// name | padding | bases | rc bases | qualities, each of the last three stride_ long
+  std::vector<unsigned char> storage_;
+
+  void        layout(std::size_t nameLength, std::size_t length, uint64_t id, unsigned position);
+  std::size_t basesOffset() const { return (nameLength_ + PADDING - 1) / PADDING * PADDING; }
+  std::size_t rcBasesOffset() const { return basesOffset() + stride_; }
+  std::size_t qualitiesOffset() const { return basesOffset() + 2 * stride_; }
 };
 
 class SerializedRead {
@@ -133,17 +206,13 @@ public:
   };
 
   SerializationString getName() const { return SerializationString(bytes_, bytes_ + nameLen_); }
-  std::pair<const Read::Base*, const Read::Base*> getBases() const
+  Read::BasesSpan getBases() const
   {
-    return std::make_pair(
-        reinterpret_cast<const Read::Base*>(bytes_) + nameLen_,
-        reinterpret_cast<const Read::Base*>(bytes_) + nameLen_ + readLen_);
+    return Read::BasesSpan(reinterpret_cast<const Read::Base*>(bytes_) + nameLen_, readLen_);
   }
-  std::pair<const Read::Qscore*, const Read::Qscore*> getQualities() const
+  Read::QualitiesSpan getQualities() const
   {
-    return std::make_pair(
-        reinterpret_cast<const Read::Qscore*>(bytes_) + nameLen_ + readLen_,
-        reinterpret_cast<const Read::Qscore*>(bytes_) + nameLen_ + readLen_ * 2);
+    return Read::QualitiesSpan(reinterpret_cast<const Read::Qscore*>(bytes_) + nameLen_ + readLen_, readLen_);
   }
 
   static char decodeBase(unsigned int b) { return Read::decodeBase(b); }
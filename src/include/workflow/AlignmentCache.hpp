@@ -0,0 +1,206 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef WORKFLOW_ALIGNMENT_CACHE_HPP
+#define WORKFLOW_ALIGNMENT_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "align/Alignment.hpp"
+#include "align/InsertSizeParameters.hpp"
+#include "common/Profiler.hpp"
+#include "sequences/Read.hpp"
+#include "sequences/ReadPair.hpp"
+#include "workflow/alignment/AlignmentUtils.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+/**
+ ** \brief memoizes the alignment records of the reads with identical bases
+ **
+ ** Amplicon and PCR heavy libraries have many exact repeats of the same sequences. The cache
+ ** keeps, for recently seen bases (both mates for the pairs), the alignment records as they were
+ ** stored, including the cigars, flags, mate information and the SA tag. A repeat replays
+ ** them with its own read, which provides the name and the qualities of the output. The bases
+ ** are compared exactly, the hash only selects the slot.
+ **
+ ** The results that involve random samples of the hash table are not cached because the
+ ** samples are drawn with the read name as the seed. The paired results are only reused with
+ ** the insert size parameters they were computed with. With that, the output is identical
+ ** with and without the cache.
+ **
+ ** Direct mapped: each new result replaces the one in its slot, and the storage of the slots is
+ ** reused. Not thread safe: meant to be owned by a single worker thread.
+ **/
+class AlignmentCache {
+public:
+  struct Stats {
+    std::size_t lookups     = 0;
+    std::size_t hits        = 0;
+    /// misses whose results depend on the read name
+    std::size_t uncacheable = 0;
+
+    Stats& operator+=(const Stats& that)
+    {
+      lookups += that.lookups;
+      hits += that.hits;
+      uncacheable += that.uncacheable;
+      return *this;
+    }
+    friend std::ostream& operator<<(std::ostream& os, const Stats& stats);
+  };
+
+  /// \param capacity number of slots. 0 disables the cache
+  explicit AlignmentCache(std::size_t capacity);
+
+  bool         isEnabled() const { return !slots_.empty(); }
+  const Stats& getStats() const { return stats_; }
+  /// bytes held by the slots and their storage
+  std::size_t getBytes() const;
+
+  /**
+   ** \brief store the cached records of the pair, if any
+   **
+   ** On a miss, the pair becomes the key of the records passed to record() until commit()
+   **/
+  template <typename StoreOp>
+  bool replay(
+      const align::InsertSizeParameters& insertSizeParameters, const sequences::ReadPair& pair, StoreOp store)
+  {
+    return replay(lookup(&insertSizeParameters, pair.at(0), &pair.at(1)), pair.at(0), &pair.at(1), store);
+  }
+  /// single ended counterpart of replay
+  template <typename StoreOp>
+  bool replay(const sequences::Read& read, StoreOp store)
+  {
+    return replay(lookup(nullptr, read, nullptr), read, nullptr, store);
+  }
+
+  /// add a record of the read at readPosition to the pending entry
+  void record(std::size_t readPosition, const align::Alignment& alignment);
+  /// replace the slot of the pending entry with it if the results do not depend on the read name
+  void commit(bool dependsOnReadName);
+
+private:
+  struct Record {
+    std::size_t      readPosition;
+    align::Alignment alignment;
+    bool             hasSa;
+    /// the SA target as it was when the record was stored
+    align::Alignment sa;
+  };
+
+  struct Entry {
+    bool                        valid  = false;
+    uint32_t                    hash   = 0;
+    bool                        paired = false;
+    align::InsertSizeParameters insertSizeParameters;
+    std::size_t                 length0 = 0;
+    /// bases of the read followed by the bases of the mate, if any
+    std::vector<unsigned char> bases;
+    std::vector<Record>        records;
+    std::size_t                recordCount = 0;
+  };
+
+  std::vector<Entry> slots_;
+  /// results of the last miss, waiting for commit
+  Entry pending_;
+  Stats stats_;
+
+  /// cached entry for the read (and mate) or nullptr. Prepares pending_ on a miss
+  Entry* lookup(
+      const align::InsertSizeParameters* insertSizeParameters,
+      const sequences::Read&             read,
+      const sequences::Read*             mate);
+
+  template <typename StoreOp>
+  bool replay(Entry* entry, const sequences::Read& read, const sequences::Read* mate, StoreOp store)
+  {
+    if (!entry) {
+      return false;
+    }
+    for (std::size_t i = 0; entry->recordCount != i; ++i) {
+      Record& record = entry->records[i];
+      record.alignment.setSa(record.hasSa ? &record.sa : nullptr);
+      store(record.readPosition ? *mate : read, record.alignment);
+    }
+    return true;
+  }
+};
+
+/// alignment::alignAndStorePair through the cache
+template <typename StoreOp>
+void alignAndStorePair(
+    AlignmentCache&                    cache,
+    const align::InsertSizeParameters& insertSizeParameters,
+    const sequences::ReadPair&         pair,
+    align::Aligner&                    aligner,
+    const align::SinglePicker&         singlePicker,
+    const align::PairBuilder&          pairBuilder,
+    align::AlignmentPairs&             alignmentPairs,
+    StoreOp                            store)
+{
+  const common::ReadTimer  readTimer;
+  const common::StageTimer timer(common::Stage::PAIRING);
+  if (!cache.isEnabled()) {
+    alignment::alignAndStorePair(
+        insertSizeParameters, pair, aligner, singlePicker, pairBuilder, alignmentPairs, store);
+  } else if (!cache.replay(insertSizeParameters, pair, store)) {
+    alignment::alignAndStorePair(
+        insertSizeParameters,
+        pair,
+        aligner,
+        singlePicker,
+        pairBuilder,
+        alignmentPairs,
+        [&](const sequences::Read& read, const align::Alignment& a) {
+          cache.record(&pair.at(1) == &read, a);
+          store(read, a);
+        });
+    cache.commit(aligner.hasRandomSamples(0) || aligner.hasRandomSamples(1));
+  }
+}
+
+/// alignment::alignAndStoreSingle through the cache
+template <typename StoreOp>
+void alignAndStoreSingle(
+    AlignmentCache&             cache,
+    const align::Aligner::Read& read,
+    align::Aligner&             aligner,
+    const align::SinglePicker&  singlePicker,
+    align::Aligner::Alignments& alignments,
+    StoreOp                     store)
+{
+  const common::ReadTimer  readTimer;
+  const common::StageTimer timer(common::Stage::PAIRING);
+  if (!cache.isEnabled()) {
+    alignment::alignAndStoreSingle(read, aligner, singlePicker, alignments, store);
+  } else if (!cache.replay(read, store)) {
+    alignment::alignAndStoreSingle(
+        read, aligner, singlePicker, alignments, [&](const sequences::Read& r, const align::Alignment& a) {
+          cache.record(0, a);
+          store(r, a);
+        });
+    cache.commit(aligner.hasRandomSamples(0));
+  }
+}
+
+}  // namespace workflow
+}  // namespace dragenos
+
+#endif  // #ifndef WORKFLOW_ALIGNMENT_CACHE_HPP
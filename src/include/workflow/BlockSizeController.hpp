@@ -0,0 +1,113 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef WORKFLOW_BLOCK_SIZE_CONTROLLER_HPP
+#define WORKFLOW_BLOCK_SIZE_CONTROLLER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace dragenos {
+namespace workflow {
+
+/**
+ ** \brief chooses the size of the input blocks from the behavior of the blocks already aligned
+ **
+ ** Small blocks spend a significant part of their time in the handoffs between the threads
+ ** (reading, insert size turn, ordered store) and leave cpus idle. Large blocks hold more data
+ ** in the reorder queue and delay the ordered output behind the slowest one.
+ **
+ ** The controller collects, for a window of one block per thread, the align time, the number of
+ ** idle cpus when the block is done, the number of blocks in flight and their memory footprint.
+ ** At the end of each window the block size is halved when the projected memory of the blocks in
+ ** flight exceeds the memory limit or when a block would take longer than MAX_BLOCK_SECONDS_ to
+ ** align. It is doubled when a block would take less than MIN_BLOCK_SECONDS_, or when cpus were
+ ** left idle and doubling still stays under MAX_BLOCK_SECONDS_. The size always stays within
+ ** [minSize, maxSize] and is a multiple of the granularity. Each change is logged.
+ **
+ ** The size is expressed in the unit of the caller (records, bytes). Not thread safe: the calls
+ ** are expected to be serialized by the caller (typically under the CPU_THREADS lock).
+ **/
+class BlockSizeController {
+public:
+  /// blocks aligned faster than this waste too much time in the handoffs
+  static constexpr double MIN_BLOCK_SECONDS_ = 0.5;
+  /// blocks aligned slower than this hold back the ordered output for too long
+  static constexpr double MAX_BLOCK_SECONDS_ = 4.0;
+
+  /**
+   ** \param unit name of the unit of the block size, for the log
+   ** \param minSize smallest block size
+   ** \param maxSize largest block size
+   ** \param initialSize block size until the first decision
+   ** \param granularity block sizes are rounded down to multiples of this
+   ** \param memoryLimit maximum bytes for all the blocks in flight. 0 for no limit
+   ** \param threads number of cpus aligning the blocks, also the size of the decision window
+   ** \param log where to log the decisions
+   **/
+  BlockSizeController(
+      const std::string& unit,
+      std::size_t        minSize,
+      std::size_t        maxSize,
+      std::size_t        initialSize,
+      std::size_t        granularity,
+      std::size_t        memoryLimit,
+      std::size_t        threads,
+      std::ostream&      log);
+
+  /// size of the next block to read
+  std::size_t getBlockSize() const { return blockSize_; }
+  /// number of times the block size changed
+  std::size_t getChanges() const { return changes_; }
+
+  /**
+   ** \brief account for a block that is done aligning
+   **
+   ** \param size size of the block, in the unit of the controller
+   ** \param bytes memory held by the block until it is stored (input and output)
+   ** \param alignSeconds wall time spent aligning the block
+   ** \param idleCpus cpus not aligning anything when the block got done
+   ** \param blocksInFlight blocks read and not stored yet
+   **/
+  void blockAligned(
+      std::size_t size, std::size_t bytes, double alignSeconds, std::size_t idleCpus, std::size_t blocksInFlight);
+
+private:
+  const std::string unit_;
+  const std::size_t minSize_;
+  const std::size_t maxSize_;
+  const std::size_t granularity_;
+  const std::size_t memoryLimit_;
+  const std::size_t threads_;
+  std::ostream&     log_;
+  std::size_t       blockSize_;
+  std::size_t       changes_;
+
+  // the current window
+  std::size_t blocks_;
+  std::size_t size_;
+  std::size_t bytes_;
+  double      alignSeconds_;
+  std::size_t idleCpus_;
+  std::size_t maxBlocksInFlight_;
+
+  std::size_t clamp(std::size_t size) const;
+  void        decide();
+};
+
+}  // namespace workflow
+}  // namespace dragenos
+
+#endif  // #ifndef WORKFLOW_BLOCK_SIZE_CONTROLLER_HPP
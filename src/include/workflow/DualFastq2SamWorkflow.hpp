@@ -12,11 +12,21 @@
  **
  **/
 
+#include <vector>
+
 #include "align/InsertSizeDistribution.hpp"
+#include "align/RecordStream.hpp"
+#include "align/SlowReadLog.hpp"
+#include "common/MemoryAccounting.hpp"
 #include "fastq/FastqNRecordReader.hpp"
+#include "map/MapperStats.hpp"
 #include "options/DragenOsOptions.hpp"
 #include "reference/Hashtable.hpp"
 #include "reference/ReferenceDir.hpp"
+#include "workflow/AlignmentCache.hpp"
+#include "workflow/BlockSizeController.hpp"
+#include "workflow/ProgressMonitor.hpp"
+#include "workflow/ThreadPlacement.hpp"
 
 namespace dragenos {
 namespace workflow {
@@ -25,10 +35,44 @@ class DualFastq2SamWorkflow {
   const options::DragenOsOptions& options_;
   const reference::ReferenceDir7& referenceDir_;
   const reference::Hashtable&     hashtable_;
-  // IMPORTANT: this has to divide INIT_INTERVAL_SIZE without remainder. Else the whole insert
-  // size stats detection will hang because it depends on processing alignment results exactly
-  // after sending INIT_INTERVAL_SIZE into the aligner.
+  /// memory of the run, with the limit on the blocks in flight
+  common::MemoryAccounting& memory_;
+  /// pairs slow to align, nullptr for none
+  align::SlowReadLog* slowReadLog_;
+  // initial block size. The block size is then adapted by a BlockSizeController. IMPORTANT: the
+  // blocks must end exactly at INIT_INTERVAL_SIZE records. Else the whole insert size stats
+  // detection will hang because it depends on processing alignment results exactly after sending
+  // INIT_INTERVAL_SIZE into the aligner. See getBlockRecords.
   static const int RECORDS_AT_A_TIME_ = 100000;
+  // blocks are aligned in batches of pairs that idle threads can take over
+  static const int RECORDS_PER_BATCH_ = 4096;
+
+  /**
+   ** \brief a block being aligned, split into batches of pairs
+   **
+   ** The thread that owns the block aligns the batches in turn. Threads of later blocks
+   ** that have nothing else to do than waiting take over the remaining batches, so that a
+   ** block full of expensive reads doesn't hold back the ordered output for too long.
+   ** All the members are protected by the CPU_THREADS lock.
+   **/
+  struct BlockWork {
+    int                                block                = -1;
+    const align::InsertSizeParameters* insertSizeParameters = nullptr;
+    /// where the aligners hold back the slow reads of a speculative alignment. nullptr to record them
+    align::SlowReadLog::Pending* slowReadPending = nullptr;
+    const std::vector<char>*           r1Block              = nullptr;
+    const std::vector<char>*           r2Block              = nullptr;
+    /// offsets of the first record of each batch, followed by the size of the block
+    std::vector<std::size_t> r1Offsets;
+    std::vector<std::size_t> r2Offsets;
+    /// records produced by the aligner and the same records in output format, for each batch
+    std::vector<align::RecordStream> records;
+    std::vector<std::vector<char>>   samBuffers;
+    std::size_t                      nextBatch   = 0;
+    std::size_t                      batchesDone = 0;
+
+    std::size_t getBatchCount() const { return r1Offsets.size() - 1; }
+  };
 
   // ensure FIFO
   int blockToStart_          = 0;
@@ -37,50 +81,89 @@ class DualFastq2SamWorkflow {
   int blockToRead_           = 0;
   int blockToStore_          = 0;
 
+  /// blocks that still have batches for the idle threads
+  std::vector<BlockWork*> blocksInProgress_;
+
+  /// parameters of the last block that got its insert sizes. Used to align the next blocks speculatively
+  align::InsertSizeParameters latestInsertSizeParameters_;
+
+  /// records read so far
+  std::size_t recordsRead_ = 0;
+  /// records to sample before the insert size statistics are initialized. 0 if not sampling
+  std::size_t initRecords_ = 0;
+  /// largest block the insert size statistics can handle. 0 for no limit
+  std::size_t maxBlockRecords_ = 0;
+
   bool r1Eof_ = false;
   bool r2Eof_ = false;
 
+  /// hash table access counters, summed over the threads
+  map::MapperStats mapperStats_;
+
 public:
   DualFastq2SamWorkflow(
       const options::DragenOsOptions& options,
       const reference::ReferenceDir7& referenceDir,
-      const reference::Hashtable&     hashtable)
-    : options_(options), referenceDir_(referenceDir), hashtable_(hashtable)
+      const reference::Hashtable&     hashtable,
+      common::MemoryAccounting&       memory,
+      align::SlowReadLog*             slowReadLog)
+    : options_(options),
+      referenceDir_(referenceDir),
+      hashtable_(hashtable),
+      memory_(memory),
+      slowReadLog_(slowReadLog)
   {
   }
 
   void parseDualFastq(
       std::ostream& os, std::ostream& insertSizeDistributionLogStream, std::ostream& mappingMetricsLogStream);
 
+  const map::MapperStats& getMapperStats() const { return mapperStats_; }
+
 private:
   align::InsertSizeParameters requestInsertSizeInfo(
       align::InsertSizeDistribution& insertSizeDistribution, std::istream& inputR1, std::istream& inputR2);
 
+  /// offsets of every RECORDS_PER_BATCH_ fastq records in the block
+  static void splitBlock(const std::vector<char>& block, std::vector<std::size_t>& offsets);
+
   template <typename StoreOp>
   void alignDualFastq(
-      align::InsertSizeParameters& insertSizeParameters,
-      std::istream&                inputR1,
-      std::istream&                inputR2,
-      align::Aligner&              aligner,
-      const align::SinglePicker&   singlePicker,
-      const align::PairBuilder&    pairBuilder,
-      StoreOp                      store);
+      const align::InsertSizeParameters& insertSizeParameters,
+      std::istream&                      inputR1,
+      std::istream&                      inputR2,
+      int64_t                            fragmentId,
+      align::Aligner&                    aligner,
+      AlignmentCache&                    alignmentCache,
+      const align::SinglePicker&         singlePicker,
+      const align::PairBuilder&          pairBuilder,
+      align::AlignmentPairs&             alignmentPairs,
+      StoreOp                            store);
 
   //  void parseDualFastq(
   //    const align::InsertSizeDistribution& insertSizeDistribution,
   //    std::istream& inputR1, std::istream& inputR2, align::Aligner& aligner, std::ostream& output);
+  /// size of the next block to read, within the limits required by the insert size statistics
+  std::size_t getBlockRecords(const BlockSizeController& blockSizeController) const;
+
   void readBlockThread(
       common::ThreadPool::lock_type& lock,
       const int                      ourBlock,
+      const BlockSizeController&     blockSizeController,
       int&                           r1Records,
       std::vector<char>&             r1Block,
       fastq::FastqNRecordReader&     r1Reader,
       int&                           r2Records,
       std::vector<char>&             r2Block,
-      fastq::FastqNRecordReader&     r2Reader);
+      fastq::FastqNRecordReader&     r2Reader,
+      ProgressMonitor&               progress,
+      const ThreadPlacement&         threadPlacement);
 
+  /// r1File and r2File are the files under the decompressed streams, for the progress
   void parseDualFastq(
+      std::istream& r1File,
       std::istream& r1Stream,
+      std::istream& r2File,
       std::istream& r2Stream,
       std::ostream& os,
       std::ostream& insertSizeDistributionLogStream,
@@ -0,0 +1,168 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef WORKFLOW_PROGRESS_MONITOR_HPP
+#define WORKFLOW_PROGRESS_MONITOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "align/InsertSizeParameters.hpp"
+#include "common/AsyncWriter.hpp"
+#include "common/MemoryAccounting.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+/**
+ ** \brief periodic status of a running alignment, printed by a dedicated timer thread
+ **
+ ** The workers count the reads they are done with in counters of their own, and the workflow
+ ** publishes the position in the input files, the blocks read and stored and the insert size
+ ** parameters as they change. All of these are relaxed atomics: the timer thread only reads
+ ** them, once per interval, and never takes the locks of the workflow.
+ **
+ ** At each interval the timer thread prints a status line to the log with the reads done, the
+ ** reads/s over the interval, the input consumed versus the size of the input files, the
+ ** estimated time left, the blocks in flight, the bytes queued for the output writer, the memory
+ ** and the state of the insert size statistics. With a status file, the same status is written in json
+ ** into a temporary file renamed over the status file, so that readers never see it partially
+ ** written.
+ **/
+class ProgressMonitor {
+public:
+  /// counters of one worker, on a cache line of their own
+  struct WorkerCounters {
+    std::atomic<uint64_t> reads{0};
+    char                  padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  /// snapshot of the progress, with the rates since the previous one
+  struct Status {
+    double   seconds        = 0.0;
+    uint64_t reads          = 0;
+    double   readsPerSecond = 0.0;
+    /// bytes consumed from the input files, before decompression, and their total size if known
+    uint64_t inputBytes     = 0;
+    uint64_t inputFileBytes = 0;
+    /// estimated seconds left, negative when unknown
+    double   etaSeconds       = -1.0;
+    int      blocksRead       = 0;
+    int      blocksStored     = 0;
+    uint64_t outputQueueBytes = 0;
+    /// bytes accounted by the components of the run, and of the blocks in flight among them
+    uint64_t memoryBytes         = 0;
+    uint64_t blocksInFlightBytes = 0;
+    uint64_t rssBytes            = 0;
+    uint64_t peakRssBytes        = 0;
+    /// "none" until the workflow publishes insert size parameters, then "sampling" and "initialized"
+    std::string insertSizeState;
+    int         insertSizeMean = 0;
+    int         insertSizeMin  = 0;
+    int         insertSizeMax  = 0;
+  };
+
+  /**
+   ** \param intervalSeconds seconds between two status. 0 disables the timer thread
+   ** \param statusFile file rewritten with the status in json. Empty for none
+   ** \param workers number of worker counters
+   ** \param writer output writer, for the depth of its queue. Can be null
+   ** \param memory memory of the components of the run. Can be null
+   ** \param log where to print the status lines
+   **/
+  ProgressMonitor(
+      double                          intervalSeconds,
+      const std::string&              statusFile,
+      std::size_t                     workers,
+      const common::AsyncWriter*      writer,
+      const common::MemoryAccounting* memory,
+      std::ostream&                   log);
+  /// stops the timer thread
+  ~ProgressMonitor();
+  ProgressMonitor(const ProgressMonitor&) = delete;
+  ProgressMonitor& operator=(const ProgressMonitor&) = delete;
+
+  /// register an input file, before start. file is the stream reading the file itself
+  void addInput(const std::string& path, std::istream& file);
+  /// starts the timer thread, if enabled
+  void start();
+  /// stops the timer thread, without a last status
+  void stop();
+
+  WorkerCounters& getWorker(std::size_t worker) { return workers_[worker]; }
+  /// publishes the position in the input file. Only called by the thread that just read from it
+  void inputRead(std::size_t input);
+  void blocksRead(int blocks) { blocksRead_.store(blocks, std::memory_order_relaxed); }
+  void blocksStored(int blocks) { blocksStored_.store(blocks, std::memory_order_relaxed); }
+  void insertSizesChanged(const align::InsertSizeParameters& parameters);
+
+  /// status at the given time, with the rates since the previous call
+  Status sample(std::chrono::steady_clock::time_point now);
+
+  static void writeLine(std::ostream& os, const Status& status);
+  static void writeJson(std::ostream& os, const Status& status);
+
+private:
+  struct Input {
+    Input(const std::string& path, std::istream& file, uint64_t fileBytes)
+      : path(path), file(&file), fileBytes(fileBytes), bytes(0)
+    {
+    }
+    const std::string     path;
+    std::istream* const   file;
+    const uint64_t        fileBytes;
+    std::atomic<uint64_t> bytes;
+  };
+
+  const std::chrono::duration<double>   interval_;
+  const std::string                     statusFile_;
+  const std::size_t                     workerCount_;
+  std::unique_ptr<WorkerCounters[]>     workers_;
+  const common::AsyncWriter* const      writer_;
+  const common::MemoryAccounting* const memory_;
+  std::ostream&                         log_;
+  std::vector<std::unique_ptr<Input>>   inputs_;
+  std::atomic<int>                      blocksRead_{0};
+  std::atomic<int>                      blocksStored_{0};
+  /// 0 until the first parameters, 1 while sampling, 2 once initialized
+  std::atomic<int>                      insertSizeState_{0};
+  std::atomic<int>                      insertSizeMean_{0};
+  std::atomic<int>                      insertSizeMin_{0};
+  std::atomic<int>                      insertSizeMax_{0};
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point lastTime_;
+  uint64_t                              lastReads_ = 0;
+
+  std::mutex              mutex_;
+  std::condition_variable stopped_;
+  bool                    stopping_ = false;
+  std::thread             thread_;
+
+  void run();
+  void writeStatusFile(const Status& status) const;
+};
+
+}  // namespace workflow
+}  // namespace dragenos
+
+#endif  // #ifndef WORKFLOW_PROGRESS_MONITOR_HPP
@@ -0,0 +1,96 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef WORKFLOW_THREAD_PLACEMENT_HPP
+#define WORKFLOW_THREAD_PLACEMENT_HPP
+
+#include <utility>
+#include <vector>
+
+#include "common/AsyncWriter.hpp"
+#include "common/CpuTopology.hpp"
+#include "common/Threads.hpp"
+#include "options/DragenOsOptions.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+/**
+ ** \brief restrict the process to the cpus of --cpu-list, if any
+ **
+ ** Must be called before any thread is created, so that all the threads, including the
+ ** ones of the hash table builder, inherit the restriction.
+ **/
+void restrictCpus(const options::DragenOsOptions& options);
+
+/**
+ ** \brief cpus of the aligners and cpus of the I/O stages out of a placement
+ **
+ ** The aligners get the first alignerCount cpus of the placement. The I/O stages get all the cpus
+ ** of the first ioCoreCount physical cores, in placement order, that the aligners don't use. The
+ ** I/O cpus are empty when the aligners use all the cores.
+ **/
+std::pair<std::vector<int>, std::vector<int>> splitCpus(
+    const std::vector<common::LogicalCpu>& placement, std::size_t alignerCount, std::size_t ioCoreCount);
+
+/**
+ ** \brief restricts the threads to the cpus chosen by --pin-threads for as long as it lives
+ **
+ ** The aligners get the first num-threads cpus of the placement, which are distinct physical
+ ** cores first with 'spread'. The input and output get up to IO_CORES other physical cores, if
+ ** the aligners leave any: the writer thread for good and the workers while they read a block
+ ** in an IoScope. Otherwise they share the cpus of the aligners.
+ **
+ ** Any worker can read, align or store a block, and at most num-threads of them align at a time.
+ ** So all the workers get the cpus of the aligners and the scheduler balances the aligning ones
+ ** over them. The calling thread, which works for the pool during execute, gets them too and
+ ** recovers its own cpus on destruction, as do the workers of the pool. The writer thread keeps
+ ** its cpus until it stops.
+ **/
+class ThreadPlacement {
+public:
+  /// one core for reading and one for writing
+  static const std::size_t IO_CORES = 2;
+
+  ThreadPlacement(
+      const options::DragenOsOptions& options, common::ThreadPool& pool, common::AsyncWriter& writer);
+  ~ThreadPlacement();
+  ThreadPlacement(const ThreadPlacement&) = delete;
+  ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+  /// moves the calling worker to the I/O cpus for as long as it lives. Nothing to do without them
+  class IoScope {
+  public:
+    explicit IoScope(const ThreadPlacement& placement);
+    ~IoScope();
+    IoScope(const IoScope&) = delete;
+    IoScope& operator=(const IoScope&) = delete;
+
+  private:
+    const ThreadPlacement& placement_;
+  };
+
+private:
+  common::ThreadPool& pool_;
+  /// cpus of the calling thread before the placement. Empty when there is nothing to restore
+  std::vector<int> callerCpus_;
+  std::vector<int> alignerCpus_;
+  /// empty when the I/O shares the cpus of the aligners
+  std::vector<int> ioCpus_;
+};
+
+}  // namespace workflow
+}  // namespace dragenos
+
+#endif  // #ifndef WORKFLOW_THREAD_PLACEMENT_HPP
@@ -263,7 +263,7 @@ void alignAndStoreSingle(
   static const align::Alignment unmappedSE(align::AlignmentHeader::UNMAPPED);
 
   alignments.clear();
-  aligner.getAlignments(read, alignments);
+  aligner.getAlignments(read, alignments, singlePicker);
   const auto best = singlePicker.pickBest(read.getLength(), alignments);
   if (alignments.end() != best) {
     if (!storeSeSecondary(
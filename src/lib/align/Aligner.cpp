@@ -12,15 +12,19 @@
  **
  **/
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <numeric>
 #include <queue>
 
 #include <fcntl.h>
 #include <sys/mman.h>
 #include "common/DragenLogger.hpp"
 #include "common/Exceptions.hpp"
+#include "common/Profiler.hpp"
 #include "ssw/ssw_cpp.h"
 
 #include "align/Aligner.hpp"
@@ -47,7 +51,9 @@ Aligner::Aligner(
     const int                      aln_cfg_mapq_min_len,
     const uint32_t                 aln_cfg_unpaired_pen,
     const double                   aln_cfg_filter_len_ratio,
-    const bool                     vectorizedSW)
+    const bool                     vectorizedSW,
+    const bool                     wavefrontSW,
+    const int                      wfaMaxEdits)
   : referenceDir_(referenceDir),
     mapOnly_(mapOnly),
     swAll_(swAll),
@@ -62,11 +68,56 @@ Aligner::Aligner(
     aln_cfg_unpaired_pen_(aln_cfg_unpaired_pen),
     smithWaterman_(similarity, gapInit, gapExtend, unclipScore),
     vectorSmithWaterman_(similarity, gapInit, gapExtend, unclipScore),
-    alignmentGenerator_(referenceDir_, smithWaterman_, vectorSmithWaterman_, vectorizedSW_),
-    chainBuilders_{map::ChainBuilder(aln_cfg_filter_len_ratio), map::ChainBuilder(aln_cfg_filter_len_ratio)}
+    wfaAligner_(similarity, gapInit, gapExtend, unclipScore, wfaMaxEdits),
+    alignmentGenerator_(
+        referenceDir_, smithWaterman_, vectorSmithWaterman_, wfaAligner_, vectorizedSW_, wavefrontSW),
+    chainBuilders_{map::ChainBuilder(aln_cfg_filter_len_ratio), map::ChainBuilder(aln_cfg_filter_len_ratio)},
+    smithWatermanSkipped_(0),
+    smithWatermanSkip_(true),
+    slowReadLog_(nullptr),
+    slowReadPending_(nullptr),
+    rescues_(0)
 {
 }
 
+class Aligner::SlowReadTimer {
+public:
+  SlowReadTimer(const Aligner& aligner, const Read& read, const Read* mate)
+    : aligner_(aligner),
+      read_(read),
+      mate_(mate),
+      smithWatermanCalls_(aligner.alignmentGenerator_.getAlignmentCount()),
+      rescues_(aligner.rescues_),
+      start_(aligner.slowReadLog_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+  {
+  }
+  ~SlowReadTimer()
+  {
+    if (!aligner_.slowReadLog_) {
+      return;
+    }
+    const uint64_t nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+    if (aligner_.slowReadLog_->isSlow(nanoseconds)) {
+      SlowReadLog::Counters counters;
+      counters.chains = aligner_.chainBuilders_[0].size() + (mate_ ? aligner_.chainBuilders_[1].size() : 0);
+      counters.smithWatermanCalls = aligner_.alignmentGenerator_.getAlignmentCount() - smithWatermanCalls_;
+      counters.rescues            = aligner_.rescues_ - rescues_;
+      aligner_.slowReadLog_->add(read_, mate_, counters, nanoseconds, aligner_.slowReadPending_);
+    }
+  }
+  SlowReadTimer(const SlowReadTimer&) = delete;
+  SlowReadTimer& operator=(const SlowReadTimer&) = delete;
+
+private:
+  const Aligner&                              aligner_;
+  const Read&                                 read_;
+  const Read* const                           mate_;
+  const std::size_t                           smithWatermanCalls_;
+  const std::size_t                           rescues_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
 // void Aligner::buildAlignments(map::ChainBuilder& chainBuilder, const Read &read, Alignments &alignments)
 //{
 //  // TODO: encapsulate these local buffers into the Alignment to enable reuse - possibly into the Alignment instance
@@ -90,6 +141,7 @@ Aligner::Aligner(
 void Aligner::buildUngappedAlignments(
     map::ChainBuilder& chainBuilder, const Read& read, Alignments& alignments)
 {
+  const common::StageTimer timer(common::Stage::UNGAPPED);
   // sort the seed chains by decreasing length
   // TODO: implement the exact same sorting mechanism as in DRAGEN
   // const auto compare = [] (const map::SeedChain &lhs, const map::SeedChain &rhs) -> bool {return rhs.size() < lhs.size();};
@@ -207,10 +259,22 @@ unsigned Aligner::calculatePotentialScore(
   return std::max(0, ret);
 }
 
+ScoreType Aligner::calculateMaxScore(const Alignment& ungapped) const
+{
+  const Cigar& cigar = ungapped.getCigar();
+  // the aligned bases can only do better than their ungapped score with a gap
+  ScoreType ret =
+      std::max<ScoreType>(ungapped.getScore(), cigar.getClippedLength() * similarity_.match_ - gapInit_);
+  for (const int clipped : {cigar.countStartClips(), cigar.countEndClips()}) {
+    ret += std::max(0, clipped * similarity_.match_ - gapInit_);
+  }
+  return ret;
+}
+
 int Aligner::initializeUngappedAlignmentScores(
     const Read& read, const bool rcFlag, const size_t referenceOffset, Alignment& alignment)
 {
-  std::string                operations;
+  std::string&               operations           = ungappedOperations_;
   static const char          ALIGNMENT_MATCH      = Cigar::getOperationName(Cigar::ALIGNMENT_MATCH);
   static const char          SOFT_CLIP            = Cigar::getOperationName(Cigar::SOFT_CLIP);
   static const int           SOFT_CLIP_ADJUSTMENT = -5;
@@ -234,10 +298,14 @@ int Aligner::initializeUngappedAlignmentScores(
   const reference::HashtableConfig::Sequence& seq      = hashtableConfig.getSequences().at(refCoords.first);
   const auto                                  posRange = hashtableConfig.getPositionRange(seq);
   const int seqLeft = std::min(readBases.size(), posRange.second - referenceOffset);
+  // fetch the whole ungapped window at once rather than decoding one base per iteration
+  Database& referenceBases = ungappedReference_;
+  referenceBases.resize(seqLeft);
+  referenceDir_.getReferenceSequence().getBases(referenceOffset, referenceOffset + seqLeft, referenceBases.data());
 
   for (unsigned i = 0; i < seqLeft; ++i) {
     const auto          readBase          = readBases[i];
-    const unsigned char referenceBase     = referenceDir_.getReferenceSequence().getBase(referenceOffset + i);
+    const unsigned char referenceBase     = referenceBases[i];
     const bool          goodReadBase      = (readBase > 0) && (readBase != N);
     const bool          goodReferenceBase = (referenceBase > 0) && (referenceBase != N);
     const bool          goodBase          = goodReadBase && goodReferenceBase;
@@ -283,7 +351,7 @@ int Aligner::initializeUngappedAlignmentScores(
   int malus = 0;
   for (unsigned i = bestLast + 1; i < seqLeft; ++i) {
     const auto          readBase      = readBases[i];
-    const unsigned char referenceBase = referenceDir_.getReferenceSequence().getBase(referenceOffset + i);
+    const unsigned char referenceBase = referenceBases[i];
     malus += similarity_(readBase, referenceBase);
   }
   if (bestLast + 1 < seqLeft && malus >= SOFT_CLIP_ADJUSTMENT) {
@@ -298,13 +366,14 @@ int Aligner::initializeUngappedAlignmentScores(
   assert(operations.size() == read.getLength());
   alignment.setScore(std::max(0, bestScore));
   alignment.setPotentialScore(calculatePotentialScore(read, bestScore, bestFirst, bestLast + 1));
-  Database database;
+  Database& database = ungappedDatabase_;
+  database.resize(read.getLength() - bestFirst);
   if (alignment.isReverseComplement()) {
     referenceDir_.getReferenceSequence().getRcBases(
-        referenceOffset + bestFirst, referenceOffset + read.getLength(), std::back_inserter(database));
+        referenceOffset + bestFirst, referenceOffset + read.getLength(), database.data());
   } else {
     referenceDir_.getReferenceSequence().getBases(
-        referenceOffset + bestFirst, referenceOffset + read.getLength(), std::back_inserter(database));
+        referenceOffset + bestFirst, referenceOffset + read.getLength(), database.data());
   }
   // deal with before reference starts
   const auto referenceCoordinates =
@@ -325,26 +394,54 @@ int Aligner::initializeUngappedAlignmentScores(
 }
 
 void Aligner::runSmithWatermanWorthy(
-    const Read& read, map::ChainBuilder& chainBuilder, Alignments& alignments)
+    const Read& read, map::ChainBuilder& chainBuilder, Alignments& alignments, const SinglePicker& singlePicker)
 {
-  int               bestScore = 0;
-  const std::size_t toTry     = alignments.size();
+  // select the alignments worth trying in chain order, as the perfect alignments seen so far decide
+  int                    bestScore = 0;
+  const std::size_t      toTry     = alignments.size();
+  std::vector<bool>&     pending   = smithWatermanPending_;
+  std::vector<unsigned>& schedule  = smithWatermanSchedule_;
+  pending.assign(toTry, false);
+  schedule.clear();
   for (unsigned i = 0; toTry > i; ++i) {
-    auto&       alignment = alignments.at(i);
-    const auto& seedChain = chainBuilder.at(i);
+    const auto& alignment = alignments.at(i);
     if ((!alignment.isPerfect()) || (alignment.getPotentialScore() >= bestScore)) {
       if (alignment.isPerfect() && alignment.getScore() > bestScore) {
         bestScore = alignment.getScore();
       }
       if (alignment.getPotentialScore() > alignment.getScore()) {
-        alignmentGenerator_.generateAlignment(alnMinScore_, read, seedChain, alignment, 0);
+        pending[i] = true;
+        schedule.push_back(i);
       }
     }
   }
+
+  if (!smithWatermanSkip_) {
+    for (const unsigned i : schedule) {
+      alignmentGenerator_.generateAlignment(alnMinScore_, read, chainBuilder.at(i), alignments[i], 0);
+    }
+    return;
+  }
+
+  // then align them by decreasing maximum score until none of the remaining ones can make a difference
+  std::stable_sort(schedule.begin(), schedule.end(), [this, &alignments](unsigned left, unsigned right) {
+    return calculateMaxScore(alignments[left]) > calculateMaxScore(alignments[right]);
+  });
+  SinglePicker::SettledAlignments& settled = smithWatermanSettled_;
+  settled.reset(alignments, pending);
+  for (auto it = schedule.begin(); schedule.end() != it; ++it) {
+    if (calculateMaxScore(alignments[*it]) < singlePicker.getMinRelevantScore(read.getLength(), settled)) {
+      smithWatermanSkipped_ += schedule.end() - it;
+      break;
+    }
+    alignmentGenerator_.generateAlignment(alnMinScore_, read, chainBuilder.at(*it), alignments[*it], 0);
+    settled.settle(*it);
+  }
 }
 
-void Aligner::getAlignments(const Read& read, Alignments& alignments)
+void Aligner::getAlignments(const Read& read, Alignments& alignments, const SinglePicker& singlePicker)
 {
+  const SlowReadTimer slowReadTimer(*this, read, nullptr);
   if (vectorizedSW_) {
     const auto& query0 = read.getBases();
     vectorSmithWaterman_.initReadContext(query0.data(), query0.data() + query0.size(), 0);
@@ -360,7 +457,7 @@ void Aligner::getAlignments(const Read& read, Alignments& alignments)
     if (swAll_) {
       runSmithWatermanAll(read, chainBuilder, alignments, 0);
     } else {
-      runSmithWatermanWorthy(read, chainBuilder, alignments);
+      runSmithWatermanWorthy(read, chainBuilder, alignments, singlePicker);
     }
   }
 
@@ -463,12 +560,15 @@ bool Aligner::rescuePair(
     AlignmentPairs&             alignmentPairs)
 {
   if (alignmentRescue.triggeredBy(anchoredSeedChain, any_pair_match)) {
-    map::SeedChain rescuedSeedChain;
+    const common::StageTimer timer(common::Stage::RESCUE);
+    ++rescues_;
+    map::SeedChain           rescuedSeedChain;
     const int      rescuedIdx   = !anchoredIdx;
     const Read&    rescuedRead  = readPair.at(rescuedIdx);
     const Read&    anchoredRead = readPair.at(anchoredIdx);
 
-    Alignment rescued;
+    Alignment& rescued = rescued_;
+    rescued.reset();
     if (rescueMate(
             insertSizeParameters,
             anchoredRead,
@@ -503,6 +603,7 @@ AlignmentPairs::iterator Aligner::getAlignments(
     const InsertSizeParameters& insertSizeParameters,
     const PairBuilder&          pairBuilder)
 {
+  const SlowReadTimer slowReadTimer(*this, readPair[0], &readPair[1]);
   if (vectorizedSW_) {
     const auto& query0 = readPair[0].getBases();
     vectorSmithWaterman_.initReadContext(query0.data(), query0.data() + query0.size(), 0);
@@ -555,21 +656,39 @@ AlignmentPairs::iterator Aligner::getAlignments(
 
   //  std::cerr << "pairsFound[0].size():" << pairsFound[0].size() << std::endl;
   //  std::cerr << "pairsFound[1].size():" << pairsFound[1].size() << std::endl;
-  // find all combinations from seeds
+  // find all combinations from seeds. Only the mates within the insert size window are checked for
+  // pairMatch. The combinations are visited in the same order as with nested loops over both reads.
+  pairMatchFinder_.reset(insertSizeParameters, readPair, chainBuilders_[1]);
+  assert(chainBuilders_[1].size() == pairsFound[1].size());
   for (unsigned i0 = 0; pairsFound[0].size() > i0; ++i0) {
     auto& chain0 = chainBuilders_[0].at(i0);
     if (unpairedAlignments_[0].at(i0).getIneligibilityStatus()) {
       continue;
     }
 
-    for (unsigned i1 = 0; pairsFound[1].size() > i1; ++i1) {
+    pairMatchFinder_.find(chain0, pairMatches_);
+    // besides the pair matches, the best unpaired alignments are combined with all their mates
+    pairCandidates_.assign(pairMatches_.begin(), pairMatches_.end());
+    if (std::size_t(bestOffset0) == i0) {
+      pairCandidates_.resize(pairsFound[1].size());
+      std::iota(pairCandidates_.begin(), pairCandidates_.end(), 0);
+    } else if (
+        -1 != bestOffset1 &&
+        !std::binary_search(pairMatches_.begin(), pairMatches_.end(), unsigned(bestOffset1))) {
+      pairCandidates_.insert(
+          std::upper_bound(pairCandidates_.begin(), pairCandidates_.end(), unsigned(bestOffset1)),
+          bestOffset1);
+    }
+
+    for (const unsigned i1 : pairCandidates_) {
       if (unpairedAlignments_[1].at(i1).getIneligibilityStatus()) {
         continue;
       }
       auto&      chain1          = chainBuilders_[1].at(i1);
       const bool hasBestUnpaired = !chain0.isFiltered() && !chain1.isFiltered() &&
                                    ((std::size_t(bestOffset0) == i0) || (std::size_t(bestOffset1) == i1));
-      const bool isPair = pairMatch(insertSizeParameters, readPair, chain0, chain1);
+      const bool isPair = std::binary_search(pairMatches_.begin(), pairMatches_.end(), i1);
+      assert(isPair == pairMatch(insertSizeParameters, readPair, chain0, chain1));
       if (isPair) {
         pairsFound[0].at(i0) = true;
         pairsFound[1].at(i1) = true;
@@ -783,9 +902,18 @@ AlignmentPairs::iterator Aligner::getAlignments(
     }
   }
 
-  // when running without sw-all, apply smith-waterman to all that matters
+  // when running without sw-all, apply smith-waterman to all that matters. Visiting the pairs in another
+  // order would change which perfect pairs the +20 margin leaves out, and with them the XS and MAPQ
+  std::vector<bool>& skipped = smithWatermanPending_;
+  skipped.assign(unpairedAlignments_[0].size() + unpairedAlignments_[1].size(), false);
   for (auto& alignmentPair : alignmentPairs) {
     const auto seedChains = alignmentPair.getSeedChains();
+    if ((nullptr != seedChains[0]) && (nullptr != seedChains[1]) && alignmentPair.isPerfect() &&
+        (alignmentPair.getPotentialScore() + 20 < bestPairedScore)) {
+      // the alignments of the pairs with a seed chain for each read are in unpairedAlignments_
+      skipped.at(&alignmentPair[0] - &unpairedAlignments_[0][0]) = true;
+      skipped.at(unpairedAlignments_[0].size() + (&alignmentPair[1] - &unpairedAlignments_[1][0])) = true;
+    }
     if ((nullptr != seedChains[0]) && (nullptr != seedChains[1]) &&
         ((!alignmentPair.isPerfect()) || (alignmentPair.getPotentialScore() + 20 >= bestPairedScore))) {
       for (unsigned i = 0; 2 > i; ++i) {
@@ -822,6 +950,13 @@ AlignmentPairs::iterator Aligner::getAlignments(
     }
   }
 
+  // alignments shared by several pairs count once, and not at all if another pair aligned them
+  for (std::size_t i = 0; skipped.size() != i; ++i) {
+    const bool        read1 = unpairedAlignments_[0].size() <= i;
+    const std::size_t index = read1 ? i - unpairedAlignments_[0].size() : i;
+    smithWatermanSkipped_ += skipped[i] && !unpairedAlignments_[read1][index].isSmithWatermanDone();
+  }
+
   if (vectorizedSW_) {
     vectorSmithWaterman_.destroyReadContext(0);
     vectorSmithWaterman_.destroyReadContext(1);
@@ -973,28 +1108,27 @@ void Aligner::filter(AlignmentPairs& alignmentPairs, std::array<Alignments, 2>&
 
 void Aligner::filter(Alignments& alignments)
 {
-  // TODO: optimize (quadratic complexity)
+  // TODO: add filtering for matching end positions
+  // for each reference position, the alignment currently winning over the previous ones at the same position
+  filterWinners_.clear();
   for (unsigned int i = 0; alignments.size() > i; ++i) {
-    auto& a = alignments.at(i);
-    if (a.isFiltered()) {
+    auto& b = alignments.at(i);
+    if (b.isFiltered()) {
       continue;
     }
-    for (unsigned int j = i + 1; alignments.size() > j; ++j) {
-      auto& b = alignments.at(j);
-      if (b.isFiltered()) {
-        continue;
-      }
-      // TODO: add filtering for matching end positions
-      if ((a.getReference() == b.getReference()) && (a.getPosition() == b.getPosition())) {
-        if (a.getScore() < b.getScore()) {
-          a.setFiltered(true);
-          a.setScore(0);
-          break;
-        } else {
-          b.setFiltered(true);
-          b.setScore(0);
-        }
-      }
+    const uint64_t key = (uint64_t(uint16_t(b.getReference())) << 32) | uint32_t(b.getPosition());
+    const auto     winner = filterWinners_.insert(std::make_pair(key, i));
+    if (winner.second) {
+      continue;
+    }
+    auto& a = alignments.at(winner.first->second);
+    if (a.getScore() < b.getScore()) {
+      a.setFiltered(true);
+      a.setScore(0);
+      winner.first->second = i;
+    } else {
+      b.setFiltered(true);
+      b.setScore(0);
     }
   }
 }
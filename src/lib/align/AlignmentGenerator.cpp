@@ -15,6 +15,7 @@
 #include "align/AlignmentGenerator.hpp"
 #include "align/CalculateRefStartEnd.hpp"
 #include "common/DragenLogger.hpp"
+#include "common/Profiler.hpp"
 
 namespace dragenos {
 namespace align {
@@ -81,21 +82,27 @@ void updateIneligibility(const reference::HashtableConfig& hashtableConfig, Alig
 }
 
 bool AlignmentGenerator::generateAlignment(
-    const ScoreType alnMinScore,
-    const Read&     read,
-    map::SeedChain  seedChain,
-    Alignment&      alignment,
-    const int       readIdx)
+    const ScoreType       alnMinScore,
+    const Read&           read,
+    const map::SeedChain& chain,
+    Alignment&            alignment,
+    const int             readIdx)
 {
-  if (seedChain.isFiltered()) {
+  if (chain.isFiltered()) {
     return false;
   }
+  const common::StageTimer timer(common::Stage::SMITH_WATERMAN);
+  ++alignmentCount_;
+
+  // the assignment keeps the storage of the previous chain
+  fetchChain_               = chain;
+  map::SeedChain& seedChain = fetchChain_;
 
   updateFetchChain(read, seedChain, alignment);
 
   DRAGEN_S_W_FETCH_LOG << seedChain << std::endl;
 
-  Database database;
+  Database& database = database_;
   // TODO: create the database as a vector of unsigned char, 1 base per unsigned char, encoded on 2 bits
   //const auto databaseBegin = referenceDir_.getReference() + seedChain.firstReferencePosition();
   //const auto databaseEnd = referenceDir_.getReference() + seedChain.lastReferencePosition() + 1;
@@ -129,11 +136,11 @@ bool AlignmentGenerator::generateAlignment(
   //  std::cerr << "beginPosition=" << beginPosition << " endPosition=" << endPosition << std::endl;
 
   //  assert(endPosition > beginPosition);
-  database.clear();
+  database.resize(endPosition - beginPosition);
   if (seedChain.isReverseComplement()) {
-    referenceDir_.getReferenceSequence().getRcBases(beginPosition, endPosition, std::back_inserter(database));
+    referenceDir_.getReferenceSequence().getRcBases(beginPosition, endPosition, database.data());
   } else {
-    referenceDir_.getReferenceSequence().getBases(beginPosition, endPosition, std::back_inserter(database));
+    referenceDir_.getReferenceSequence().getBases(beginPosition, endPosition, database.data());
   }
 
   // align the read for the current seedChain
@@ -147,12 +154,25 @@ bool AlignmentGenerator::generateAlignment(
   // initialize the query from the base and the orientation of the seedChain
   const auto& query = read.getBases();
   int         move  = 0;
-  std::string operations;
+  std::string& operations = operations_;
   FlagType    flags = !read.getPosition() ? Alignment::FIRST_IN_TEMPLATE : Alignment::LAST_IN_TEMPLATE;
   {
     ScoreType scoreSW;
 
-    if (vectorizedSW_ && query.size() > 30) {
+    // the query starts on the diagonal SW_CELLS + 1 of the database (see calculateRefStartEnd)
+    static const int expectedDiagonal = SmithWaterman::SW_CELLS + 1;
+    if (wavefrontSW_ && wfaAligner_.align(
+                            query.data(),
+                            query.data() + query.size(),
+                            database.data(),
+                            database.data() + database.size(),
+                            seedChain.isReverseComplement(),
+                            expectedDiagonal - SmithWaterman::SW_CELLS,
+                            expectedDiagonal + SmithWaterman::SW_CELLS + 1,
+                            operations,
+                            scoreSW)) {
+      // within the edit limit of the wavefront alignment
+    } else if (vectorizedSW_ && query.size() > 30) {
       scoreSW = vectorSmithWaterman_.align(
           query.data(),
           query.data() + query.size(),
@@ -81,11 +81,13 @@ uint32_t AlignmentRescue::getReferenceInterval(
   //  const int ref_length = ((((last_ref_pos + 1 - first_ref_pos) + 3) >> 2) << 2);
   //  const int ref_length = (last_ref_pos + 1 - first_ref_pos);
   assert(first_ref_pos <= last_ref_pos);
+  const auto fetchOffset = referenceBases.size();
+  referenceBases.resize(fetchOffset + ref_length);
   if (isReversedRescue(anchoredChain)) {
-    reference.getRcBases(last_ref_pos - ref_length + 1, last_ref_pos + 1, std::back_inserter(referenceBases));
+    reference.getRcBases(last_ref_pos - ref_length + 1, last_ref_pos + 1, referenceBases.data() + fetchOffset);
     std::reverse(referenceBases.begin(), referenceBases.end());
   } else {
-    reference.getBases(first_ref_pos, first_ref_pos + ref_length, std::back_inserter(referenceBases));
+    reference.getBases(first_ref_pos, first_ref_pos + ref_length, referenceBases.data() + fetchOffset);
   }
 
   // std::cerr << "after=" << after << ", anchorPosition=" << anchorPosition<< ", length=" << length << ", pe_min_insert_=" << pe_min_insert_ << ", rescuedReadLength=" << rescuedReadLength << ", minPosition= " << minPosition << ", referenceBases.size()=" << referenceBases.size() << ", isReversedRescue(anchoredChain): " << isReversedRescue(anchoredChain) << std::endl;
@@ -109,22 +111,6 @@ uint32_t AlignmentRescue::getReferenceInterval(
   return first_ref_pos;
 }
 
-__m128i mm_bitshift_left4(__m128i x)
-{
-  __m128i carry =
-      _mm_bslli_si128(x, 8);          // old compilers only have the confusingly named _mm_slli_si128 synonym
-  carry = _mm_srli_epi64(carry, 60);  // After bslli shifted left by 64b
-
-  x = _mm_slli_epi64(x, 4);
-  return _mm_or_si128(x, carry);
-}
-
-static inline int popcnt128(__m128i n)
-{
-  const __m128i n_hi = _mm_unpackhi_epi64(n, n);
-  return __builtin_popcountll(_mm_cvtsi128_si64(n)) + __builtin_popcountll(_mm_cvtsi128_si64(n_hi));
-}
-
 bool AlignmentRescue::scan(
     const Read&                         rescuedRead,
     const SeedChain&                    anchoredChain,
@@ -163,60 +149,20 @@ bool AlignmentRescue::scan(
     // the offsets that give the least number of mismatches for each kmer
     int bestOffsets[] = {scanLength, scanLength};
     int bestCounts[]  = {rescueKmers[0].size(), rescueKmers[1].size()};
-    const std::vector<unsigned char>::const_iterator startIterators[] = {
-        referenceBases.begin(), referenceBases.end() - scanLength - rescueKmers[1].size() - modOffset};
-    bool conflict = false;
+    const size_t startPositions[] = {0, referenceBases.size() - scanLength - rescueKmers[1].size() - modOffset};
+    bool         conflict         = false;
 
     // if (log)
     //   std::cerr << "referenceBases.size(): " << referenceBases.size() << ", scanLength=" << scanLength
     //           << ", rescueKmers[1].size()=" << rescueKmers[1].size() << std::endl;
 
-    __m128i kmer1_m = loadRescueKmer(rescueKmers[0]);
-    __m128i kmer2_m = loadRescueKmer(rescueKmers[1]);
-
-    __m128i refkmer1_m = loadRefKmer(startIterators[0], rescueKmers[0].size());
-    __m128i refkmer2_m = loadRefKmer(startIterators[1], rescueKmers[0].size());
-
-    for (int i = 0; scanLength > i; ++i) {
-      // get the number of mismatches for both kmer
-      //    const int mismatchCounts[] = {
-      //        countMismatches(rescueKmers[0], startIterators[0] + i),
-      //        countMismatches(rescueKmers[1], startIterators[1] + i)};
-
-      // count matches = compare with &, then popcount
-      __m128i comparek1 = _mm_and_si128(refkmer1_m, kmer1_m);
-      __m128i comparek2 = _mm_and_si128(refkmer2_m, kmer2_m);
-      int     nbmis0    = rescueKmers[0].size() - popcnt128(comparek1);
-      int     nbmis1    = rescueKmers[1].size() - popcnt128(comparek2);
-
-      const int mismatchCounts[] = {nbmis0, nbmis1};
-
-      // update best counts and best offsets
+    if (0 < scanLength) {
+      BitPlanes bitPlanes;
+      getBitPlanes(referenceBases, bitPlanes);
       for (int j = 0; j != 2; ++j) {
-        if (bestCounts[j] > mismatchCounts[j] or
-            (bestCounts[j] == mismatchCounts[j] and i <= scanLength / 2)) {
-          // flag a conflic if the kmer maps at multiple locations
-          conflict |= (bestCounts[j] <= RESCUE_MAX_SNPS);
-          bestCounts[j]  = mismatchCounts[j];
-          bestOffsets[j] = i;
-        }
+        scanKmer(
+            rescueKmers[j], bitPlanes, startPositions[j], scanLength, bestCounts[j], bestOffsets[j], conflict);
       }
-      // if (log) std::cerr << i << '\t' << mismatchCounts[0] << ":" << mismatchCounts[1] << " - " << bestCounts[0] << ":" << bestCounts[1] << " - " << bestOffsets[0] << ":" << bestOffsets[1] << std::endl;
-
-      unsigned char newBase;
-      // shift kmer window on reference by one base : shift left vector 4 bits and insert new base
-      refkmer1_m = mm_bitshift_left4(refkmer1_m);
-      newBase    = *(startIterators[0] + rescueKmers[0].size() - 1 + i + 1);
-      if (newBase == 0xF) newBase = 0;
-      __m128i newBase_m = _mm_setr_epi8(newBase, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-      refkmer1_m        = _mm_or_si128(refkmer1_m, newBase_m);
-
-      // idem for second kmer
-      refkmer2_m = mm_bitshift_left4(refkmer2_m);
-      newBase    = *(startIterators[1] + rescueKmers[0].size() - 1 + i + 1);
-      if (newBase == 0xF) newBase = 0;
-      newBase_m  = _mm_setr_epi8(newBase, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-      refkmer2_m = _mm_or_si128(refkmer2_m, newBase_m);
     }
 
     // flag a conflict and adjust the best offset if they are on different diagonals
@@ -294,49 +240,101 @@ int AlignmentRescue::countMismatches(
   return count;
 }
 
-__m128i AlignmentRescue::loadRescueKmer(AlignmentRescue::RescueKmer rescueKmer) const
+void AlignmentRescue::getBitPlanes(
+    const std::vector<unsigned char>& referenceBases, BitPlanes& bitPlanes) const
 {
-  // left most base on kmer =  highest address in vector
-  std::array<unsigned char, 16> kmer_packed;
-  int                           jj     = 0;
-  unsigned char                 packed = 0;
-  for (size_t ii = 0; rescueKmer.size() != ii; ++ii) {
-    packed = packed << 4;
-    packed |= rescueKmer[ii];
-
-    if (ii & 1) {
-      kmer_packed[15 - jj] = packed;
-      jj++;
-      packed = 0;
+  static constexpr unsigned char N = 0xF;
+  // one extra word to extract 64 bits starting from any position
+  const size_t wordCount = referenceBases.size() / 64 + 2;
+  for (auto& bitPlane : bitPlanes) {
+    bitPlane.assign(wordCount, 0);
+  }
+  size_t position = 0;
+  // bits are moved to the MSB of each byte and gathered 16 positions at a time
+  const __m128i n = _mm_set1_epi8(N);
+  for (; position + 16 <= referenceBases.size(); position += 16) {
+    __m128i bases = _mm_loadu_si128(reinterpret_cast<const __m128i*>(referenceBases.data() + position));
+    bases         = _mm_andnot_si128(_mm_cmpeq_epi8(bases, n), bases);
+    const uint64_t shift = position % 64;
+    bitPlanes[0][position / 64] |= uint64_t(_mm_movemask_epi8(_mm_slli_epi16(bases, 7))) << shift;
+    bitPlanes[1][position / 64] |= uint64_t(_mm_movemask_epi8(_mm_slli_epi16(bases, 6))) << shift;
+    bitPlanes[2][position / 64] |= uint64_t(_mm_movemask_epi8(_mm_slli_epi16(bases, 5))) << shift;
+    bitPlanes[3][position / 64] |= uint64_t(_mm_movemask_epi8(_mm_slli_epi16(bases, 4))) << shift;
+  }
+  for (; referenceBases.size() > position; ++position) {
+    const unsigned char base = (N == referenceBases[position]) ? 0 : referenceBases[position];
+    for (unsigned b = 0; bitPlanes.size() > b; ++b) {
+      bitPlanes[b][position / 64] |= uint64_t((base >> b) & 1) << (position % 64);
     }
   }
-  __m128i kmer_mm = _mm_loadu_si128((__m128i*)kmer_packed.data());
-
-  return kmer_mm;
 }
 
-// load kmer from reference into mm128 vector, and set all non ATCG to 0
-__m128i AlignmentRescue::loadRefKmer(std::vector<unsigned char>::const_iterator refIter, size_t size) const
+void AlignmentRescue::scanKmer(
+    const RescueKmer& rescueKmer,
+    const BitPlanes&  bitPlanes,
+    const size_t      start,
+    const int         scanLength,
+    int&              bestCount,
+    int&              bestOffset,
+    bool&             conflict) const
 {
-  std::array<unsigned char, 16> kmer_packed;
-
-  unsigned char packed = 0;
-  int           jj     = 0;
-  for (size_t ii = 0; size != ii; ++ii) {
-    packed             = packed << 4;
-    unsigned char pval = *(refIter + ii);
-    if (pval == 0xF) pval = 0;
-    packed |= pval;
-    if (ii & 1) {
-      kmer_packed[15 - jj] = packed;
-      jj++;
-      packed = 0;
+  // up to 4 matching bits for each of the 32 bases of the kmer
+  static constexpr int COUNTER_BITS = 8;
+  const auto           extract64    = [](const std::vector<uint64_t>& bitPlane, const size_t position) {
+    const size_t   word  = position / 64;
+    const unsigned shift = position % 64;
+    return shift ? ((bitPlane[word] >> shift) | (bitPlane[word + 1] << (64 - shift))) : bitPlane[word];
+  };
+  const int kmerSize = rescueKmer.size();
+  for (int blockOffset = 0; scanLength > blockOffset; blockOffset += 64) {
+    // bit-sliced counters: bit i of counter[p] is the bit p of the match count at offset blockOffset + i
+    std::array<uint64_t, COUNTER_BITS> counter;
+    counter.fill(0);
+    for (int j = 0; kmerSize != j; ++j) {
+      for (unsigned b = 0; bitPlanes.size() > b; ++b) {
+        if (rescueKmer[j] & (1 << b)) {
+          uint64_t carry = extract64(bitPlanes[b], start + blockOffset + j);
+          for (unsigned p = 0; carry; ++p) {
+            const uint64_t nextCarry = counter[p] & carry;
+            counter[p] ^= carry;
+            carry = nextCarry;
+          }
+        }
+      }
+    }
+    // select the offsets with at least kmerSize - bestCount matches, i.e. that could update the best count
+    const int threshold = std::max(0, kmerSize - bestCount);
+    uint64_t  greater   = 0;
+    uint64_t  equal     = ~uint64_t(0);
+    for (int p = COUNTER_BITS - 1; 0 <= p; --p) {
+      if ((threshold >> p) & 1) {
+        equal &= counter[p];
+      } else {
+        greater |= equal & counter[p];
+        equal &= ~counter[p];
+      }
+    }
+    const int blockLength = std::min(64, scanLength - blockOffset);
+    uint64_t  candidates  = greater | equal;
+    if (64 > blockLength) {
+      candidates &= (uint64_t(1) << blockLength) - 1;
+    }
+    for (; candidates; candidates &= candidates - 1) {
+      const int lane       = __builtin_ctzll(candidates);
+      int       matchCount = 0;
+      for (int p = 0; COUNTER_BITS != p; ++p) {
+        matchCount |= int((counter[p] >> lane) & 1) << p;
+      }
+      const int i             = blockOffset + lane;
+      const int mismatchCount = kmerSize - matchCount;
+      if (bestCount > mismatchCount or (bestCount == mismatchCount and i <= scanLength / 2)) {
+        // flag a conflic if the kmer maps at multiple locations
+        conflict |= (bestCount <= RESCUE_MAX_SNPS);
+        bestCount  = mismatchCount;
+        bestOffset = i;
+      }
     }
   }
-
-  __m128i refkmer_mm = _mm_loadu_si128((__m128i*)kmer_packed.data());
-
-  return refkmer_mm;
 }
 
 std::array<AlignmentRescue::RescueKmer, 2> AlignmentRescue::getRescueKmers(
@@ -12,7 +12,13 @@
  **
  **/
 
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
 #include "align/InsertSizeDistribution.hpp"
+#include "common/Exceptions.hpp"
 
 namespace dragenos {
 namespace align {
@@ -39,6 +45,7 @@ InsertSizeDistribution::InsertSizeDistribution(
     uint32_t      alignerResqueMaxIns,
     std::ostream& logStream)
   : samplingEnabled_(samplingEnabled),
+    peOrientation_(alignerPeOrientation),
     dragenInsertStats_(
         0,                        // read group index
         false,                    // true for RNA, false for DNA
@@ -122,5 +129,79 @@ void InsertSizeDistribution::forceInitDoneSending()
   dragenInsertStats_.checkForInitComplete();
 }
 
+static std::string getModelHeader()
+{
+  return std::string("RG\tORIENTATION\t") + StatsInterval::MODEL_HEADER;
+}
+
+void InsertSizeDistribution::saveModel(std::ostream& os, const std::string& readGroup) const
+{
+  os << getModelHeader() << "\n";
+  os << readGroup << "\t" << peOrientation_ << "\t";
+  if (samplingEnabled_) {
+    dragenInsertStats_.getLatestStats().writeModel(os);
+  } else {
+    fixedStats_.writeModel(os);
+  }
+  os << std::endl;
+}
+
+void InsertSizeDistribution::saveModel(const std::string& path, const std::string& readGroup) const
+{
+  std::ofstream os(path);
+  if (!os) {
+    BOOST_THROW_EXCEPTION(common::IoException(
+        errno, std::string("Failed to create insert size model file: ") + path + ": " + strerror(errno)));
+  }
+  saveModel(os, readGroup);
+  if (!os) {
+    BOOST_THROW_EXCEPTION(common::IoException(
+        errno, std::string("Failed to write insert size model file: ") + path + ": " + strerror(errno)));
+  }
+}
+
+void InsertSizeDistribution::loadModel(std::istream& is, const std::string& readGroup)
+{
+  std::string line;
+  if (!std::getline(is, line) || getModelHeader() != line) {
+    BOOST_THROW_EXCEPTION(
+        common::InvalidParameterException("Unexpected header in insert size model: " + line));
+  }
+  while (std::getline(is, line)) {
+    std::istringstream row(line);
+    std::string        rg;
+    uint32_t           orientation = 0;
+    if (!std::getline(row, rg, '\t') || !(row >> orientation)) {
+      BOOST_THROW_EXCEPTION(common::InvalidParameterException("Malformed insert size model line: " + line));
+    }
+    if (readGroup != rg) {
+      continue;
+    }
+    if (peOrientation_ != orientation) {
+      BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+          "Insert size model for read group " + rg + " has orientation " + std::to_string(orientation) +
+          " instead of " + std::to_string(peOrientation_)));
+    }
+    const bool loaded =
+        samplingEnabled_ ? dragenInsertStats_.loadModel(row) : fixedStats_.readModel(row);
+    if (!loaded) {
+      BOOST_THROW_EXCEPTION(common::InvalidParameterException("Malformed insert size model line: " + line));
+    }
+    return;
+  }
+  BOOST_THROW_EXCEPTION(
+      common::InvalidParameterException("No insert size model found for read group " + readGroup));
+}
+
+void InsertSizeDistribution::loadModel(const std::string& path, const std::string& readGroup)
+{
+  std::ifstream is(path);
+  if (!is) {
+    BOOST_THROW_EXCEPTION(common::IoException(
+        errno, std::string("Failed to open insert size model file: ") + path + ": " + strerror(errno)));
+  }
+  loadModel(is, readGroup);
+}
+
 }  // namespace align
 }  // namespace dragenos
@@ -12,8 +12,11 @@
  **
  **/
 
+#include <algorithm>
+
 #include "align/AlignmentRescue.hpp"
 #include "align/PairBuilder.hpp"
+#include "align/Pairs.hpp"
 #include "align/Tlen.hpp"
 
 namespace dragenos {
@@ -36,11 +39,10 @@ std::pair<int, int> calculateEffBegEnd(const sequences::Read& read, const map::S
   }
 }
 
-bool pairMatch(
+PairMatchWindow getPairMatchWindow(
     const InsertSizeParameters& insertSizeParameters,
     const sequences::ReadPair&  readPair,
-    const map::SeedChain&       first,
-    const map::SeedChain&       second)
+    const map::SeedChain&       first)
 {
   using Orientation = InsertSizeParameters::Orientation;
   bool end1_pair_rc = false;
@@ -101,14 +103,26 @@ bool pairMatch(
     break;
   }
 
+  return PairMatchWindow{
+      end1_pair_rc, end1_pair_min_beg, end1_pair_max_beg, end1_pair_min_end, end1_pair_max_end};
+}
+
+bool pairMatch(
+    const InsertSizeParameters& insertSizeParameters,
+    const sequences::ReadPair&  readPair,
+    const map::SeedChain&       first,
+    const map::SeedChain&       second)
+{
+  const PairMatchWindow window = getPairMatchWindow(insertSizeParameters, readPair, first);
+
   const std::pair<int, int> r2_eff_beg_end = calculateEffBegEnd(readPair[0], second);
 
   //  -- Pair match if orientation as expected, and either the effective beginning or end is in the expected
   //  inteval
   const bool pair_match =
-      !(end1_pair_rc ^ second.isReverseComplement()) &&
-      (((r2_eff_beg_end.first >= end1_pair_min_beg) && (r2_eff_beg_end.first <= end1_pair_max_beg)) ||
-       ((r2_eff_beg_end.second >= end1_pair_min_end) && (r2_eff_beg_end.first <= end1_pair_max_end)));
+      !(window.reverseComplement ^ second.isReverseComplement()) &&
+      (((r2_eff_beg_end.first >= window.minBegin) && (r2_eff_beg_end.first <= window.maxBegin)) ||
+       ((r2_eff_beg_end.second >= window.minEnd) && (r2_eff_beg_end.first <= window.maxEnd)));
 
   //    std::cerr << "end1_pair_rc:" << end1_pair_rc << " second.isReverseComplement():" << second.isReverseComplement() <<
   //      " pipe3_eff_beg:" << r2_eff_beg_end.first << " pipe3_eff_end:" << r2_eff_beg_end.second <<
@@ -126,6 +140,48 @@ bool pairMatch(
   return pair_match;
 }
 
+void PairMatchFinder::reset(
+    const InsertSizeParameters& insertSizeParameters,
+    const sequences::ReadPair&  readPair,
+    const map::ChainBuilder&    secondChains)
+{
+  insertSizeParameters_ = &insertSizeParameters;
+  readPair_             = &readPair;
+  mates_.clear();
+  maxSpan_ = 0;
+  for (unsigned i = 0; secondChains.size() > i; ++i) {
+    const map::SeedChain& second = secondChains.at(i);
+    // same as pairMatch: the effective begin and end of the mate are computed with the first read
+    const std::pair<int, int> effBegEnd = calculateEffBegEnd(readPair[0], second);
+    mates_.push_back(Mate{second.isReverseComplement(), effBegEnd.first, effBegEnd.second, i});
+    maxSpan_ = std::max(maxSpan_, effBegEnd.second - effBegEnd.first);
+  }
+  std::sort(mates_.begin(), mates_.end());
+}
+
+void PairMatchFinder::find(const map::SeedChain& first, std::vector<unsigned>& matches) const
+{
+  matches.clear();
+  const PairMatchWindow window = getPairMatchWindow(*insertSizeParameters_, *readPair_, first);
+  // an effective end of at least minEnd implies an effective begin of at least minEnd - maxSpan_
+  const std::pair<int, int> ranges[] = {{window.minBegin, window.maxBegin},
+                                        {window.minEnd - maxSpan_, window.maxEnd}};
+  for (const auto& range : ranges) {
+    auto mate = std::lower_bound(
+        mates_.begin(), mates_.end(), Mate{window.reverseComplement, range.first, range.first, 0});
+    for (; mates_.end() != mate && window.reverseComplement == mate->reverseComplement &&
+           range.second >= mate->begin;
+         ++mate) {
+      if ((mate->begin >= window.minBegin && mate->begin <= window.maxBegin) ||
+          (mate->end >= window.minEnd && mate->begin <= window.maxEnd)) {
+        matches.push_back(mate->index);
+      }
+    }
+  }
+  std::sort(matches.begin(), matches.end());
+  matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+}
+
 /**
  * \brief State machine states: S_EFF_EDGES S_PICK_EDGES S_INSERT_LEN S_INSERT_DIFF
  */
@@ -0,0 +1,27 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include "align/RecordEncoder.hpp"
+
+namespace dragenos {
+namespace align {
+
+void SamRecordEncoder::encode(
+    std::ostream& os, const sequences::SerializedRead& read, const SerializedAlignment& alignment)
+{
+  sam_.generateRecord(os, read, alignment, rgid_) << "\n";
+}
+
+}  // namespace align
+}  // namespace dragenos
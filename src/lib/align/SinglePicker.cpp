@@ -118,6 +118,145 @@ void SinglePicker::updateMapq(const int readLength, Alignments& alignments, Alig
   best->setXs(xs);
 }
 
+void SinglePicker::SettledAlignments::reset(const Alignments& alignments, const std::vector<bool>& pending)
+{
+  assert(alignments.size() == pending.size());
+  alignments_ = &alignments;
+  pending_.assign(pending.begin(), pending.end());
+  outsideBest_.assign(pending.size(), false);
+  pendingOutsideBest_ = 0;
+  best_               = nullptr;
+  for (std::size_t i = 0; alignments.size() != i; ++i) {
+    if (!pending_[i] && (nullptr == best_ || best_->getScore() < alignments[i].getScore())) {
+      best_ = &alignments[i];
+    }
+  }
+  updateBest();
+}
+
+void SinglePicker::SettledAlignments::settle(const std::size_t i)
+{
+  assert(pending_.at(i));
+  const Alignment& alignment = (*alignments_)[i];
+  pending_[i]                = false;
+  if (outsideBest_[i]) {
+    outsideBest_[i] = false;
+    --pendingOutsideBest_;
+  }
+
+  // the alignments are in storage order, which decides the ties
+  if (nullptr == best_ || best_->getScore() < alignment.getScore() ||
+      (best_->getScore() == alignment.getScore() && &alignment < best_)) {
+    best_ = &alignment;
+    updateBest();
+    return;
+  }
+
+  const bool eligible = !alignment.getIneligibilityStatus() && !alignment.isUnmapped();
+  if (eligible && !best_->isDuplicate(alignment)) {
+    if (best_->isOverlap(alignment)) {
+      if (nullptr == secondBest_ || secondBest_->getScore() < alignment.getScore()) {
+        secondBest_ = &alignment;
+      }
+    } else if (
+        nullptr == supplementary_ || supplementary_->getScore() < alignment.getScore() ||
+        (supplementary_->getScore() == alignment.getScore() && &alignment < supplementary_)) {
+      supplementary_           = &alignment;
+      supplementarySecondBest_ = findSettledBest(*supplementary_, true);
+      return;
+    }
+  }
+  if (eligible && nullptr != supplementary_ && !supplementary_->isDuplicate(alignment) &&
+      supplementary_->isOverlap(alignment) &&
+      (nullptr == supplementarySecondBest_ || supplementarySecondBest_->getScore() < alignment.getScore())) {
+    supplementarySecondBest_ = &alignment;
+  }
+}
+
+void SinglePicker::SettledAlignments::updateBest()
+{
+  secondBest_              = nullptr;
+  supplementary_           = nullptr;
+  supplementarySecondBest_ = nullptr;
+  pendingOutsideBest_      = 0;
+  if (nullptr == best_) {
+    return;
+  }
+
+  secondBest_    = findSettledBest(*best_, true);
+  supplementary_ = findSettledBest(*best_, false);
+  if (nullptr != supplementary_) {
+    supplementarySecondBest_ = findSettledBest(*supplementary_, true);
+  }
+  for (std::size_t i = 0; alignments_->size() != i; ++i) {
+    const Alignment& alignment = (*alignments_)[i];
+    outsideBest_[i] = pending_[i] && (alignment.getCigar().empty() || !best_->isOverlap(alignment));
+    pendingOutsideBest_ += outsideBest_[i];
+  }
+}
+
+const Alignment* SinglePicker::SettledAlignments::findSettledBest(
+    const Alignment& primary, const bool overlap) const
+{
+  const Alignment* ret = nullptr;
+  for (std::size_t i = 0; alignments_->size() != i; ++i) {
+    const Alignment& alignment = (*alignments_)[i];
+    if (!pending_[i] && !alignment.getIneligibilityStatus() && !alignment.isUnmapped() &&
+        (nullptr == ret || ret->getScore() < alignment.getScore()) && !primary.isDuplicate(alignment) &&
+        overlap == primary.isOverlap(alignment)) {
+      ret = &alignment;
+    }
+  }
+  return ret;
+}
+
+ScoreType SinglePicker::getMinRelevantScore(const int readLength, const SettledAlignments& settled) const
+{
+  const Alignment* const best = settled.getBest();
+  if (nullptr == best) {
+    return INVALID_SCORE;
+  }
+
+  // primary: ties go to the first alignment, which could be a pending one
+  ScoreType ret = best->getScore();
+
+  // MAPQ and XS: a pending alignment must beat the second best and alnMinScore_ to be seen
+  const Alignment* const secondBest = settled.getSecondBest();
+  ret = std::min(ret, std::max(alnMinScore_, nullptr == secondBest ? alnMinScore_ : secondBest->getScore() + 1));
+
+  // secondary: even with no secondary alignments allowed, aln_cfg_sec_aligns_hard_ counts them
+  if (aln_cfg_sec_aligns_ || aln_cfg_sec_aligns_hard_) {
+    ret = std::min(ret, std::max(alnMinScore_, best->getScore() - getSecAlnDelta(readLength)));
+  }
+
+  // supplementary: a pending alignment must qualify and beat the settled candidate, which otherwise keeps
+  // its own MAPQ and XS. Pending alignments already overlapping the primary are not expected to become
+  // supplementary
+  const Alignment* const supplementary = settled.getSupplementary();
+  if (nullptr != supplementary && suppMinScoreAdj_ <= (supplementary->getScore() - alnMinScore_)) {
+    const Alignment* const suppSecondBest = settled.getSupplementarySecondBest();
+    ret                                   = std::min(
+        ret,
+        std::max(alnMinScore_, nullptr == suppSecondBest ? alnMinScore_ : suppSecondBest->getScore() + 1));
+  }
+  if (settled.hasPendingOutsideBest()) {
+    ret = std::min(
+        ret,
+        std::max(
+            alnMinScore_ + suppMinScoreAdj_, nullptr == supplementary ? INVALID_SCORE : supplementary->getScore()));
+  }
+
+  return ret;
+}
+
+ScoreType SinglePicker::getMinRelevantScore(
+    const int readLength, const Alignments& alignments, const std::vector<bool>& pending) const
+{
+  SettledAlignments settled;
+  settled.reset(alignments, pending);
+  return getMinRelevantScore(readLength, settled);
+}
+
 Alignments::iterator SinglePicker::pickBest(const int readLength, Alignments& alignments) const
 {
   Alignments::iterator best = std::max_element(
@@ -0,0 +1,79 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <sstream>
+
+#include "align/SlowReadLog.hpp"
+
+namespace dragenos {
+namespace align {
+
+SlowReadLog::SlowReadLog(std::ostream& os, const uint64_t threshold) : os_(os), threshold_(threshold), count_(0)
+{
+  os_ << "#name\tlength\tmate_length\tmicroseconds\tchains\tsmith_waterman\trescues\n" << std::flush;
+}
+
+void SlowReadLog::Pending::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  lines_.clear();
+  count_ = 0;
+}
+
+void SlowReadLog::add(
+    const sequences::Read& read,
+    const sequences::Read* mate,
+    const Counters&        counters,
+    const uint64_t         nanoseconds,
+    Pending*               pending)
+{
+  // formatted before taking the lock
+  std::ostringstream line;
+  line.write(read.getName().begin(), read.getName().size());
+  line << "\t" << read.getLength() << "\t" << (mate ? mate->getLength() : 0) << "\t" << nanoseconds / 1000 << "\t"
+       << counters.chains << "\t" << counters.smithWatermanCalls << "\t" << counters.rescues << "\n";
+  if (pending) {
+    std::lock_guard<std::mutex> lock(pending->mutex_);
+    pending->lines_ += line.str();
+    ++pending->count_;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  os_ << line.str();
+  ++count_;
+}
+
+void SlowReadLog::record(Pending& pending)
+{
+  std::lock_guard<std::mutex> pendingLock(pending.mutex_);
+  if (!pending.count_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    os_ << pending.lines_;
+    count_ += pending.count_;
+  }
+  pending.lines_.clear();
+  pending.count_ = 0;
+}
+
+std::size_t SlowReadLog::getCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+}  // namespace align
+}  // namespace dragenos
@@ -55,6 +55,20 @@ void VectorSmithWaterman::initReadContext(
   profileRev_[readIdx] = ssw_init(queryRevBeginInt, querySize_[readIdx], sswScoringMat_, sswAlphabetSize_, 2);
 }
 
+std::size_t VectorSmithWaterman::getProfileBytes() const
+{
+  std::size_t ret = 0;
+  for (int readIdx = 0; 2 != readIdx; ++readIdx) {
+    if (profile_[readIdx]) {
+      // 128-bit registers of 16 8-bit and of 8 16-bit scores for each letter, in both directions. The
+      // profile headers are opaque and negligible
+      const std::size_t segments = (querySize_[readIdx] + 15) / 16 + (querySize_[readIdx] + 7) / 8;
+      ret += 2 * segments * sswAlphabetSize_ * 16;
+    }
+  }
+  return ret;
+}
+
 // returns alignment score
 // returns operations list in cigar
 uint16_t VectorSmithWaterman::align(
@@ -0,0 +1,328 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/format.hpp>
+
+#include "align/WfaAligner.hpp"
+#include "common/Exceptions.hpp"
+
+namespace dragenos {
+namespace align {
+
+/// marks the unreachable cells. Far enough from the limits to survive an increment
+static const int NONE = std::numeric_limits<int>::min() / 2;
+
+WfaAligner::WfaAligner(
+    const SimilarityScores& similarity,
+    const int               gapInit,
+    const int               gapExtend,
+    const int               unclipScore,
+    const int               maxEdits)
+  : similarity_(similarity),
+    gapInit_(gapInit),
+    gapExtend_(gapExtend),
+    unclipScore_(unclipScore),
+    mismatchPenalty_(similarity.match_ - similarity.mismatch_),
+    mismatchNPenalty_(similarity.match_ - similarity.nScore_),
+    insertionOpenPenalty_(gapInit + similarity.match_),
+    insertionExtendPenalty_(gapExtend + similarity.match_),
+    deletionOpenPenalty_(gapInit),
+    deletionExtendPenalty_(gapExtend),
+    maxPenalty_(maxEdits * mismatchPenalty_),
+    database_(nullptr),
+    databaseSize_(0),
+    diagonalBegin_(0),
+    width_(0)
+{
+  // each step of the wavefront recursion must move to a strictly higher penalty
+  if (0 >= similarity_.match_ || 0 >= mismatchPenalty_ || 0 >= mismatchNPenalty_ || 0 >= gapExtend_ ||
+      0 >= gapInit_ || 0 > unclipScore_) {
+    BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+        (boost::format("Scores not supported by the wavefront alignment: match=%d mismatch=%d n=%d "
+                       "gap-init=%d gap-extend=%d unclip=%d") %
+         similarity_.match_ % similarity_.mismatch_ % similarity_.nScore_ % gapInit_ % gapExtend_ %
+         unclipScore_)
+            .str()));
+  }
+}
+
+int WfaAligner::get(const std::vector<int>& wavefront, const int penalty, const int diagonal) const
+{
+  if (0 > penalty || diagonalBegin_ > diagonal || diagonalBegin_ + width_ <= diagonal) {
+    return NONE;
+  }
+  return wavefront[penalty * width_ + diagonal - diagonalBegin_];
+}
+
+void WfaAligner::computeWavefront(const int penalty)
+{
+  const int querySize = query_.size();
+  const int match     = similarity_.match_;
+  const int start     = penalty * width_;
+  m_.resize(start + width_);
+  i_.resize(start + width_);
+  d_.resize(start + width_);
+  mSource_.resize(start + width_);
+  iSource_.resize(start + width_);
+  dSource_.resize(start + width_);
+  for (int diagonal = diagonalBegin_; diagonalBegin_ + width_ > diagonal; ++diagonal) {
+    const int cell = start + diagonal - diagonalBegin_;
+
+    // insertion: one more query base on the same database offset
+    const int insertionOpen   = get(m_, penalty - insertionOpenPenalty_, diagonal + 1);
+    const int insertionExtend = get(i_, penalty - insertionExtendPenalty_, diagonal + 1);
+    iSource_[cell]            = insertionOpen >= insertionExtend ? OPEN : EXTEND;
+    i_[cell]                  = std::max(insertionOpen, insertionExtend);
+    if (NONE != i_[cell] && i_[cell] - diagonal > querySize) {
+      i_[cell] = NONE;
+    }
+
+    // deletion: one more database base on the same query offset
+    const int deletionOpen   = get(m_, penalty - deletionOpenPenalty_, diagonal - 1);
+    const int deletionExtend = get(d_, penalty - deletionExtendPenalty_, diagonal - 1);
+    dSource_[cell]           = deletionOpen >= deletionExtend ? OPEN : EXTEND;
+    d_[cell]                 = std::max(deletionOpen, deletionExtend);
+    if (NONE != d_[cell]) {
+      d_[cell] = (d_[cell] < databaseSize_) ? d_[cell] + 1 : NONE;
+    }
+
+    int    offset = NONE;
+    Source source = START;
+    // mismatches extend the cells where the matches stopped
+    for (const Source mismatch : {MISMATCH, MISMATCH_N}) {
+      const int from =
+          get(m_, penalty - (MISMATCH == mismatch ? mismatchPenalty_ : mismatchNPenalty_), diagonal);
+      if (NONE != from && databaseSize_ > from && querySize > from - diagonal) {
+        const bool n = isN(query_[from - diagonal]) || isN(database_[from]);
+        if ((MISMATCH_N == mismatch) == n && from + 1 > offset) {
+          offset = from + 1;
+          source = mismatch;
+        }
+      }
+    }
+    if (i_[cell] > offset) {
+      offset = i_[cell];
+      source = INSERTION;
+    }
+    if (d_[cell] > offset) {
+      offset = d_[cell];
+      source = DELETION;
+    }
+    // starting points, with the first queryOffset bases soft clipped
+    int queryOffset = -1;
+    if (0 == penalty) {
+      queryOffset = 0;
+    } else if (penalty > unclipScore_ && 0 == (penalty - unclipScore_) % match) {
+      queryOffset = (penalty - unclipScore_) / match;
+    }
+    if (0 <= queryOffset && querySize > queryOffset && 0 <= diagonal + queryOffset &&
+        databaseSize_ >= diagonal + queryOffset && diagonal + queryOffset > offset) {
+      offset = diagonal + queryOffset;
+      source = START;
+    }
+
+    // follow the matches along the diagonal
+    if (NONE != offset) {
+      for (int queryPosition = offset - diagonal; querySize > queryPosition && databaseSize_ > offset &&
+                                                  query_[queryPosition] == database_[offset] &&
+                                                  !isN(query_[queryPosition]);
+           ++queryPosition) {
+        ++offset;
+      }
+    }
+    m_[cell]       = offset;
+    mSource_[cell] = source;
+  }
+}
+
+bool WfaAligner::align(
+    const unsigned char* queryBegin,
+    const unsigned char* queryEnd,
+    const unsigned char* databaseBegin,
+    const unsigned char* databaseEnd,
+    const bool           reverseQuery,
+    const int            diagonalBegin,
+    const int            diagonalEnd,
+    std::string&         operations,
+    ScoreType&           score)
+{
+  if (reverseQuery) {
+    query_.assign(std::reverse_iterator<const unsigned char*>(queryEnd),
+                  std::reverse_iterator<const unsigned char*>(queryBegin));
+  } else {
+    query_.assign(queryBegin, queryEnd);
+  }
+  database_           = databaseBegin;
+  databaseSize_       = databaseEnd - databaseBegin;
+  const int querySize = query_.size();
+  // diagonals outside [-querySize, databaseSize] can't hold any cell
+  diagonalBegin_ = std::max(diagonalBegin, -querySize);
+  width_         = std::min(diagonalEnd, databaseSize_ + 1) - diagonalBegin_;
+  if (0 == querySize || 0 >= width_) {
+    return false;
+  }
+  m_.clear();
+  i_.clear();
+  d_.clear();
+  mSource_.clear();
+  iSource_.clear();
+  dSource_.clear();
+
+  // total penalty, including the soft clip at the end of the query
+  int bestPenalty  = std::numeric_limits<int>::max();
+  int bestLevel    = 0;
+  int bestDiagonal = 0;
+  int penalty      = 0;
+  for (; maxPenalty_ >= penalty && bestPenalty > penalty; ++penalty) {
+    computeWavefront(penalty);
+    for (int diagonal = diagonalBegin_; diagonalBegin_ + width_ > diagonal; ++diagonal) {
+      const int offset = m_[penalty * width_ + diagonal - diagonalBegin_];
+      if (NONE != offset) {
+        const int queryPosition = offset - diagonal;
+        const int total         = penalty + ((querySize == queryPosition)
+                                         ? 0
+                                         : unclipScore_ + similarity_.match_ * (querySize - queryPosition));
+        if (bestPenalty > total) {
+          bestPenalty  = total;
+          bestLevel    = penalty;
+          bestDiagonal = diagonal;
+        }
+      }
+    }
+  }
+
+  // anything found beyond the last penalty computed might not be optimal
+  if (bestPenalty > penalty) {
+    return false;
+  }
+
+  traceback(bestLevel, bestDiagonal, operations);
+  if (std::string::npos == operations.find_first_of("MID")) {
+    return false;
+  }
+  score = getScore(operations);
+  return true;
+}
+
+void WfaAligner::traceback(int penalty, int diagonal, std::string& operations) const
+{
+  // built backwards, then reversed in place
+  std::string& reversed = operations;
+  reversed.clear();
+  int offset = get(m_, penalty, diagonal);
+  reversed.append(query_.size() - (offset - diagonal), 'S');
+
+  enum { MATCH, INSERT, DELETE } state = MATCH;
+  for (;;) {
+    const int cell = penalty * width_ + diagonal - diagonalBegin_;
+    if (MATCH == state) {
+      const Source source = mSource_[cell];
+      int          from   = NONE;
+      switch (source) {
+      case START:
+        from = diagonal + (0 == penalty ? 0 : (penalty - unclipScore_) / similarity_.match_);
+        break;
+      case MISMATCH:
+        from = get(m_, penalty - mismatchPenalty_, diagonal) + 1;
+        break;
+      case MISMATCH_N:
+        from = get(m_, penalty - mismatchNPenalty_, diagonal) + 1;
+        break;
+      case INSERTION:
+        from = i_[cell];
+        break;
+      case DELETION:
+        from = d_[cell];
+        break;
+      default:
+        assert(false);
+      }
+      assert(NONE != from && from <= offset);
+      reversed.append(offset - from, 'M');
+      offset = from;
+      if (START == source) {
+        reversed.append(offset - diagonal, 'S');
+        reversed.append(offset, 'N');
+        break;
+      } else if (MISMATCH == source || MISMATCH_N == source) {
+        reversed.push_back('M');
+        --offset;
+        penalty -= (MISMATCH == source) ? mismatchPenalty_ : mismatchNPenalty_;
+      } else {
+        state = (INSERTION == source) ? INSERT : DELETE;
+      }
+    } else if (INSERT == state) {
+      reversed.push_back('I');
+      if (OPEN == iSource_[cell]) {
+        penalty -= insertionOpenPenalty_;
+        state = MATCH;
+      } else {
+        penalty -= insertionExtendPenalty_;
+      }
+      ++diagonal;
+    } else {
+      reversed.push_back('D');
+      --offset;
+      if (OPEN == dSource_[cell]) {
+        penalty -= deletionOpenPenalty_;
+        state = MATCH;
+      } else {
+        penalty -= deletionExtendPenalty_;
+      }
+      --diagonal;
+    }
+  }
+  std::reverse(operations.begin(), operations.end());
+}
+
+ScoreType WfaAligner::getScore(const std::string& operations) const
+{
+  ScoreType score          = 0;
+  int       queryOffset    = 0;
+  int       databaseOffset = 0;
+  char      last           = 0;
+  for (const char operation : operations) {
+    switch (operation) {
+    case 'N':
+      ++databaseOffset;
+      break;
+    case 'S':
+      ++queryOffset;
+      break;
+    case 'M':
+      score += similarity_(query_[queryOffset++], database_[databaseOffset++]);
+      break;
+    case 'I':
+      score -= (last == operation) ? gapExtend_ : gapInit_;
+      ++queryOffset;
+      break;
+    case 'D':
+      score -= (last == operation) ? gapExtend_ : gapInit_;
+      ++databaseOffset;
+      break;
+    default:
+      assert(false);
+    }
+    last = operation;
+  }
+
+  // same as VectorSmithWaterman::align, where the unclip bonus is taken off a score that can't be negative
+  return std::max(score, 0);
+}
+
+}  // namespace align
+}  // namespace dragenos
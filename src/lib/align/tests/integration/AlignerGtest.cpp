@@ -198,3 +198,81 @@ TEST(Aligner, isPerfectAlignment)
   ASSERT_TRUE(Aligner::isPerfectAlignment(q + 1, q + 3, d + 1, d + 3, alignment));
   ASSERT_EQ(alignment.getScore(), 2);
 }
+
+TEST(Aligner, minRelevantScoreSingleEnded)
+{
+  const dragenos::align::SimilarityScores similarityScores(1, -4);
+  const align::SinglePicker               picker(similarityScores, 19, 8, 0, 0, 0, false, 50);
+  const align::SinglePicker               secondaryPicker(similarityScores, 19, 8, 2, 30, 0, false, 50);
+  static const int                        readLength = 100;
+
+  Alignments alignments;
+  const auto append = [&alignments](int position, int clips, int length, align::ScoreType score) {
+    alignments.append(align::Alignment(0, score));
+    alignments.back().setPosition(position);
+    alignments.back().setCigarOperations(
+        std::string(clips, 'S') + std::string(length, 'M') + std::string(readLength - clips - length, 'S'));
+  };
+  append(1000, 0, 70, 65);
+  append(5000, 0, 70, 50);
+  append(9000, 0, 70, 40);
+
+  // nothing settled, everything matters
+  ASSERT_EQ(align::INVALID_SCORE, picker.getMinRelevantScore(readLength, alignments, {true, true, true}));
+  // anything not better than the second best can't change MAPQ or XS
+  ASSERT_EQ(51, picker.getMinRelevantScore(readLength, alignments, {false, false, true}));
+  // without second best, anything under alnMinScore is invisible
+  ASSERT_EQ(19, picker.getMinRelevantScore(readLength, alignments, {false, true, true}));
+  // potential secondaries must be aligned
+  ASSERT_EQ(35, secondaryPicker.getMinRelevantScore(readLength, alignments, {false, false, true}));
+
+  // a pending alignment that does not overlap the primary could become supplementary
+  alignments.pop_back();
+  append(9000, 70, 30, 20);
+  ASSERT_EQ(27, picker.getMinRelevantScore(readLength, alignments, {false, false, true}));
+  // and once there is a supplementary, its MAPQ and XS matter too
+  append(12000, 75, 25, 35);
+  ASSERT_EQ(19, picker.getMinRelevantScore(readLength, alignments, {false, false, true, false}));
+}
+
+TEST(Aligner, minRelevantScoreIncremental)
+{
+  const dragenos::align::SimilarityScores similarityScores(1, -4);
+  const align::SinglePicker               picker(similarityScores, 19, 8, 2, 30, 0, false, 50);
+  static const int                        readLength = 100;
+
+  Alignments alignments;
+  const auto append = [&alignments](int position, int clips, int length, align::ScoreType score) {
+    alignments.append(align::Alignment(0, score));
+    alignments.back().setPosition(position);
+    alignments.back().setCigarOperations(
+        std::string(clips, 'S') + std::string(length, 'M') + std::string(readLength - clips - length, 'S'));
+  };
+  // ties for the primary and the supplementary, alignments overlapping either or both
+  append(1000, 0, 70, 40);
+  append(2000, 70, 30, 28);
+  append(3000, 0, 70, 65);
+  append(4000, 40, 60, 50);
+  append(5000, 0, 70, 65);
+  append(6000, 75, 25, 25);
+  append(7000, 70, 30, 28);
+  append(8000, 0, 100, 45);
+
+  align::SinglePicker::SettledAlignments settled;
+  std::vector<bool>                      pending(alignments.size(), true);
+  settled.reset(alignments, pending);
+  ASSERT_EQ(align::INVALID_SCORE, picker.getMinRelevantScore(readLength, settled));
+  // same as from scratch whatever the order the alignments settle in
+  for (const std::size_t i : {6, 1, 4, 7, 0, 5, 2, 3}) {
+    pending[i] = false;
+    settled.settle(i);
+    ASSERT_EQ(
+        picker.getMinRelevantScore(readLength, alignments, pending),
+        picker.getMinRelevantScore(readLength, settled))
+        << "after settling " << i;
+  }
+  ASSERT_EQ(&alignments[2], settled.getBest());
+  ASSERT_EQ(&alignments[4], settled.getSecondBest());
+  ASSERT_EQ(&alignments[1], settled.getSupplementary());
+  ASSERT_FALSE(settled.hasPendingOutsideBest());
+}
@@ -0,0 +1,80 @@
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "align/AlignmentRescue.hpp"
+
+using namespace dragenos;
+typedef align::AlignmentRescue      AlignmentRescue;
+typedef align::InsertSizeParameters InsertSizeParameters;
+
+// straightforward scan with the same semantics as the bit-parallel scan: count the matching bits between the
+// kmer and the reference at each offset, with Ns on the reference never matching
+static void referenceScan(
+    const AlignmentRescue::RescueKmer& rescueKmer,
+    const std::vector<unsigned char>&  referenceBases,
+    const size_t                       start,
+    const int                          scanLength,
+    int&                               bestCount,
+    int&                               bestOffset,
+    bool&                              conflict)
+{
+  for (int i = 0; scanLength > i; ++i) {
+    int matchCount = 0;
+    for (size_t j = 0; rescueKmer.size() != j; ++j) {
+      const unsigned char referenceBase = referenceBases[start + i + j];
+      matchCount += __builtin_popcount(rescueKmer[j] & ((0xF == referenceBase) ? 0 : referenceBase));
+    }
+    const int mismatchCount = rescueKmer.size() - matchCount;
+    if (bestCount > mismatchCount or (bestCount == mismatchCount and i <= scanLength / 2)) {
+      conflict |= (bestCount <= 7);
+      bestCount  = mismatchCount;
+      bestOffset = i;
+    }
+  }
+}
+
+TEST(AlignmentRescue, scanKmer)
+{
+  const AlignmentRescue alignmentRescue(0, 500, InsertSizeParameters::Orientation::pe_orient_fr_c);
+  std::mt19937          generator(42);
+  const unsigned char   codes[] = {1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8, 0xF, 5, 0};
+  const auto            randomBase = [&]() { return codes[generator() % sizeof(codes)]; };
+  for (const size_t referenceLength : {40, 63, 64, 65, 200, 617, 1000}) {
+    std::vector<unsigned char> referenceBases(referenceLength);
+    for (auto& base : referenceBases) {
+      base = randomBase();
+    }
+    AlignmentRescue::BitPlanes bitPlanes;
+    alignmentRescue.getBitPlanes(referenceBases, bitPlanes);
+    for (unsigned trial = 0; 20 > trial; ++trial) {
+      AlignmentRescue::RescueKmer rescueKmer;
+      const size_t                start = generator() % 8;
+      if (trial % 2) {
+        // plant the kmer with a few mismatches to exercise the low counts and the conflicts
+        const size_t plant = start + generator() % (referenceLength - rescueKmer.size() - start + 1);
+        for (size_t j = 0; rescueKmer.size() != j; ++j) {
+          rescueKmer[j] = (0 == generator() % 8) ? randomBase() : referenceBases[plant + j];
+        }
+      } else {
+        for (auto& base : rescueKmer) {
+          base = randomBase();
+        }
+      }
+      const int scanLength = referenceLength - rescueKmer.size() - start;
+      int       expectedCount    = rescueKmer.size();
+      int       expectedOffset   = scanLength;
+      bool      expectedConflict = false;
+      referenceScan(
+          rescueKmer, referenceBases, start, scanLength, expectedCount, expectedOffset, expectedConflict);
+      int  bestCount  = rescueKmer.size();
+      int  bestOffset = scanLength;
+      bool conflict   = false;
+      alignmentRescue.scanKmer(rescueKmer, bitPlanes, start, scanLength, bestCount, bestOffset, conflict);
+      ASSERT_EQ(expectedCount, bestCount) << "length: " << referenceLength << " trial: " << trial;
+      ASSERT_EQ(expectedOffset, bestOffset) << "length: " << referenceLength << " trial: " << trial;
+      ASSERT_EQ(expectedConflict, conflict) << "length: " << referenceLength << " trial: " << trial;
+    }
+  }
+}
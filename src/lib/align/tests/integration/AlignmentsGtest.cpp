@@ -1240,3 +1240,39 @@ TEST(Alignments, fixForWrongSoftClipAtEnd)
   ASSERT_EQ(expected, result);
 }
 
+
+TEST(Alignments, reuse)
+{
+  using namespace dragenos;
+
+  align::Alignments alignments;
+  align::Alignment& first = alignments.addAlignment();
+  first.setFlags(align::Alignment::REVERSE_COMPLEMENT);
+  first.setScore(42);
+  first.setCigarOperations("SMMMMMMMMIMMMMDMMMMMMS");
+  const align::Cigar::Operation* const operations = first.getCigar().getOperations();
+  align::Alignment                     other(align::Alignment::UNMAPPED, 7);
+  alignments.append(other);
+  ASSERT_EQ(2u, alignments.size());
+  ASSERT_EQ(7, alignments.back().getScore());
+
+  alignments.clear();
+  ASSERT_TRUE(alignments.empty());
+  ASSERT_EQ(alignments.begin(), alignments.end());
+
+  // same instance, back to the default state, keeping the storage of the cigar
+  align::Alignment& reused = alignments.addAlignment();
+  ASSERT_EQ(&first, &reused);
+  ASSERT_EQ(align::Alignment().getFlags(), reused.getFlags());
+  ASSERT_EQ(align::Alignment().getScore(), reused.getScore());
+  ASSERT_TRUE(reused.getCigar().empty());
+  ASSERT_EQ(nullptr, reused.getSa());
+  reused.setCigarOperations("MMMMMMMMMM");
+  ASSERT_EQ(operations, reused.getCigar().getOperations());
+
+  alignments.resize(3);
+  ASSERT_EQ(3u, alignments.size());
+  ASSERT_TRUE(alignments.at(1).getCigar().empty());
+  ASSERT_EQ(align::Alignment().getScore(), alignments.at(1).getScore());
+  ASSERT_THROW(alignments.at(3), std::out_of_range);
+}
@@ -0,0 +1,135 @@
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "align/InsertSizeDistribution.hpp"
+#include "common/Exceptions.hpp"
+
+using namespace dragenos;
+typedef align::InsertSizeDistribution InsertSizeDistribution;
+typedef align::InsertSizeParameters   InsertSizeParameters;
+
+static const std::size_t READ_LENGTH = 151;
+
+static InsertSizeDistribution* makeDistribution(
+    bool     samplingEnabled,
+    int      q25,
+    int      q50,
+    int      q75,
+    double   mean,
+    double   stddev,
+    uint32_t orientation  = 0,
+    double   rescueSigmas = 0.0,
+    uint32_t rescueMin    = 0,
+    uint32_t rescueMax    = 0)
+{
+  return new InsertSizeDistribution(
+      samplingEnabled,
+      q25,
+      q50,
+      q75,
+      mean,
+      stddev,
+      READ_LENGTH,
+      25000,   // peStatsIntervalSize
+      100000,  // peStatsSampleSize
+      10,      // peStatsIntervalMemory
+      5,       // peStatsIntervalDelay
+      false,   // peStatsContinuousUpdate
+      false,   // peStatsUpdateLogOnly
+      60,      // alignerMapqMax
+      orientation,
+      rescueSigmas,
+      3.0,  // alignerResqueCeilFactor
+      rescueMin,
+      rescueMax,
+      std::cerr);
+}
+
+TEST(InsertSizeDistribution, modelRoundTrip)
+{
+  std::unique_ptr<InsertSizeDistribution> fixed(makeDistribution(false, 350, 400, 450, 401.3, 61.7));
+  const InsertSizeParameters              expected = fixed->getInsertSizeParameters(READ_LENGTH);
+  ASSERT_TRUE(expected.isInitDone());
+  std::ostringstream model;
+  fixed->saveModel(model, "RG1");
+
+  // sampling, but no initialization phase: the parameters are available from the first read
+  std::unique_ptr<InsertSizeDistribution> sampled(makeDistribution(true, 0, 0, 0, 0.0, 0.0));
+  std::istringstream                      is(model.str());
+  sampled->loadModel(is, "RG1");
+  for (int i = 0; 1000 > i; ++i) {
+    ASSERT_EQ(expected, sampled->getInsertSizeParameters(READ_LENGTH)) << i;
+  }
+
+  std::ostringstream again;
+  sampled->saveModel(again, "RG1");
+  ASSERT_EQ(model.str(), again.str());
+
+  // and the other way around, without sampling
+  std::unique_ptr<InsertSizeDistribution> reloaded(makeDistribution(false, 0, 0, 0, 0.0, 0.0));
+  std::istringstream                      is2(model.str());
+  reloaded->loadModel(is2, "RG1");
+  ASSERT_EQ(expected, reloaded->getInsertSizeParameters(READ_LENGTH));
+}
+
+TEST(InsertSizeDistribution, modelRescueOverrides)
+{
+  std::unique_ptr<InsertSizeDistribution> fixed(makeDistribution(false, 350, 400, 450, 401.3, 61.7));
+  std::ostringstream                      model;
+  fixed->saveModel(model, "RG1");
+
+  // the rescue settings of the run win over the ones saved in the model
+  for (const bool samplingEnabled : {true, false}) {
+    {
+      std::unique_ptr<InsertSizeDistribution> overridden(
+          makeDistribution(false, 350, 400, 450, 401.3, 61.7, 0, 0.0, 250, 550));
+      std::unique_ptr<InsertSizeDistribution> loaded(
+          makeDistribution(samplingEnabled, 0, 0, 0, 0.0, 0.0, 0, 0.0, 250, 550));
+      std::istringstream is(model.str());
+      loaded->loadModel(is, "RG1");
+      const InsertSizeParameters parameters = loaded->getInsertSizeParameters(READ_LENGTH);
+      ASSERT_EQ(250, parameters.rescueMin_) << samplingEnabled;
+      ASSERT_EQ(550, parameters.rescueMax_) << samplingEnabled;
+      ASSERT_EQ(overridden->getInsertSizeParameters(READ_LENGTH), parameters) << samplingEnabled;
+    }
+    {
+      std::unique_ptr<InsertSizeDistribution> overridden(
+          makeDistribution(false, 350, 400, 450, 401.3, 61.7, 0, 1.5, 0, 0));
+      std::unique_ptr<InsertSizeDistribution> loaded(
+          makeDistribution(samplingEnabled, 0, 0, 0, 0.0, 0.0, 0, 1.5, 0, 0));
+      std::istringstream is(model.str());
+      loaded->loadModel(is, "RG1");
+      const InsertSizeParameters parameters = loaded->getInsertSizeParameters(READ_LENGTH);
+      ASSERT_NE(fixed->getInsertSizeParameters(READ_LENGTH), parameters) << samplingEnabled;
+      ASSERT_EQ(overridden->getInsertSizeParameters(READ_LENGTH), parameters) << samplingEnabled;
+    }
+  }
+}
+
+TEST(InsertSizeDistribution, modelMismatch)
+{
+  std::unique_ptr<InsertSizeDistribution> fixed(makeDistribution(false, 350, 400, 450, 401.3, 61.7));
+  std::ostringstream                      model;
+  fixed->saveModel(model, "RG1");
+
+  {
+    std::unique_ptr<InsertSizeDistribution> sampled(makeDistribution(true, 0, 0, 0, 0.0, 0.0));
+    std::istringstream                      is(model.str());
+    ASSERT_THROW(sampled->loadModel(is, "RG2"), common::InvalidParameterException);
+  }
+  {
+    std::unique_ptr<InsertSizeDistribution> sampled(makeDistribution(true, 0, 0, 0, 0.0, 0.0, 1));
+    std::istringstream                      is(model.str());
+    ASSERT_THROW(sampled->loadModel(is, "RG1"), common::InvalidParameterException);
+  }
+  {
+    std::unique_ptr<InsertSizeDistribution> sampled(makeDistribution(true, 0, 0, 0, 0.0, 0.0));
+    std::string                             truncated = model.str();
+    truncated.resize(truncated.size() - 10);
+    std::istringstream is(truncated);
+    ASSERT_THROW(sampled->loadModel(is, "RG1"), common::InvalidParameterException);
+  }
+}
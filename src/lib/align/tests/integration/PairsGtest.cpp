@@ -0,0 +1,88 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "align/Pairs.hpp"
+
+using namespace dragenos;
+typedef sequences::Read             Read;
+typedef sequences::ReadPair         ReadPair;
+typedef Read::Name                  Name;
+typedef Read::Bases                 Bases;
+typedef Read::Qualities             Qualities;
+typedef align::InsertSizeParameters InsertSizeParameters;
+typedef align::PairMatchFinder      PairMatchFinder;
+typedef map::SeedPosition           SeedPosition;
+typedef sequences::Seed             Seed;
+
+static void addRandomChains(std::mt19937& generator, const Read& read, map::ChainBuilder& chainBuilder)
+{
+  for (unsigned i = generator() % 60; 0 < i; --i) {
+    const bool     reverseComplement = generator() % 2;
+    const unsigned readPosition      = generator() % 50;
+    const int64_t  referencePosition = generator() % 3000;
+    chainBuilder.addSeedPosition(
+        SeedPosition(Seed(&read, readPosition, 17), referencePosition, 0), reverseComplement, false);
+    if (generator() % 2) {
+      // same diagonal, or close to it, to make longer chains
+      const unsigned offset = 1 + generator() % 30;
+      chainBuilder.addSeedPosition(
+          SeedPosition(
+              Seed(&read, readPosition + offset, 17),
+              referencePosition + (reverseComplement ? -1 : 1) * int(offset) + int(generator() % 3) - 1,
+              0),
+          reverseComplement,
+          false);
+    }
+  }
+}
+
+TEST(Pairs, pairMatchFinder)
+{
+  const std::string bases(100, 'A');
+  const std::string qualities(100, 'E');
+  const std::string name = "blah";
+  ReadPair          readPair;
+  for (unsigned i = 0; 2 > i; ++i) {
+    readPair[i].init(
+        Name(name.begin(), name.end()),
+        Bases(bases.begin(), bases.end()),
+        Qualities(qualities.begin(), qualities.end()),
+        17,
+        i);
+  }
+
+  std::mt19937 generator(42);
+  size_t       matchCount = 0;
+  for (const auto orientation :
+       {InsertSizeParameters::Orientation::pe_orient_fr_c,
+        InsertSizeParameters::Orientation::pe_orient_rf_c,
+        InsertSizeParameters::Orientation::pe_orient_ff_c,
+        InsertSizeParameters::Orientation::pe_orient_rr_c}) {
+    const InsertSizeParameters insertSizeParameters = {150, 600, 400, 150, 600, 50.0, orientation};
+    for (unsigned trial = 0; 50 > trial; ++trial) {
+      std::array<map::ChainBuilder, 2> chainBuilders{map::ChainBuilder(4.0), map::ChainBuilder(4.0)};
+      addRandomChains(generator, readPair[0], chainBuilders[0]);
+      addRandomChains(generator, readPair[1], chainBuilders[1]);
+
+      PairMatchFinder pairMatchFinder;
+      pairMatchFinder.reset(insertSizeParameters, readPair, chainBuilders[1]);
+      std::vector<unsigned> matches;
+      for (const auto& first : chainBuilders[0]) {
+        std::vector<unsigned> expected;
+        for (unsigned i1 = 0; chainBuilders[1].size() > i1; ++i1) {
+          if (pairMatch(insertSizeParameters, readPair, first, chainBuilders[1].at(i1))) {
+            expected.push_back(i1);
+          }
+        }
+        pairMatchFinder.find(first, matches);
+        ASSERT_EQ(expected, matches) << "orientation: " << int(orientation) << " trial: " << trial;
+        matchCount += matches.size();
+      }
+    }
+  }
+  // make sure that the windows were exercised
+  ASSERT_LT(1000u, matchCount);
+}
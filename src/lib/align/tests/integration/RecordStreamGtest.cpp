@@ -0,0 +1,56 @@
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "align/RecordEncoder.hpp"
+#include "align/RecordStream.hpp"
+
+using namespace dragenos;
+typedef sequences::Read     Read;
+typedef Read::Name          Name;
+typedef Read::Bases         Bases;
+typedef Read::Qualities     Qualities;
+typedef align::Alignment    Alignment;
+typedef align::RecordStream RecordStream;
+
+static char emptySpace[1024] = {};
+
+TEST(RecordStream, SamEncoding)
+{
+  const reference::HashtableConfig hashtableConfig(emptySpace, sizeof(emptySpace));
+  const align::Sam                 sam(hashtableConfig);
+  const std::string                rgid = "rg1";
+
+  Read reads[2];
+  reads[0].init(Name({'r', '0', ' ', 'x'}), Bases({1, 2, 4, 8, 0}), Qualities({2, 30, 31, 32, 33}), 1, 0);
+  reads[1].init(Name({'r', '1'}), Bases({8, 8, 1}), Qualities({10, 20, 30}), 1, 1);
+  Alignment alignments[2];
+  alignments[0].reset(Alignment::UNMAPPED);
+  alignments[1].reset(Alignment::UNMAPPED | Alignment::REVERSE_COMPLEMENT, 17);
+
+  RecordStream      records;
+  std::stringstream expected;
+  for (int i = 0; 2 > i; ++i) {
+    records.append(reads[i], alignments[i]);
+    sam.generateRecord(expected, reads[i], alignments[i], rgid) << "\n";
+  }
+
+  // the records keep everything the output, the metrics and the insert size statistics need
+  std::size_t             count = 0;
+  std::stringstream       encoded;
+  align::SamRecordEncoder encoder(sam, rgid);
+  records.forEach([&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) {
+    ASSERT_EQ(reads[count].getLength(), std::size_t(r.getReadLen()));
+    ASSERT_EQ(alignments[count].getFlags(), a.getFlags());
+    ASSERT_EQ(reads[count].getQualities()[1], r.getQualities()[1]);
+    encoder.encode(encoded, r, a);
+    ++count;
+  });
+  ASSERT_EQ(2u, count);
+  ASSERT_EQ(expected.str(), encoded.str());
+  ASSERT_EQ(std::string("r0\t4\t*\t0\t0\t*\t*\t0\t0\tACGTN\t#?@AB\tRG:Z:rg1\n"), encoded.str().substr(0, 40));
+
+  records.clear();
+  ASSERT_TRUE(records.empty());
+  records.forEach([&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) { FAIL(); });
+}
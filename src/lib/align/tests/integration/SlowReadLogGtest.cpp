@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "align/SlowReadLog.hpp"
+
+using namespace dragenos;
+typedef sequences::Read Read;
+typedef Read::Name      Name;
+typedef Read::Bases     Bases;
+typedef Read::Qualities Qualities;
+
+static void initRead(Read& read, const std::string& name, std::size_t length)
+{
+  read.init(Name(name.begin(), name.end()), Bases(length, 1), Qualities(length, 30), 0, 0);
+}
+
+TEST(SlowReadLog, Records)
+{
+  std::ostringstream           os;
+  align::SlowReadLog           log(os, 5000);
+  Read                         read;
+  Read                         mate;
+  align::SlowReadLog::Counters counters;
+  initRead(read, "satellite", 151);
+  initRead(mate, "satellite", 150);
+  ASSERT_FALSE(log.isSlow(4999));
+  ASSERT_TRUE(log.isSlow(5000));
+
+  counters.chains             = 1200;
+  counters.smithWatermanCalls = 35;
+  counters.rescues            = 7;
+  log.add(read, &mate, counters, 12345678);
+  log.add(read, nullptr, align::SlowReadLog::Counters(), 5000);
+  ASSERT_EQ(2u, log.getCount());
+  ASSERT_EQ(
+      "#name\tlength\tmate_length\tmicroseconds\tchains\tsmith_waterman\trescues\n"
+      "satellite\t151\t150\t12345\t1200\t35\t7\n"
+      "satellite\t151\t0\t5\t0\t0\t0\n",
+      os.str());
+}
+
+TEST(SlowReadLog, Threads)
+{
+  std::ostringstream       os;
+  align::SlowReadLog       log(os, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; 4 != t; ++t) {
+    threads.emplace_back([&log, t]() {
+      Read read;
+      initRead(read, "read" + std::to_string(t), 100);
+      for (int i = 0; 100 != i; ++i) {
+        log.add(read, nullptr, align::SlowReadLog::Counters(), 1000 * i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(400u, log.getCount());
+  // whole lines, one per read
+  std::istringstream is(os.str());
+  std::size_t        lines = 0;
+  for (std::string line; std::getline(is, line); ++lines) {
+    ASSERT_EQ(0u == lines ? '#' : 'r', line.front()) << line;
+    ASSERT_EQ(6, std::count(line.begin(), line.end(), '\t')) << line;
+  }
+  ASSERT_EQ(401u, lines);
+}
+
+TEST(SlowReadLog, Pending)
+{
+  std::ostringstream          os;
+  align::SlowReadLog          log(os, 0);
+  align::SlowReadLog::Pending pending;
+  Read                        read;
+  initRead(read, "speculative", 100);
+  const std::string header = os.str();
+
+  // dropped when the alignment gets redone
+  log.add(read, nullptr, align::SlowReadLog::Counters(), 2000, &pending);
+  pending.clear();
+  log.record(pending);
+  ASSERT_EQ(0u, log.getCount());
+  ASSERT_EQ(header, os.str());
+
+  // recorded when it is final
+  log.add(read, nullptr, align::SlowReadLog::Counters(), 3000, &pending);
+  log.add(read, nullptr, align::SlowReadLog::Counters(), 4000, &pending);
+  ASSERT_EQ(0u, log.getCount());
+  log.record(pending);
+  ASSERT_EQ(2u, log.getCount());
+  ASSERT_EQ(header + "speculative\t100\t0\t3\t0\t0\t0\nspeculative\t100\t0\t4\t0\t0\t0\n", os.str());
+  // and only once
+  log.record(pending);
+  ASSERT_EQ(2u, log.getCount());
+}
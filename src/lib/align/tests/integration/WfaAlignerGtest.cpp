@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "align/WfaAligner.hpp"
+
+using namespace dragenos;
+typedef align::WfaAligner       WfaAligner;
+typedef align::SimilarityScores SimilarityScores;
+typedef std::vector<unsigned char> Bases;
+
+static const int MATCH      = 1;
+static const int MISMATCH   = -4;
+static const int N_SCORE    = -1;
+static const int GAP_INIT   = 7;
+static const int GAP_EXTEND = 1;
+static const int UNCLIP     = 5;
+
+// the objective maximized by the wavefront alignment: the score with the unclip bonus on the ends that are
+// not clipped. Returns the score without the bonus in "score".
+static int getObjective(
+    const SimilarityScores& similarity,
+    const Bases&            query,
+    const Bases&            database,
+    const std::string&      operations,
+    int&                    score)
+{
+  size_t q    = 0;
+  size_t d    = 0;
+  char   last = 0;
+  score       = 0;
+  for (const char operation : operations) {
+    if ('N' == operation) {
+      ++d;
+    } else if ('S' == operation) {
+      ++q;
+    } else if ('M' == operation) {
+      score += similarity(query.at(q++), database.at(d++));
+    } else if ('I' == operation) {
+      score -= (last == operation) ? GAP_EXTEND : GAP_INIT;
+      ++q;
+    } else if ('D' == operation) {
+      score -= (last == operation) ? GAP_EXTEND : GAP_INIT;
+      ++d;
+    }
+    last = operation;
+  }
+  EXPECT_EQ(query.size(), q) << operations;
+  EXPECT_GE(database.size(), d) << operations;
+  return score + ('S' == operations[operations.find_first_not_of('N')] ? 0 : UNCLIP) +
+         ('S' == operations.back() ? 0 : UNCLIP);
+}
+
+// gotoh with the unclip bonus on the first and last query bases
+static int bruteForce(const SimilarityScores& similarity, const Bases& query, const Bases& database)
+{
+  static const int  NEG = std::numeric_limits<int>::min() / 4;
+  const size_t      n   = query.size();
+  const size_t      m   = database.size();
+  std::vector<std::vector<int>> matches(n + 1, std::vector<int>(m + 1, NEG));
+  std::vector<std::vector<int>> insertions(n + 1, std::vector<int>(m + 1, NEG));
+  std::vector<std::vector<int>> deletions(n + 1, std::vector<int>(m + 1, NEG));
+  int                           best = NEG;
+  for (size_t i = 1; n >= i; ++i) {
+    for (size_t j = 1; m >= j; ++j) {
+      const int previous = std::max(
+          {(1 == i) ? UNCLIP : 0, matches[i - 1][j - 1], insertions[i - 1][j - 1], deletions[i - 1][j - 1]});
+      matches[i][j] = similarity(query[i - 1], database[j - 1]) + previous;
+      insertions[i][j] =
+          std::max(matches[i - 1][j] - GAP_INIT, insertions[i - 1][j] - GAP_EXTEND);
+      deletions[i][j] = std::max(matches[i][j - 1] - GAP_INIT, deletions[i][j - 1] - GAP_EXTEND);
+      best            = std::max(best, matches[i][j] + ((n == i) ? UNCLIP : 0));
+    }
+  }
+  return best;
+}
+
+TEST(WfaAligner, bruteForce)
+{
+  const SimilarityScores similarity(MATCH, MISMATCH, N_SCORE);
+  WfaAligner             wfaAligner(similarity, GAP_INIT, GAP_EXTEND, UNCLIP, 1000);
+  std::mt19937           generator(42);
+  const unsigned char    codes[]    = {1, 2, 4, 8, 1, 2, 4, 8, 1, 2, 4, 8, 0xF};
+  const auto             randomBase = [&]() { return codes[generator() % sizeof(codes)]; };
+  for (unsigned trial = 0; 500 > trial; ++trial) {
+    Bases query(1 + generator() % 40);
+    for (auto& base : query) {
+      base = randomBase();
+    }
+    // plant the query with some edits between random flanks
+    Bases database(generator() % 10);
+    for (auto& base : database) {
+      base = randomBase();
+    }
+    for (const auto base : query) {
+      const unsigned edit = generator() % 16;
+      if (0 == edit) {
+        database.push_back(randomBase());
+      } else if (1 == edit) {
+        database.push_back(randomBase());
+        database.push_back(base);
+      } else if (2 != edit) {
+        database.push_back(base);
+      }
+    }
+    for (unsigned i = generator() % 10; 0 < i; --i) {
+      database.push_back(randomBase());
+    }
+    if (database.empty()) {
+      continue;
+    }
+    const bool  reverse = trial % 2;
+    const Bases forward = reverse ? Bases(query.rbegin(), query.rend()) : query;
+
+    std::string operations;
+    int         score = 0;
+    ASSERT_TRUE(wfaAligner.align(
+        forward.data(),
+        forward.data() + forward.size(),
+        database.data(),
+        database.data() + database.size(),
+        reverse,
+        -int(query.size()),
+        database.size() + 1,
+        operations,
+        score))
+        << "trial: " << trial;
+    int       aligned   = 0;
+    const int objective = getObjective(similarity, query, database, operations, aligned);
+    ASSERT_EQ(bruteForce(similarity, query, database), objective)
+        << "trial: " << trial << " operations: " << operations;
+    ASSERT_EQ(std::max(aligned, 0), score) << "trial: " << trial << " operations: " << operations;
+  }
+}
+
+TEST(WfaAligner, maxEdits)
+{
+  const SimilarityScores similarity(MATCH, MISMATCH, N_SCORE);
+  std::mt19937           generator(7);
+  // 100 bases read at offset 49 of the database with a mismatch every 20 bases
+  Bases database(200);
+  for (auto& base : database) {
+    base = 1 << (generator() % 4);
+  }
+  Bases query(database.begin() + 49, database.begin() + 149);
+  for (size_t i = 10; query.size() > i; i += 20) {
+    query[i] = (8 == query[i]) ? 1 : query[i] << 1;
+  }
+  std::string operations;
+  int         score = 0;
+
+  WfaAligner wfaAligner(similarity, GAP_INIT, GAP_EXTEND, UNCLIP, 8);
+  ASSERT_TRUE(wfaAligner.align(
+      query.data(),
+      query.data() + query.size(),
+      database.data(),
+      database.data() + database.size(),
+      false,
+      1,
+      98,
+      operations,
+      score));
+  ASSERT_EQ(std::string(49, 'N') + std::string(100, 'M'), operations);
+  ASSERT_EQ(95 * MATCH + 5 * MISMATCH, score);
+
+  // not within 2 mismatches: left to Smith-Waterman
+  WfaAligner strictAligner(similarity, GAP_INIT, GAP_EXTEND, UNCLIP, 2);
+  ASSERT_FALSE(strictAligner.align(
+      query.data(),
+      query.data() + query.size(),
+      database.data(),
+      database.data() + database.size(),
+      false,
+      1,
+      98,
+      operations,
+      score));
+
+  // 3 bases deleted from the read
+  query.assign(database.begin() + 49, database.begin() + 149);
+  query.erase(query.begin() + 50, query.begin() + 53);
+  ASSERT_TRUE(wfaAligner.align(
+      query.data(),
+      query.data() + query.size(),
+      database.data(),
+      database.data() + database.size(),
+      false,
+      1,
+      98,
+      operations,
+      score));
+  ASSERT_EQ(97 * MATCH - GAP_INIT - 2 * GAP_EXTEND, score);
+  ASSERT_EQ(3, std::count(operations.begin(), operations.end(), 'D')) << operations;
+}
+
+TEST(WfaAligner, unsupportedScores)
+{
+  ASSERT_THROW(WfaAligner(SimilarityScores(MATCH, MISMATCH, N_SCORE), 0, 0, UNCLIP, 8), std::exception);
+  ASSERT_THROW(WfaAligner(SimilarityScores(MATCH, MATCH, N_SCORE), GAP_INIT, GAP_EXTEND, UNCLIP, 8), std::exception);
+}
@@ -0,0 +1,154 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "common/AsyncWriter.hpp"
+#include "common/CpuTopology.hpp"
+#include "common/Exceptions.hpp"
+#include "common/Profiler.hpp"
+#include "common/Tracer.hpp"
+
+namespace dragenos {
+namespace common {
+
+AsyncWriter::AsyncWriter(std::ostream& os, std::size_t maxQueueBytes)
+  : os_(os), maxQueueBytes_(maxQueueBytes), thread_(&AsyncWriter::run, this)
+{
+}
+
+AsyncWriter::~AsyncWriter()
+{
+  if (thread_.joinable()) {
+    try {
+      close();
+    } catch (...) {
+      // destruction during the unwinding of another error
+    }
+  }
+}
+
+void AsyncWriter::write(std::vector<char>& buffer)
+{
+  if (buffer.empty()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  // the buffer being written counts until its write completes. An oversized buffer still goes
+  // through, alone once the writer is idle
+  if (!error_ && 0 != queuedBytes_ && maxQueueBytes_ < queuedBytes_ + buffer.size()) {
+    const auto stallStart = std::chrono::steady_clock::now();
+    while (!error_ && 0 != queuedBytes_ && maxQueueBytes_ < queuedBytes_ + buffer.size()) {
+      notFull_.wait(lock);
+    }
+    ++stats_.stalls;
+    stats_.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stallStart).count();
+  }
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  queuedBytes_ += buffer.size();
+  stats_.peakQueueBytes = std::max(stats_.peakQueueBytes, queuedBytes_.load());
+  queue_.push_back(std::vector<char>());
+  queue_.back().swap(buffer);
+  if (!free_.empty()) {
+    buffer.swap(free_.back());
+    free_.pop_back();
+  }
+  notEmpty_.notify_one();
+}
+
+void AsyncWriter::run()
+{
+  const ProfileThread          profileThread("writer");
+  const TraceThread            traceThread("writer");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    while (queue_.empty() && !closing_) {
+      notEmpty_.wait(lock);
+    }
+    if (queue_.empty()) {
+      break;
+    }
+    std::vector<char> buffer;
+    buffer.swap(queue_.front());
+    queue_.pop_front();
+    const bool failed = bool(error_);
+    lock.unlock();
+
+    // after a failure, keep draining the queue so that the workers don't wait forever
+    const auto writeStart = std::chrono::steady_clock::now();
+    bool       ok         = failed;
+    if (!failed) {
+      const StageTimer timer(Stage::WRITE);
+      const TraceScope trace(TraceSpan::WRITE);
+      ok = bool(os_.write(buffer.data(), buffer.size()));
+    }
+    const int  error     = errno;
+    const auto writeTime = std::chrono::steady_clock::now() - writeStart;
+
+    lock.lock();
+    if (!ok) {
+      error_ = std::make_exception_ptr(
+          IoException(error, std::string("Error writing output stream. Error: ") + strerror(error)));
+    }
+    stats_.bytes += buffer.size();
+    ++stats_.writes;
+    stats_.writeSeconds += std::chrono::duration<double>(writeTime).count();
+    queuedBytes_ -= buffer.size();
+    if (MAX_FREE_BUFFERS > free_.size()) {
+      buffer.clear();
+      free_.push_back(std::move(buffer));
+    }
+    notFull_.notify_all();
+  }
+}
+
+void AsyncWriter::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+    notEmpty_.notify_one();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (!error_ && !os_.flush()) {
+    error_ = std::make_exception_ptr(
+        IoException(errno, std::string("Error flushing output stream. Error: ") + strerror(errno)));
+  }
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void AsyncWriter::setCpus(const std::vector<int>& cpus)
+{
+  setThreadCpus(thread_.native_handle(), cpus);
+}
+
+std::ostream& operator<<(std::ostream& os, const AsyncWriter& writer)
+{
+  const AsyncWriter::Stats& stats = writer.stats_;
+  return os << stats.bytes << " bytes in " << stats.writes << " writes, " << stats.writeSeconds
+            << " seconds writing, workers stalled " << stats.stalls << " times for " << stats.stallSeconds
+            << " seconds on the full queue, peak queue " << stats.peakQueueBytes << " bytes";
+}
+
+}  // namespace common
+}  // namespace dragenos
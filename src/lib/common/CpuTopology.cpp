@@ -0,0 +1,194 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <set>
+#include <tuple>
+
+#include <boost/algorithm/string.hpp>
+
+#include "common/CpuTopology.hpp"
+#include "common/Exceptions.hpp"
+
+namespace dragenos {
+namespace common {
+
+static int readTopologyValue(const std::string& path, const int defaultValue)
+{
+  std::ifstream is(path);
+  int           value = defaultValue;
+  if (!(is >> value)) {
+    return defaultValue;
+  }
+  return value;
+}
+
+CpuTopology::CpuTopology(const std::vector<int>& cpus, const std::string& sysCpuDir)
+{
+  for (const int cpu : cpus) {
+    const std::string topology = sysCpuDir + "/cpu" + std::to_string(cpu) + "/topology/";
+    // without topology information, the cpu is a core of its own on package 0
+    const int package = readTopologyValue(topology + "physical_package_id", 0);
+    const int core    = readTopologyValue(topology + "core_id", -1 - cpu);
+    cpus_.push_back(LogicalCpu{cpu, package, core});
+  }
+  std::sort(cpus_.begin(), cpus_.end(), [](const LogicalCpu& left, const LogicalCpu& right) {
+    return std::tie(left.package, left.core, left.cpu) < std::tie(right.package, right.core, right.cpu);
+  });
+  cpus_.erase(
+      std::unique(
+          cpus_.begin(),
+          cpus_.end(),
+          [](const LogicalCpu& left, const LogicalCpu& right) { return left.cpu == right.cpu; }),
+      cpus_.end());
+}
+
+std::size_t CpuTopology::getCoreCount() const
+{
+  std::set<std::pair<int, int>> cores;
+  for (const LogicalCpu& c : cpus_) {
+    cores.insert(std::make_pair(c.package, c.core));
+  }
+  return cores.size();
+}
+
+std::vector<LogicalCpu> CpuTopology::getPlacement(bool spread) const
+{
+  if (!spread) {
+    return cpus_;
+  }
+  // round robin over the cores: the n-th sibling of each core in turn. The packages
+  // alternate as well to spread the memory bandwidth
+  std::vector<std::vector<LogicalCpu>> cores;
+  for (const LogicalCpu& c : cpus_) {
+    if (cores.empty() || cores.back().front().package != c.package || cores.back().front().core != c.core) {
+      cores.push_back(std::vector<LogicalCpu>());
+    }
+    cores.back().push_back(c);
+  }
+  std::stable_sort(
+      cores.begin(), cores.end(), [](const std::vector<LogicalCpu>& left, const std::vector<LogicalCpu>& right) {
+        return left.front().core < right.front().core;
+      });
+  std::vector<LogicalCpu> ret;
+  for (std::size_t sibling = 0; cpus_.size() != ret.size(); ++sibling) {
+    for (const std::vector<LogicalCpu>& core : cores) {
+      if (core.size() > sibling) {
+        ret.push_back(core[sibling]);
+      }
+    }
+  }
+  return ret;
+}
+
+std::vector<int> parseCpuList(const std::string& list)
+{
+  std::vector<std::string> ranges;
+  boost::split(ranges, list, boost::is_any_of(","));
+  std::vector<int> ret;
+  for (const std::string& range : ranges) {
+    std::vector<std::string> bounds;
+    boost::split(bounds, range, boost::is_any_of("-"));
+    try {
+      std::size_t end   = 0;
+      const int   first = std::stoi(bounds.front(), &end);
+      if (bounds.front().size() != end || 2 < bounds.size() || 0 > first) {
+        BOOST_THROW_EXCEPTION(InvalidParameterException("invalid cpu range: " + range));
+      }
+      const int last = 1 == bounds.size() ? first : std::stoi(bounds.back(), &end);
+      if (bounds.back().size() != end || last < first) {
+        BOOST_THROW_EXCEPTION(InvalidParameterException("invalid cpu range: " + range));
+      }
+      for (int cpu = first; last >= cpu; ++cpu) {
+        ret.push_back(cpu);
+      }
+    } catch (std::logic_error&) {
+      // invalid_argument and out_of_range from stoi
+      BOOST_THROW_EXCEPTION(InvalidParameterException("invalid cpu range: " + range));
+    }
+  }
+  std::sort(ret.begin(), ret.end());
+  ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+  return ret;
+}
+
+std::vector<int> getAllowedCpus()
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set)) {
+    BOOST_THROW_EXCEPTION(IoException(errno, "failed to get the cpu affinity"));
+  }
+  std::vector<int> ret;
+  for (int cpu = 0; CPU_SETSIZE > cpu; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      ret.push_back(cpu);
+    }
+  }
+  return ret;
+}
+
+void setAllowedCpus(const std::vector<int>& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    if (CPU_SETSIZE <= cpu) {
+      BOOST_THROW_EXCEPTION(InvalidParameterException("cpu out of range: " + std::to_string(cpu)));
+    }
+    CPU_SET(cpu, &set);
+  }
+  if (sched_setaffinity(0, sizeof(set), &set)) {
+    BOOST_THROW_EXCEPTION(IoException(errno, "failed to set the cpu affinity"));
+  }
+}
+
+std::vector<int> getThreadCpus(pthread_t thread)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  const int error = pthread_getaffinity_np(thread, sizeof(set), &set);
+  if (error) {
+    BOOST_THROW_EXCEPTION(IoException(error, "failed to get the cpu affinity of a thread"));
+  }
+  std::vector<int> ret;
+  for (int cpu = 0; CPU_SETSIZE > cpu; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      ret.push_back(cpu);
+    }
+  }
+  return ret;
+}
+
+void setThreadCpus(pthread_t thread, const std::vector<int>& cpus)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    if (CPU_SETSIZE <= cpu) {
+      BOOST_THROW_EXCEPTION(InvalidParameterException("cpu out of range: " + std::to_string(cpu)));
+    }
+    CPU_SET(cpu, &set);
+  }
+  const int error = pthread_setaffinity_np(thread, sizeof(set), &set);
+  if (error) {
+    BOOST_THROW_EXCEPTION(IoException(error, "failed to set the cpu affinity of a thread"));
+  }
+}
+
+}  // namespace common
+}  // namespace dragenos
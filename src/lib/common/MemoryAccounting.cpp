@@ -0,0 +1,192 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "common/MemoryAccounting.hpp"
+
+namespace dragenos {
+namespace common {
+
+namespace {
+
+const char* const COMPONENT_NAMES[] = {
+    "hash_table", "extend_table", "reference", "workers", "blocks_in_flight", "output_queue"};
+static_assert(
+    sizeof(COMPONENT_NAMES) / sizeof(COMPONENT_NAMES[0]) == static_cast<std::size_t>(MemoryComponent::COUNT),
+    "component names");
+
+std::string formatMegabytes(const uint64_t bytes)
+{
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(1) << bytes / 1024.0 / 1024.0 << " MB";
+  return os.str();
+}
+
+}  // namespace
+
+const char* getMemoryComponentName(const MemoryComponent component)
+{
+  return COMPONENT_NAMES[static_cast<std::size_t>(component)];
+}
+
+MemoryAccounting::MemoryAccounting(const uint64_t limit) : limit_(limit), peakTotal_(0)
+{
+  for (std::size_t i = 0; bytes_.size() != i; ++i) {
+    bytes_[i].store(0);
+    peaks_[i].store(0);
+  }
+}
+
+void MemoryAccounting::addRegion(const MemoryComponent component, const void* data, const uint64_t bytes)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    regions_.push_back(Region{component, data, bytes});
+  }
+  add(component, bytes);
+}
+
+void MemoryAccounting::add(const MemoryComponent component, const int64_t bytes)
+{
+  const std::size_t i = static_cast<std::size_t>(component);
+  updatePeaks(i, bytes_[i].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryAccounting::set(const MemoryComponent component, const uint64_t bytes)
+{
+  const std::size_t i = static_cast<std::size_t>(component);
+  bytes_[i].store(bytes, std::memory_order_relaxed);
+  updatePeaks(i, bytes);
+}
+
+void MemoryAccounting::updatePeaks(const std::size_t component, const uint64_t bytes)
+{
+  uint64_t peak = peaks_[component].load(std::memory_order_relaxed);
+  while (peak < bytes && !peaks_[component].compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+  }
+  const uint64_t total = getTotal();
+  peak                 = peakTotal_.load(std::memory_order_relaxed);
+  while (peak < total && !peakTotal_.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t MemoryAccounting::getTotal() const
+{
+  uint64_t ret = 0;
+  for (const auto& bytes : bytes_) {
+    ret += bytes.load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+uint64_t MemoryAccounting::getResident(const MemoryComponent component) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t                    ret = 0;
+  for (const Region& region : regions_) {
+    if (component == region.component) {
+      ret += getResidentBytes(region.data, region.bytes);
+    }
+  }
+  return ret;
+}
+
+uint64_t MemoryAccounting::getBlocksBudget() const
+{
+  if (!limit_) {
+    return 0;
+  }
+  const uint64_t rest = getTotal() - get(MemoryComponent::BLOCKS_IN_FLIGHT) - get(MemoryComponent::OUTPUT_QUEUE);
+  // still a limit when the rest exceeds it
+  return std::max<uint64_t>(limit_ - std::min(limit_, rest), 1);
+}
+
+uint64_t MemoryAccounting::getResidentBytes(const void* data, const uint64_t bytes)
+{
+  if (!data || !bytes) {
+    return 0;
+  }
+  const uintptr_t            pageSize = sysconf(_SC_PAGESIZE);
+  const uintptr_t            begin    = reinterpret_cast<uintptr_t>(data) / pageSize * pageSize;
+  const uintptr_t            end      = reinterpret_cast<uintptr_t>(data) + bytes;
+  std::vector<unsigned char> pages((end - begin + pageSize - 1) / pageSize);
+  if (mincore(reinterpret_cast<void*>(begin), end - begin, pages.data())) {
+    return 0;
+  }
+  const uint64_t resident = std::count_if(pages.begin(), pages.end(), [](unsigned char p) { return p & 1; });
+  return std::min(bytes, resident * pageSize);
+}
+
+MemoryAccounting::ProcessMemory MemoryAccounting::getProcessMemory()
+{
+  ProcessMemory ret;
+  // size and resident pages
+  std::ifstream statm("/proc/self/statm");
+  uint64_t      size = 0, resident = 0;
+  if (statm >> size >> resident) {
+    ret.rss = resident * sysconf(_SC_PAGESIZE);
+  }
+  struct rusage usage;
+  if (!getrusage(RUSAGE_SELF, &usage)) {
+    // kilobytes on linux
+    ret.peakRss = std::max<uint64_t>(ret.rss, usage.ru_maxrss * 1024ul);
+  }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  const struct mallinfo2 info = mallinfo2();
+#else
+  // wraps around beyond 4GB
+  const struct mallinfo info = mallinfo();
+#endif
+  ret.heapInUse  = info.uordblks;
+  ret.heapFree   = info.fordblks;
+  ret.heapMapped = info.hblkhd;
+  return ret;
+}
+
+void MemoryAccounting::report(std::ostream& os) const
+{
+  const ProcessMemory process = getProcessMemory();
+  std::ostringstream  lines;
+  lines << "Memory: " << formatMegabytes(getTotal()) << " accounted (peak " << formatMegabytes(getPeakTotal());
+  if (limit_) {
+    lines << ", limit " << formatMegabytes(limit_);
+  }
+  lines << "), RSS " << formatMegabytes(process.rss) << " (peak " << formatMegabytes(process.peakRss) << ")\n";
+  for (std::size_t i = 0; bytes_.size() != i; ++i) {
+    const MemoryComponent component = static_cast<MemoryComponent>(i);
+    lines << "Memory " << getMemoryComponentName(component) << ": " << formatMegabytes(get(component));
+    if (MemoryComponent::WORKERS > component) {
+      lines << " mapped, " << formatMegabytes(getResident(component)) << " resident";
+    } else {
+      lines << " (peak " << formatMegabytes(getPeak(component)) << ")";
+    }
+    lines << "\n";
+  }
+  lines << "Memory heap: " << formatMegabytes(process.heapInUse) << " in use, "
+        << formatMegabytes(process.heapFree) << " free, " << formatMegabytes(process.heapMapped)
+        << " mapped directly\n";
+  os << lines.str() << std::flush;
+}
+
+}  // namespace common
+}  // namespace dragenos
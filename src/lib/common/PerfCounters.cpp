@@ -0,0 +1,120 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <boost/throw_exception.hpp>
+
+#include "common/Exceptions.hpp"
+#include "common/PerfCounters.hpp"
+
+namespace dragenos {
+namespace common {
+
+namespace {
+
+uint64_t cacheMiss(const uint64_t cache)
+{
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+int openEvent(const PerfCounters::Event& event, const int groupFd)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size           = sizeof(attr);
+  attr.type           = event.type;
+  attr.config         = event.config;
+  attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  // the calling thread, on any cpu
+  return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC);
+}
+
+}  // namespace
+
+const std::size_t PerfCounters::MAX_EVENTS;
+
+const std::vector<PerfCounters::Event>& PerfCounters::getHardwareEvents()
+{
+  static const std::vector<Event> events = {
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"llc_misses", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+      {"dtlb_misses", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+      {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+  return events;
+}
+
+PerfCounters::PerfCounters(const std::vector<Event>& events) : opened_(0), errno_(0)
+{
+  if (events.empty() || MAX_EVENTS < events.size()) {
+    BOOST_THROW_EXCEPTION(InvalidParameterException(
+        "PerfCounters: between 1 and " + std::to_string(MAX_EVENTS) + " events expected, got " +
+        std::to_string(events.size())));
+  }
+  fds_.fill(-1);
+  slots_.fill(0);
+  for (std::size_t i = 0; events.size() != i; ++i) {
+    fds_[i] = openEvent(events[i], i ? fds_[0] : -1);
+    if (-1 != fds_[i]) {
+      slots_[i] = opened_++;
+    } else if (!i) {
+      errno_ = errno;
+      error_ = "perf_event_open " + events[i].name + ": " + strerror(errno_);
+      return;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  // the members before the leader
+  for (std::size_t i = MAX_EVENTS; 0 != i; --i) {
+    if (-1 != fds_[i - 1]) {
+      close(fds_[i - 1]);
+    }
+  }
+}
+
+PerfCounters::Values PerfCounters::read() const
+{
+  Values values = {};
+  if (!isValid()) {
+    return values;
+  }
+  // nr, time_enabled, time_running, then the value of each member of the group
+  uint64_t      buffer[3 + MAX_EVENTS];
+  const ssize_t bytes = ::read(fds_[0], buffer, sizeof(buffer));
+  if (bytes < ssize_t((3 + opened_) * sizeof(uint64_t)) || !buffer[2]) {
+    // never scheduled yet
+    return values;
+  }
+  const double scale = double(buffer[1]) / buffer[2];
+  for (std::size_t i = 0; MAX_EVENTS != i; ++i) {
+    if (isOpen(i)) {
+      values[i] = buffer[3 + slots_[i]] * scale;
+    }
+  }
+  return values;
+}
+
+}  // namespace common
+}  // namespace dragenos
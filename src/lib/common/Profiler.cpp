@@ -0,0 +1,246 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <cassert>
+#include <cstdio>
+
+#include "common/Profiler.hpp"
+
+namespace dragenos {
+namespace common {
+
+/// the text as the content of a json string: quotes, backslashes and control characters escaped
+static std::string escapeJson(const std::string& text)
+{
+  std::string ret;
+  ret.reserve(text.size());
+  for (const char c : text) {
+    if ('"' == c || '\\' == c) {
+      ret.push_back('\\');
+      ret.push_back(c);
+    } else if (0x20 > static_cast<unsigned char>(c)) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+      ret += escaped;
+    } else {
+      ret.push_back(c);
+    }
+  }
+  return ret;
+}
+
+const char* getStageName(const Stage stage)
+{
+  static const char* const NAMES[] = {"idle",
+                                      "read",
+                                      "tokenize",
+                                      "map",
+                                      "ungapped",
+                                      "smith_waterman",
+                                      "rescue",
+                                      "pairing",
+                                      "insert_sizes",
+                                      "encode",
+                                      "store",
+                                      "write"};
+  static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<std::size_t>(Stage::COUNT), "stage names");
+  return NAMES[static_cast<std::size_t>(stage)];
+}
+
+const unsigned LatencyHistogram::SUB_BITS;
+const unsigned LatencyHistogram::BUCKET_COUNT;
+
+void LatencyHistogram::add(const LatencyHistogram& that)
+{
+  for (unsigned i = 0; BUCKET_COUNT != i; ++i) {
+    counts_[i] += that.counts_[i];
+  }
+  count_ += that.count_;
+  max_ = std::max(max_, that.max_);
+}
+
+uint64_t LatencyHistogram::getBucketLowerBound(const unsigned bucket)
+{
+  if (bucket < (1u << SUB_BITS)) {
+    return bucket;
+  }
+  const unsigned log2 = (bucket >> SUB_BITS) + SUB_BITS - 1;
+  return (uint64_t((1u << SUB_BITS) | (bucket & ((1u << SUB_BITS) - 1)))) << (log2 - SUB_BITS);
+}
+
+uint64_t LatencyHistogram::getQuantile(const double q) const
+{
+  if (!count_) {
+    return 0;
+  }
+  // rank of the quantile, 1-based
+  const uint64_t rank  = std::max<uint64_t>(1, uint64_t(q * count_ + 0.5));
+  uint64_t       total = 0;
+  for (unsigned i = 0; BUCKET_COUNT != i; ++i) {
+    total += counts_[i];
+    if (total >= rank) {
+      return getBucketLowerBound(i);
+    }
+  }
+  return max_;
+}
+
+void ThreadProfile::openCounters(const std::vector<PerfCounters::Event>& events)
+{
+  perf.reset(new PerfCounters(events));
+  if (!perf->isValid()) {
+    perf.reset();
+    return;
+  }
+  counted    = true;
+  lastCounts = perf->read();
+}
+
+void ThreadProfile::chargeCounters()
+{
+  const PerfCounters::Values now    = perf->read();
+  PerfCounters::Values&      charge = counts[static_cast<std::size_t>(current)];
+  for (std::size_t i = 0; now.size() != i; ++i) {
+    // the scaling of multiplexed counters can step back a little
+    charge[i] += std::max(now[i], lastCounts[i]) - lastCounts[i];
+  }
+  lastCounts = now;
+}
+
+thread_local ThreadProfile* Profiler::threadProfile_ = nullptr;
+
+Profiler& Profiler::instance()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::enable(const std::vector<PerfCounters::Event>& counters)
+{
+  counters_.clear();
+  countersError_.clear();
+  if (!counters.empty()) {
+    const PerfCounters probe(counters);
+    if (probe.isValid()) {
+      counters_ = counters;
+    } else {
+      countersError_ = probe.getError();
+    }
+  }
+  startCycles_ = readCycles();
+  startTime_   = std::chrono::steady_clock::now();
+  enabled_     = true;
+}
+
+void Profiler::attach(const std::string& name)
+{
+  assert(!threadProfile_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  threads_.push_back(std::unique_ptr<ThreadProfile>(new ThreadProfile(name, readCycles())));
+  threadProfile_ = threads_.back().get();
+  if (!counters_.empty()) {
+    threadProfile_->openCounters(counters_);
+  }
+}
+
+void Profiler::detach()
+{
+  threadProfile_->enter(Stage::IDLE);
+  threadProfile_->perf.reset();
+  threadProfile_ = nullptr;
+}
+
+void Profiler::report(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const double wallSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+  const double cyclesPerSecond = 0.0 < wallSeconds ? (readCycles() - startCycles_) / wallSeconds : 1.0;
+
+  ThreadProfile::Cycles stages = {};
+  ThreadProfile::Counts counts = {};
+  LatencyHistogram      reads;
+  std::size_t           countedThreads = 0;
+  for (const auto& thread : threads_) {
+    for (std::size_t stage = 0; stages.size() != stage; ++stage) {
+      stages[stage] += thread->cycles[stage];
+      for (std::size_t i = 0; counters_.size() != i; ++i) {
+        counts[stage][i] += thread->counts[stage][i];
+      }
+    }
+    reads.add(thread->reads);
+    countedThreads += thread->counted;
+  }
+
+  os << "{\n  \"wall_seconds\": " << wallSeconds << ",\n  \"cycles_per_second\": " << cyclesPerSecond
+     << ",\n  \"stage_seconds\": {";
+  for (std::size_t stage = 0; stages.size() != stage; ++stage) {
+    os << (stage ? ",\n" : "\n") << "    \"" << getStageName(static_cast<Stage>(stage))
+       << "\": " << stages[stage] / cyclesPerSecond;
+  }
+  os << "\n  },\n  \"threads\": [";
+  for (std::size_t i = 0; threads_.size() != i; ++i) {
+    const ThreadProfile& thread  = *threads_[i];
+    const double         seconds = (thread.last - thread.started) / cyclesPerSecond;
+    const double busy = seconds - thread.cycles[static_cast<std::size_t>(Stage::IDLE)] / cyclesPerSecond;
+    os << (i ? ",\n" : "\n") << "    {\"name\": \"" << escapeJson(thread.name) << "\", \"seconds\": " << seconds
+       << ", \"busy_seconds\": " << busy << ", \"utilization\": " << (0.0 < seconds ? busy / seconds : 0.0)
+       << ", \"reads\": " << thread.reads.getCount() << "}";
+  }
+  const double microseconds = cyclesPerSecond / 1000000;
+  os << "\n  ],\n  \"reads\": {\"count\": " << reads.getCount()
+     << ", \"p50_us\": " << reads.getQuantile(0.5) / microseconds
+     << ", \"p90_us\": " << reads.getQuantile(0.9) / microseconds
+     << ", \"p99_us\": " << reads.getQuantile(0.99) / microseconds
+     << ", \"p999_us\": " << reads.getQuantile(0.999) / microseconds
+     << ", \"max_us\": " << reads.getMax() / microseconds << "}";
+  if (!counters_.empty()) {
+    reportCounters(os, counts, countedThreads);
+  } else if (!countersError_.empty()) {
+    os << ",\n  \"counters_error\": \"" << escapeJson(countersError_) << "\"";
+  }
+  os << "\n}\n";
+}
+
+void Profiler::reportCounters(
+    std::ostream& os, const ThreadProfile::Counts& counts, const std::size_t countedThreads) const
+{
+  const auto find = [this](const std::string& name) {
+    return std::find_if(
+               counters_.begin(),
+               counters_.end(),
+               [&name](const PerfCounters::Event& event) { return name == event.name; }) -
+           counters_.begin();
+  };
+  const std::size_t cycles       = find("cycles");
+  const std::size_t instructions = find("instructions");
+  const bool        ipc          = counters_.size() != cycles && counters_.size() != instructions;
+
+  os << ",\n  \"counted_threads\": " << countedThreads << ",\n  \"stage_counters\": {";
+  for (std::size_t stage = 0; counts.size() != stage; ++stage) {
+    os << (stage ? ",\n" : "\n") << "    \"" << getStageName(static_cast<Stage>(stage)) << "\": {";
+    for (std::size_t i = 0; counters_.size() != i; ++i) {
+      os << (i ? ", " : "") << "\"" << counters_[i].name << "\": " << counts[stage][i];
+    }
+    if (ipc) {
+      os << ", \"ipc\": "
+         << (counts[stage][cycles] ? double(counts[stage][instructions]) / counts[stage][cycles] : 0.0);
+    }
+    os << "}";
+  }
+  os << "\n  }";
+}
+
+}  // namespace common
+}  // namespace dragenos
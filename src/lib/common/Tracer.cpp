@@ -0,0 +1,111 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <cassert>
+
+#include <boost/throw_exception.hpp>
+
+#include "common/Exceptions.hpp"
+#include "common/Tracer.hpp"
+
+namespace dragenos {
+namespace common {
+
+const char* getTraceSpanName(const TraceSpan span)
+{
+  static const char* const NAMES[] = {"memory_wait",
+                                      "read",
+                                      "cpu_wait",
+                                      "align",
+                                      "insert_size_wait",
+                                      "insert_sizes",
+                                      "encode",
+                                      "ordering_wait",
+                                      "store",
+                                      "write"};
+  static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<std::size_t>(TraceSpan::COUNT), "span names");
+  return NAMES[static_cast<std::size_t>(span)];
+}
+
+std::vector<TraceEvent> TraceBuffer::getEvents() const
+{
+  const uint64_t          written = getWritten();
+  const uint64_t          first   = capacity_ < written ? written - capacity_ : 0;
+  std::vector<TraceEvent> ret;
+  ret.reserve(written - first);
+  for (uint64_t i = first; written != i; ++i) {
+    ret.push_back(events_[i % capacity_]);
+  }
+  return ret;
+}
+
+thread_local TraceBuffer* Tracer::threadBuffer_ = nullptr;
+
+Tracer& Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::enable(const std::size_t eventsPerThread)
+{
+  if (!eventsPerThread) {
+    BOOST_THROW_EXCEPTION(InvalidParameterException("Tracer: the buffers need room for at least one event"));
+  }
+  eventsPerThread_ = eventsPerThread;
+  start_           = std::chrono::steady_clock::now();
+  enabled_         = true;
+}
+
+void Tracer::attach(const std::string& name)
+{
+  assert(!threadBuffer_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the thread ids of the trace only need to tell the threads apart
+  buffers_.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(name, buffers_.size() + 1, eventsPerThread_)));
+  threadBuffer_ = buffers_.back().get();
+}
+
+void Tracer::detach()
+{
+  threadBuffer_ = nullptr;
+}
+
+void Tracer::write(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t                    dropped = 0;
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+     << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"dragen-os\"}}";
+  for (const auto& buffer : buffers_) {
+    const std::vector<TraceEvent> events = buffer->getEvents();
+    dropped += buffer->getWritten() - events.size();
+    os << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->getTid()
+       << ", \"args\": {\"name\": \"" << buffer->getName() << " " << buffer->getTid() << "\"}}";
+    for (const TraceEvent& event : events) {
+      // complete events, in microseconds
+      os << ",\n{\"name\": \"" << getTraceSpanName(event.span) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+         << buffer->getTid() << ", \"ts\": " << event.begin / 1000 << "." << event.begin % 1000 / 100
+         << ", \"dur\": " << (event.end - event.begin) / 1000 << "." << (event.end - event.begin) % 1000 / 100;
+      if (0 <= event.block) {
+        os << ", \"args\": {\"block\": " << event.block << "}";
+      }
+      os << "}";
+    }
+  }
+  os << "\n], \"otherData\": {\"droppedEvents\": " << dropped << "}}\n";
+}
+
+}  // namespace common
+}  // namespace dragenos
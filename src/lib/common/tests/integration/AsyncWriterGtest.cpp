@@ -0,0 +1,94 @@
+#include <chrono>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/AsyncWriter.hpp"
+#include "common/Exceptions.hpp"
+
+using namespace dragenos;
+typedef common::AsyncWriter AsyncWriter;
+
+static std::vector<char> makeBuffer(const std::string& s)
+{
+  return std::vector<char>(s.begin(), s.end());
+}
+
+TEST(AsyncWriter, order)
+{
+  std::ostringstream os;
+  {
+    AsyncWriter writer(os, 1024);
+    for (int i = 0; 1000 > i; ++i) {
+      std::vector<char> buffer = makeBuffer(std::to_string(i) + ",");
+      writer.write(buffer);
+      ASSERT_TRUE(buffer.empty());
+    }
+    std::vector<char> empty;
+    writer.write(empty);
+    writer.close();
+    ASSERT_EQ(1000u, writer.getStats().writes);
+    ASSERT_GE(1024u, writer.getStats().peakQueueBytes);
+  }
+  std::string expected;
+  for (int i = 0; 1000 > i; ++i) {
+    expected += std::to_string(i) + ",";
+  }
+  ASSERT_EQ(expected, os.str());
+}
+
+/// a stream buffer that takes its time
+class SlowBuf : public std::stringbuf {
+protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return std::stringbuf::xsputn(s, n);
+  }
+};
+
+TEST(AsyncWriter, backpressure)
+{
+  SlowBuf      buf;
+  std::ostream os(&buf);
+  AsyncWriter  writer(os, 8);
+  for (int i = 0; 10 > i; ++i) {
+    std::vector<char> buffer = makeBuffer("12345678");
+    writer.write(buffer);
+  }
+  writer.close();
+  // only one buffer fits in the queue
+  ASSERT_LT(0u, writer.getStats().stalls);
+  ASSERT_LT(0.0, writer.getStats().stallSeconds);
+  ASSERT_EQ(8u, writer.getStats().peakQueueBytes);
+  ASSERT_EQ(80u, buf.str().size());
+}
+
+TEST(AsyncWriter, oversized)
+{
+  SlowBuf      buf;
+  std::ostream os(&buf);
+  AsyncWriter  writer(os, 8);
+  for (int i = 0; 10 > i; ++i) {
+    std::vector<char> buffer = makeBuffer("1234567890123456");
+    writer.write(buffer);
+  }
+  writer.close();
+  // each one waits for the write of the previous one to complete
+  ASSERT_EQ(16u, writer.getStats().peakQueueBytes);
+  ASSERT_EQ(160u, buf.str().size());
+}
+
+TEST(AsyncWriter, error)
+{
+  std::ostringstream os;
+  os.setstate(std::ios_base::badbit);
+  AsyncWriter       writer(os, 1024);
+  std::vector<char> buffer = makeBuffer("blah");
+  writer.write(buffer);
+  ASSERT_THROW(writer.close(), common::IoException);
+}
@@ -0,0 +1,78 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "common/CpuTopology.hpp"
+#include "common/Exceptions.hpp"
+
+using namespace dragenos;
+typedef common::CpuTopology CpuTopology;
+typedef common::LogicalCpu  LogicalCpu;
+
+static std::vector<int> getCpus(const std::vector<LogicalCpu>& placement)
+{
+  std::vector<int> ret;
+  for (const LogicalCpu& c : placement) {
+    ret.push_back(c.cpu);
+  }
+  return ret;
+}
+
+TEST(CpuTopology, parseCpuList)
+{
+  ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), common::parseCpuList("0-3,8,10-11"));
+  ASSERT_EQ(std::vector<int>({1, 2}), common::parseCpuList("2,1,1-2"));
+  ASSERT_THROW(common::parseCpuList(""), common::InvalidParameterException);
+  ASSERT_THROW(common::parseCpuList("3-1"), common::InvalidParameterException);
+  ASSERT_THROW(common::parseCpuList("1-2-3"), common::InvalidParameterException);
+  ASSERT_THROW(common::parseCpuList("a"), common::InvalidParameterException);
+  ASSERT_THROW(common::parseCpuList("1,"), common::InvalidParameterException);
+}
+
+TEST(CpuTopology, placement)
+{
+  namespace bfs = boost::filesystem;
+  const bfs::path sys = bfs::temp_directory_path() / bfs::unique_path();
+  // 2 packages of 2 cores with 2 SMT siblings each: cpu n and n + 4 are siblings
+  for (int cpu = 0; 8 > cpu; ++cpu) {
+    const bfs::path topology = sys / ("cpu" + std::to_string(cpu)) / "topology";
+    bfs::create_directories(topology);
+    std::ofstream((topology / "physical_package_id").string()) << (cpu % 4) / 2 << std::endl;
+    std::ofstream((topology / "core_id").string()) << cpu % 2 << std::endl;
+  }
+
+  const CpuTopology topology({7, 6, 5, 4, 3, 2, 1, 0}, sys.string());
+  ASSERT_EQ(8u, topology.getCpus().size());
+  ASSERT_EQ(4u, topology.getCoreCount());
+  // one cpu per core, alternating the packages, then the siblings
+  ASSERT_EQ(std::vector<int>({0, 2, 1, 3, 4, 6, 5, 7}), getCpus(topology.getPlacement(true)));
+  // siblings next to each other
+  ASSERT_EQ(std::vector<int>({0, 4, 1, 5, 2, 6, 3, 7}), getCpus(topology.getPlacement(false)));
+
+  // cpus without topology information are cores of their own
+  const CpuTopology partial({0, 4, 9}, sys.string());
+  ASSERT_EQ(2u, partial.getCoreCount());
+  ASSERT_EQ(std::vector<int>({9, 0, 4}), getCpus(partial.getPlacement(true)));
+
+  bfs::remove_all(sys);
+}
+
+TEST(CpuTopology, allowedCpus)
+{
+  const std::vector<int> cpus = common::getAllowedCpus();
+  ASSERT_FALSE(cpus.empty());
+}
+
+TEST(CpuTopology, threadCpus)
+{
+  const std::vector<int> cpus = common::getThreadCpus(pthread_self());
+  ASSERT_EQ(common::getAllowedCpus(), cpus);
+  common::setThreadCpus(pthread_self(), {cpus.back()});
+  ASSERT_EQ(std::vector<int>({cpus.back()}), common::getThreadCpus(pthread_self()));
+  common::setThreadCpus(pthread_self(), cpus);
+  ASSERT_EQ(cpus, common::getThreadCpus(pthread_self()));
+}
@@ -0,0 +1,72 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "common/MemoryAccounting.hpp"
+
+using namespace dragenos;
+typedef common::MemoryComponent MemoryComponent;
+
+TEST(MemoryAccounting, Counters)
+{
+  common::MemoryAccounting memory;
+  ASSERT_EQ(0u, memory.getTotal());
+  memory.add(MemoryComponent::BLOCKS_IN_FLIGHT, 300);
+  memory.add(MemoryComponent::BLOCKS_IN_FLIGHT, 200);
+  memory.set(MemoryComponent::OUTPUT_QUEUE, 100);
+  memory.add(MemoryComponent::BLOCKS_IN_FLIGHT, -400);
+  memory.set(MemoryComponent::OUTPUT_QUEUE, 0);
+  ASSERT_EQ(100u, memory.get(MemoryComponent::BLOCKS_IN_FLIGHT));
+  ASSERT_EQ(500u, memory.getPeak(MemoryComponent::BLOCKS_IN_FLIGHT));
+  ASSERT_EQ(100u, memory.getPeak(MemoryComponent::OUTPUT_QUEUE));
+  ASSERT_EQ(100u, memory.getTotal());
+  ASSERT_EQ(600u, memory.getPeakTotal());
+  // no limit
+  ASSERT_FALSE(memory.isOverLimit(1ul << 40));
+  ASSERT_EQ(0u, memory.getBlocksBudget());
+}
+
+TEST(MemoryAccounting, Limit)
+{
+  common::MemoryAccounting memory(1000);
+  memory.add(MemoryComponent::WORKERS, 600);
+  memory.add(MemoryComponent::BLOCKS_IN_FLIGHT, 200);
+  ASSERT_FALSE(memory.isOverLimit(200));
+  ASSERT_TRUE(memory.isOverLimit(201));
+  // the blocks in flight and the output queue share what the rest leaves
+  ASSERT_EQ(400u, memory.getBlocksBudget());
+  memory.add(MemoryComponent::WORKERS, 1000);
+  ASSERT_EQ(1u, memory.getBlocksBudget());
+}
+
+TEST(MemoryAccounting, Regions)
+{
+  const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+  const std::size_t bytes    = 8 * pageSize;
+  void* const       data     = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, data);
+  ASSERT_EQ(0u, common::MemoryAccounting::getResidentBytes(data, bytes));
+  // touch the first three pages
+  memset(data, 1, 3 * pageSize);
+  ASSERT_EQ(3 * pageSize, common::MemoryAccounting::getResidentBytes(data, bytes));
+
+  common::MemoryAccounting memory;
+  memory.addRegion(MemoryComponent::HASH_TABLE, data, bytes);
+  ASSERT_EQ(bytes, memory.get(MemoryComponent::HASH_TABLE));
+  ASSERT_EQ(3 * pageSize, memory.getResident(MemoryComponent::HASH_TABLE));
+  ASSERT_EQ(0u, memory.getResident(MemoryComponent::REFERENCE));
+
+  std::ostringstream os;
+  memory.report(os);
+  const std::string report = os.str();
+  ASSERT_NE(std::string::npos, report.find("Memory hash_table: 0.0 MB mapped, 0.0 MB resident")) << report;
+  ASSERT_NE(std::string::npos, report.find("Memory output_queue: 0.0 MB (peak 0.0 MB)")) << report;
+  ASSERT_NE(std::string::npos, report.find("Memory heap: ")) << report;
+  ASSERT_LT(0u, common::MemoryAccounting::getProcessMemory().rss);
+  munmap(data, bytes);
+}
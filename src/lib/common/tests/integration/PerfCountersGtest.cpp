@@ -0,0 +1,83 @@
+#include <linux/perf_event.h>
+
+#include <time.h>
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/Exceptions.hpp"
+#include "common/PerfCounters.hpp"
+
+using namespace dragenos;
+typedef common::PerfCounters PerfCounters;
+
+// the hardware counters are often missing in virtual machines and containers, the software ones
+// go through the same path
+static const std::vector<PerfCounters::Event> SOFTWARE_EVENTS = {
+    {"task_clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"unsupported", PERF_TYPE_SOFTWARE, ~0ul},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}};
+
+/// cpu time of the calling thread, in nanoseconds
+static uint64_t getThreadTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000ul + ts.tv_nsec;
+}
+
+/// busy for the cpu time, whatever the load of the machine
+static void spin(const uint64_t nanoseconds)
+{
+  const uint64_t end = getThreadTime() + nanoseconds;
+  while (getThreadTime() < end) {
+  }
+}
+
+TEST(PerfCounters, Software)
+{
+  const PerfCounters counters(SOFTWARE_EVENTS);
+  if (counters.isDenied()) {
+    GTEST_SKIP() << counters.getError();
+  }
+  ASSERT_TRUE(counters.isValid()) << counters.getError();
+  ASSERT_TRUE(counters.isOpen(0));
+  ASSERT_FALSE(counters.isOpen(1));
+  ASSERT_TRUE(counters.isOpen(2));
+
+  const PerfCounters::Values before = counters.read();
+  spin(20000000);
+  std::vector<char> pages(16 * 1024 * 1024);
+  memset(pages.data(), 1, pages.size());
+  const PerfCounters::Values after = counters.read();
+  // task clock in nanoseconds
+  ASSERT_LE(15000000u, after[0] - before[0]);
+  ASSERT_EQ(0u, after[1]);
+  ASSERT_LT(100u, after[2] - before[2]);
+}
+
+TEST(PerfCounters, Unavailable)
+{
+  const PerfCounters counters({{"unsupported", PERF_TYPE_SOFTWARE, ~0ul}});
+  ASSERT_FALSE(counters.isValid());
+  ASSERT_EQ(0u, counters.getError().find("perf_event_open unsupported: "));
+  ASSERT_EQ(PerfCounters::Values(), counters.read());
+
+  ASSERT_THROW(PerfCounters(std::vector<PerfCounters::Event>()), common::InvalidParameterException);
+}
+
+TEST(PerfCounters, Hardware)
+{
+  // whichever the machine supports, the hardware set opens or explains why
+  const PerfCounters counters(PerfCounters::getHardwareEvents());
+  ASSERT_NE(counters.isValid(), !counters.getError().empty());
+  ASSERT_EQ(counters.isValid(), 0 == counters.getErrno());
+  if (counters.isValid()) {
+    spin(10000000);
+    const PerfCounters::Values values = counters.read();
+    ASSERT_LT(0u, values[0]);
+    ASSERT_LT(0u, values[1]);
+  }
+}
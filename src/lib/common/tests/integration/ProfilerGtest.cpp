@@ -0,0 +1,146 @@
+#include <linux/perf_event.h>
+#include <time.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "common/Profiler.hpp"
+
+using namespace dragenos;
+typedef common::LatencyHistogram LatencyHistogram;
+typedef common::Stage            Stage;
+
+static double getValue(const std::string& json, const std::string& key)
+{
+  const std::size_t pos = json.find("\"" + key + "\": ");
+  EXPECT_NE(std::string::npos, pos) << key;
+  return std::stod(json.substr(pos + key.size() + 4));
+}
+
+TEST(LatencyHistogram, Buckets)
+{
+  for (uint64_t value : {0ul, 1ul, 7ul, 8ul, 15ul, 16ul, 17ul, 1000ul, 123456789ul, ~0ul}) {
+    const unsigned bucket = LatencyHistogram::getBucket(value);
+    ASSERT_GT(LatencyHistogram::BUCKET_COUNT, bucket);
+    const uint64_t lowerBound = LatencyHistogram::getBucketLowerBound(bucket);
+    ASSERT_LE(lowerBound, value);
+    ASSERT_GE(lowerBound, value - value / 8) << value;
+    ASSERT_EQ(bucket, LatencyHistogram::getBucket(lowerBound));
+  }
+  ASSERT_EQ(16u, LatencyHistogram::getBucket(16));
+  ASSERT_EQ(18u, LatencyHistogram::getBucket(20));
+  ASSERT_EQ(20u, LatencyHistogram::getBucketLowerBound(18));
+}
+
+TEST(LatencyHistogram, Quantiles)
+{
+  LatencyHistogram histogram;
+  ASSERT_EQ(0u, histogram.getQuantile(0.5));
+  for (uint64_t value = 1; 100 >= value; ++value) {
+    histogram.add(value);
+  }
+  LatencyHistogram total;
+  total.add(histogram);
+  ASSERT_EQ(100u, total.getCount());
+  ASSERT_EQ(100u, total.getMax());
+  ASSERT_EQ(48u, total.getQuantile(0.5));
+  ASSERT_EQ(88u, total.getQuantile(0.9));
+  ASSERT_EQ(96u, total.getQuantile(1.0));
+}
+
+TEST(Profiler, Stages)
+{
+  // not attached: the timers do nothing
+  {
+    const common::StageTimer timer(Stage::MAP);
+    ASSERT_EQ(nullptr, common::Profiler::getThreadProfile());
+  }
+
+  common::Profiler::instance().enable();
+  std::thread worker([]() {
+    const common::ProfileThread profileThread("worker");
+    ASSERT_NE(nullptr, common::Profiler::getThreadProfile());
+    const common::ReadTimer  readTimer;
+    const common::StageTimer pairing(Stage::PAIRING);
+    {
+      const common::StageTimer map(Stage::MAP);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    ASSERT_EQ(Stage::PAIRING, common::Profiler::getThreadProfile()->current);
+  });
+  worker.join();
+
+  std::ostringstream os;
+  common::Profiler::instance().report(os);
+  const std::string json = os.str();
+  // the nested stage is not accounted in the enclosing one
+  ASSERT_LE(0.045, getValue(json, "map"));
+  ASSERT_GT(0.045, getValue(json, "pairing"));
+  ASSERT_LE(0.045, getValue(json, "busy_seconds"));
+  ASSERT_EQ(1, getValue(json, "count"));
+  ASSERT_LE(45000, getValue(json, "max_us"));
+  ASSERT_NE(std::string::npos, json.find("\"name\": \"worker\""));
+}
+
+TEST(Profiler, Counters)
+{
+  const std::vector<common::PerfCounters::Event> events = {
+      {"task_clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+      {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}};
+  {
+    const common::PerfCounters probe(events);
+    if (probe.isDenied()) {
+      GTEST_SKIP() << probe.getError();
+    }
+  }
+  common::Profiler::instance().enable(events);
+  ASSERT_EQ("", common::Profiler::instance().getCountersError());
+  std::thread worker([]() {
+    const common::ProfileThread profileThread("counted");
+    const common::StageTimer    pairing(Stage::PAIRING);
+    {
+      const common::StageTimer sw(Stage::SMITH_WATERMAN);
+      // 30ms of cpu time, whatever the load of the machine
+      struct timespec start, now;
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+      do {
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+      } while ((now.tv_sec - start.tv_sec) * 1000000000l + now.tv_nsec - start.tv_nsec < 30000000l);
+    }
+  });
+  worker.join();
+
+  std::ostringstream os;
+  common::Profiler::instance().report(os);
+  const std::string json = os.str();
+  ASSERT_EQ(1, getValue(json, "counted_threads"));
+  const std::string sw = json.substr(json.find("\"smith_waterman\": {"));
+  // task clock in nanoseconds, charged to the stage that spun
+  ASSERT_LE(25000000, getValue(sw, "task_clock"));
+  const std::string pairing = json.substr(json.find("\"pairing\": {"));
+  ASSERT_GT(25000000, getValue(pairing, "task_clock"));
+  // no ipc without cycles and instructions
+  ASSERT_EQ(std::string::npos, json.find("\"ipc\""));
+
+  // without counters available, the profile goes on without them
+  common::Profiler::instance().enable({{"unsupported", PERF_TYPE_SOFTWARE, ~0ul}});
+  ASSERT_NE("", common::Profiler::instance().getCountersError());
+  std::ostringstream unavailable;
+  common::Profiler::instance().report(unavailable);
+  ASSERT_NE(std::string::npos, unavailable.str().find("\"counters_error\": \"perf_event_open unsupported: "));
+  ASSERT_EQ(std::string::npos, unavailable.str().find("stage_counters"));
+}
+
+TEST(Profiler, CountersErrorEscaped)
+{
+  // the event name ends up in the error of perf_event_open
+  common::Profiler::instance().enable({{"un\"support\\ed", PERF_TYPE_SOFTWARE, ~0ul}});
+  ASSERT_NE("", common::Profiler::instance().getCountersError());
+  std::ostringstream os;
+  common::Profiler::instance().report(os);
+  ASSERT_NE(std::string::npos, os.str().find("\"counters_error\": \"perf_event_open un\\\"support\\\\ed: "));
+}
@@ -0,0 +1,87 @@
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "common/Tracer.hpp"
+
+using namespace dragenos;
+typedef common::TraceSpan TraceSpan;
+
+static std::size_t count(const std::string& json, const std::string& what)
+{
+  std::size_t ret = 0;
+  for (std::size_t pos = json.find(what); std::string::npos != pos; pos = json.find(what, pos + 1)) {
+    ++ret;
+  }
+  return ret;
+}
+
+TEST(Tracer, Buffer)
+{
+  common::TraceBuffer buffer("worker", 1, 3);
+  ASSERT_TRUE(buffer.getEvents().empty());
+  for (uint64_t i = 0; 5 != i; ++i) {
+    buffer.add(common::TraceEvent{i * 10, i * 10 + 5, int32_t(i), TraceSpan::ALIGN});
+  }
+  ASSERT_EQ(5u, buffer.getWritten());
+  // the oldest ones are overwritten
+  const auto events = buffer.getEvents();
+  ASSERT_EQ(3u, events.size());
+  ASSERT_EQ(2, events[0].block);
+  ASSERT_EQ(4, events[2].block);
+}
+
+TEST(Tracer, Timeline)
+{
+  // not attached: the scopes do nothing
+  {
+    const common::TraceScope scope(TraceSpan::READ, 0);
+    ASSERT_EQ(nullptr, common::Tracer::getThreadBuffer());
+  }
+
+  common::Tracer::instance().enable(4);
+  std::thread worker([]() {
+    const common::TraceThread traceThread("worker");
+    ASSERT_NE(nullptr, common::Tracer::getThreadBuffer());
+    {
+      const common::TraceScope wait(TraceSpan::INSERT_SIZE_WAIT, 7);
+      {
+        const common::TraceScope align(TraceSpan::ALIGN, 6);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    }
+    const common::TraceScope write(TraceSpan::WRITE);
+  });
+  worker.join();
+  std::thread writer([]() {
+    const common::TraceThread traceThread("writer");
+    for (int block = 0; 6 != block; ++block) {
+      const common::TraceScope store(TraceSpan::STORE, block);
+    }
+  });
+  writer.join();
+
+  std::ostringstream os;
+  common::Tracer::instance().write(os);
+  const std::string json = os.str();
+  ASSERT_EQ(0u, json.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["));
+  ASSERT_NE(std::string::npos, json.find("\"args\": {\"name\": \"worker 1\"}"));
+  ASSERT_NE(std::string::npos, json.find("\"args\": {\"name\": \"writer 2\"}"));
+  // the nested span ends first
+  const std::size_t align = json.find("{\"name\": \"align\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": ");
+  ASSERT_NE(std::string::npos, align);
+  ASSERT_LT(align, json.find("\"name\": \"insert_size_wait\""));
+  ASSERT_NE(std::string::npos, json.find("\"args\": {\"block\": 7}"));
+  ASSERT_EQ(std::string::npos, json.find("\"args\": {\"block\": -1}"));
+  // the writer keeps its 4 latest
+  ASSERT_EQ(4u, count(json, "\"name\": \"store\""));
+  ASSERT_EQ(std::string::npos, json.find("\"args\": {\"block\": 1}"));
+  ASSERT_NE(std::string::npos, json.find("\"args\": {\"block\": 2}"));
+  ASSERT_NE(std::string::npos, json.find("\"otherData\": {\"droppedEvents\": 2}}"));
+  // 2ms at least, in microseconds
+  const std::size_t dur = json.find("\"dur\": ", align);
+  ASSERT_LE(2000.0, std::stod(json.substr(dur + 7)));
+}
@@ -217,31 +217,34 @@ void FastqToReadTransformer::convertQualities(
   }
 }
 
-void FastqToReadTransformer::convertBasesAndQualities()
+static_assert(
+    0 == sequences::Read::PADDING % VECTOR_REGISTER_WIDTH,
+    "the conversion can overrun the fields of the read by up to VECTOR_REGISTER_WIDTH - 1 bytes");
+
+void FastqToReadTransformer::convertBasesAndQualities(
+    sequences::Read::Base* b, sequences::Read::Qscore* q, const std::size_t size)
 {
-  assert(tmpBases_.size() == tmpQscores_.size());
-  const std::size_t paddedSize =
-      ((tmpQscores_.size() + VECTOR_REGISTER_WIDTH - 1) / VECTOR_REGISTER_WIDTH) * VECTOR_REGISTER_WIDTH;
-  convertQualities(&tmpBases_.front(), &tmpQscores_.front(), paddedSize);
-  convertBases2(&tmpBases_.front(), paddedSize);
+  const std::size_t paddedSize = ((size + VECTOR_REGISTER_WIDTH - 1) / VECTOR_REGISTER_WIDTH) * VECTOR_REGISTER_WIDTH;
+  convertQualities(b, q, paddedSize);
+  convertBases2(b, paddedSize);
 }
 
 #else  // VECTOR_REGISTER_WIDTH
-void FastqToReadTransformer::convertBasesAndQualities(const char q0)
+void FastqToReadTransformer::convertBasesAndQualities(
+    sequences::Read::Base* b, sequences::Read::Qscore* q, const std::size_t size, const char q0)
 {
-  assert(bases_.size() == qualities_.size());
   // convert alphabetic to numeric -- obscure implementation to enable auto-vectorization
-  for (size_t i = 0; bases_.size() > i; ++i) {
-    Base&   c = bases_[i];
-    Qscore& q = qualities_[i];
-    q -= q0;
+  for (size_t i = 0; size > i; ++i) {
+    sequences::Read::Base&   c = b[i];
+    sequences::Read::Qscore& s = q[i];
+    s -= q0;
     const char isC  = (c == 'C');
     const char isN  = (c == 'N');
     const char notN = (c != 'N');
     const char isG  = (c == 'G') | isN;
     const char isT  = (c == 'T');
     c               = isC + (isG << 1) + (isT << 1) + isT;
-    q *= notN;
+    s *= notN;
   }
 }
 
@@ -21,26 +21,43 @@ const std::string THREE_RECORDS(
     "+\n"
     "#AAAAEEEEEEEEEEAEEEEEEEEEEEEEEEEEEEEEEEEEEEEEEEEE");
 
-namespace dragenos {
-namespace io {
-
-struct TagNameBufferDump {
-  std::string name_;
-};
+using namespace dragenos;
 
-template <typename DumpT>
-DumpT& dump(DumpT& dump, const io::FastqToReadTransformer& transformer)
+TEST(Fastq2ReadTransformer, Conversion)
 {
-  dump.name_ = std::string(transformer.tmpName_.begin(), transformer.tmpName_.end());
-  return dump;
-}
+  std::stringstream stm(THREE_RECORDS);
 
-}  // namespace io
-}  // namespace dragenos
+  fastq::Tokenizer           t(stm, 1024);
+  io::FastqToReadTransformer fastq2Read;
+  align::Aligner::Read       read;
 
-using namespace dragenos;
+  ASSERT_EQ(true, t.next());
+  fastq2Read(t.token(), 1, 17, read);
+  ASSERT_EQ(std::string("blah"), read.getNameAsString());
+  ASSERT_EQ(17u, read.getId());
+  ASSERT_EQ(1u, read.getPosition());
+  ASSERT_EQ(4u, read.getLength());
+  ASSERT_EQ(sequences::Read::Bases({1, 2, 4, 8}), sequences::Read::Bases(read.getBases().begin(), read.getBases().end()));
+  ASSERT_EQ(
+      sequences::Read::Bases({1, 2, 4, 8}), sequences::Read::Bases(read.getRcBases().begin(), read.getRcBases().end()));
+  ASSERT_EQ(
+      sequences::Read::Qualities({2, 32, 32, 32}),
+      sequences::Read::Qualities(read.getQualities().begin(), read.getQualities().end()));
+
+  ASSERT_EQ(true, t.next());
+  fastq2Read(t.token(), 0, 1, read);
+  ASSERT_EQ(std::string("NB551322:14:HFVLLBGX9:4:11401:24054:1050"), read.getNameAsString());
+  ASSERT_EQ(101u, read.getLength());
+  // N is stored as 0 with quality 2
+  ASSERT_EQ(0, read.getBases()[0]);
+  ASSERT_EQ(2, read.getQualities()[0]);
+  ASSERT_EQ(8, read.getBases()[1]);
+  // ... and complemented as any base
+  ASSERT_EQ(15, read.getRcBases()[100]);
+  ASSERT_EQ(1, read.getRcBases()[99]);
+}
 
-TEST(Fastq2ReadTransformer, ProperMemoryHandover)
+TEST(Fastq2ReadTransformer, StorageReuse)
 {
   std::stringstream stm(THREE_RECORDS);
 
@@ -50,14 +67,18 @@ TEST(Fastq2ReadTransformer, ProperMemoryHandover)
 
   ASSERT_EQ(true, t.next());
   fastq2Read(t.token(), 0, 1, read);
-
   ASSERT_EQ(true, t.next());
   fastq2Read(t.token(), 0, 1, read);
+  // all the fields live in a single buffer: name | bases | rc bases | qualities
+  const char* name = read.getName().data();
+  ASSERT_LT(name + read.getName().size(), reinterpret_cast<const char*>(read.getBases().data()));
+  ASSERT_LT(read.getBases().end(), read.getRcBases().data() + 1);
+  ASSERT_LT(read.getRcBases().end(), read.getQualities().data() + 1);
+  ASSERT_EQ(0, (reinterpret_cast<const char*>(read.getBases().data()) - name) % 16);
 
-  io::TagNameBufferDump name;
-  io::dump(name, fastq2Read);
-  // The implementation ensures that memory buffers are being passed arround
-  // without being destroyed.
-  // After second conversion, the initial buffer must come back to the token
-  ASSERT_EQ(std::string("blah"), name.name_);
+  // shorter reads do not reallocate
+  ASSERT_EQ(true, t.next());
+  fastq2Read(t.token(), 0, 1, read);
+  ASSERT_EQ(49u, read.getLength());
+  ASSERT_EQ(name, read.getName().data());
 }
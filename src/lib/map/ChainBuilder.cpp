@@ -31,6 +31,7 @@ void ChainBuilder::addSeedPosition(
 #endif
   ///////////
 
+  numRandomSampleHits_ += randomSample;
   bool accepted = false;
   for (auto& seedChain : *this) {
     if (seedChain.accepts(seedPosition, reverseComplement)) {
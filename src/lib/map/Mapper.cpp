@@ -19,6 +19,7 @@
 
 #include "common/Crc32Hw.hpp"
 #include "common/DragenLogger.hpp"
+#include "common/Profiler.hpp"
 #include "map/Mapper.hpp"
 
 namespace dragenos {
@@ -48,6 +49,7 @@ static uint32_t seedOffset = 0;
 #endif
 void Mapper::getPositionChains(const Read& read, ChainBuilder& chainBuilder) const
 {
+  const common::StageTimer timer(common::Stage::MAP);
   chainBuilder.clear();
   const unsigned seedLength = hashtable_->getPrimarySeedBases();
   chainBuilder.setFilterConstant(seedLength);
@@ -60,6 +62,9 @@ void Mapper::getPositionChains(const Read& read, ChainBuilder& chainBuilder) con
   uint32_t num_extension_failure      = 0;
   uint32_t longest_nonsample_seed_len = 0;
   uint32_t num_non_sample_seed_chains = 0;
+  // consecutive seeds without any primary hit
+  uint64_t missInterval = 0;
+  ++stats_.reads;
   // TODO: check the cost of the underlying memory allocations and cace the seed positions buffer if needed
   const auto seedOffsets =
       Seed::getSeedOffsets(readLength, seedLength, SEED_PERIOD, SEED_PATTERN, FORCE_LAST_N_SEEDS);
@@ -81,8 +86,11 @@ void Mapper::getPositionChains(const Read& read, ChainBuilder& chainBuilder) con
       const sequences::Seed seed(&read, seedOffset, seedLength);
       assert(
           seed.isValid(0));  // getSeedOffset is supposed to produce offsets only for valid non-extended seeds
+      const uint64_t primaryMiss = stats_.primaryMiss;
       addToPositionChains(
           seed, chainBuilder, globalBestIntvls, longest_nonsample_seed_len, num_extension_failure);
+      missInterval               = (primaryMiss == stats_.primaryMiss) ? 0 : missInterval + 1;
+      stats_.largestMissInterval = std::max(stats_.largestMissInterval, missInterval);
     } else {
 #ifdef TRACE_SEED_CHAINS
       std::cerr << "Seed validation failed(either contains N or longer than read length)." << std::endl;
@@ -126,6 +134,7 @@ void Mapper::getPositionChains(const Read& read, ChainBuilder& chainBuilder) con
     }
   }
   chainBuilder.filterChains();
+  stats_.chains += chainBuilder.size();
 }
 
 void Mapper::addRandomSamplesToPositionChains(
@@ -187,7 +196,11 @@ void Mapper::addToPositionChains(
   const bool                       seedIsReverseComplement = (reverseData < forwardData);
   const auto                       primaryData = seedIsReverseComplement ? reverseData : forwardData;
   const auto                       hash        = getHashtable()->getPrimaryHasher()->getHash64(primaryData);
-  getHashtable()->getHits(hash, false, hashRecords, extendTableIntervals);
+  const auto accesses = getHashtable()->getHits(hash, false, hashRecords, extendTableIntervals);
+  ++stats_.seedAttempts;
+  ++stats_.primaryFirst;
+  stats_.primaryProbe += accesses.probes;
+  stats_.primaryChain += accesses.chains;
 
   ////////////////
   // std::cerr << "Mapper::addToPositionChains: found " << hashRecords.size() << " hash records:";
@@ -196,15 +209,22 @@ void Mapper::addToPositionChains(
   ////////////////
 
   if (hashRecords.empty() and extendTableIntervals.empty()) {
+    ++stats_.primaryMiss;
     return;
   }
   // DEPRECATED - V7 only
   if (HashRecord::HIFREQ == hashRecords.front().getType()) {
+    ++stats_.primaryHifreq;
     addRandomSamplesToPositionChains(
         seed, seedIsReverseComplement, fromHalfExtension, hashRecords, chainBuilder);
     return;
   }
   // at this point, it's either HIT or EXTEND records. First EXTEND as needed
+  if (!hashRecords.empty() && (HashRecord::EXTEND == hashRecords.front().getType())) {
+    ++stats_.primaryExtend;
+  } else {
+    ++stats_.primaryHit;
+  }
   uint64_t extensionHash   = hash;
   bool     extensionFailed = false;
 
@@ -254,10 +274,15 @@ void Mapper::addToPositionChains(
       const auto extendedKey =
           getExtendedKey(seed, extensionHash, extendRecord, fromHalfExtension, seedIsReverseComplement);
       const auto extendedHash = addressSegment | getHashtable()->getSecondaryHasher()->getHash64(extendedKey);
-      getHashtable()->getHits(extendedHash, true, hashRecords, extendTableIntervals);
+      const auto accesses = getHashtable()->getHits(extendedHash, true, hashRecords, extendTableIntervals);
+      ++stats_.secondaryFirst;
+      stats_.secondaryProbe += accesses.probes;
+      stats_.secondaryChain += accesses.chains;
       fromHalfExtension += extendRecord.getExtensionLength() / 2;
       extensionHash = extendedHash;
 
+      ++(hashRecords.empty() and lastExtendTableSize == extendTableIntervals.size() ? stats_.secondaryMiss
+                                                                                      : stats_.secondaryHit);
       // if extension failed, i.e. neither HIT nor INTERVAL
       if (hashRecords.empty() and lastExtendTableSize == extendTableIntervals.size()) extensionFailed = true;
       // local best interval tracking, process if extendTableIntervals is updated
@@ -313,6 +338,9 @@ void Mapper::addToPositionChains(
   if (!extendTableIntervals.empty() &&
       extendTableIntervals.back().getLength() > getHashtable()->getMaxSeedFrequency())
     extensionFailed = true;
+  if (fromHalfExtension) {
+    stats_.addExtension(2 * fromHalfExtension);
+  }
   // global best interval tracking
   if (localBestIntvl.isValidInterval()) globalBestIntvls.push_back(localBestIntvl);
 
@@ -329,7 +357,8 @@ void Mapper::addToPositionChains(
 
   // at this point there should be only HIT records (possibly 0) - add them to the seed chains
   if (!hashRecords.empty()) {
-    bool isHitSeen = false;
+    bool     isHitSeen = false;
+    uint32_t hitCount  = 0;
     for (const auto& record : boost::adaptors::reverse(hashRecords)) {
       // special case encountered in alt-aware hashtables
       if (record.isDummyHit()) {
@@ -340,7 +369,8 @@ void Mapper::addToPositionChains(
             boost::format("Expected HIT hash record but got record of type: %i") % record.getType();
         BOOST_THROW_EXCEPTION(common::PostConditionException(message.str()));
       }
-      isHitSeen                 = true;
+      isHitSeen = true;
+      ++hitCount;
       const bool isRandomSample = false;
       const bool orientation    = (seedIsReverseComplement ^ record.isReverseComplement());
       chainBuilder.addSeedPosition(
@@ -350,6 +380,7 @@ void Mapper::addToPositionChains(
         longest_nonsample_seed_len = seed.getPrimaryLength() + 2 * fromHalfExtension;
       }
     }
+    stats_.addSeedFrequency(hitCount);
     if (isHitSeen) return;
   } else if (!extendTableIntervals.empty()) {
     const uint32_t start = std::accumulate(
@@ -376,6 +407,7 @@ void Mapper::addToPositionChains(
       }
     } else {
       assert(extendTableIntervals.back().getLength() <= getHashtable()->getMaxSeedFrequency());
+      stats_.addSeedFrequency(length);
       for (uint32_t i = start + length - 1; i != start - 1; --i) {
         const auto& record         = getHashtable()->getExtendTableRecord(i);
         const bool  isRandomSample = false;
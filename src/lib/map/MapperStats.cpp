@@ -0,0 +1,92 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <iomanip>
+#include <string>
+
+#include "map/MapperStats.hpp"
+
+namespace dragenos {
+namespace map {
+
+const unsigned MapperStats::FREQUENCY_CLASS_COUNT;
+const uint32_t MapperStats::FREQUENCY_CLASSES[FREQUENCY_CLASS_COUNT] = {
+    1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+
+MapperStats& MapperStats::operator+=(const MapperStats& that)
+{
+  reads += that.reads;
+  seedAttempts += that.seedAttempts;
+  primaryFirst += that.primaryFirst;
+  primaryProbe += that.primaryProbe;
+  primaryChain += that.primaryChain;
+  secondaryFirst += that.secondaryFirst;
+  secondaryProbe += that.secondaryProbe;
+  secondaryChain += that.secondaryChain;
+  primaryMiss += that.primaryMiss;
+  primaryHit += that.primaryHit;
+  primaryHifreq += that.primaryHifreq;
+  primaryExtend += that.primaryExtend;
+  secondaryMiss += that.secondaryMiss;
+  secondaryHit += that.secondaryHit;
+  largestMissInterval = std::max(largestMissInterval, that.largestMissInterval);
+  longestExtension    = std::max(longestExtension, that.longestExtension);
+  extensionSum += that.extensionSum;
+  chains += that.chains;
+  for (unsigned i = 0; FREQUENCY_CLASS_COUNT != i; ++i) {
+    seedFrequencies[i] += that.seedFrequencies[i];
+  }
+  return *this;
+}
+
+void MapperStats::write(std::ostream& os) const
+{
+  const auto line = [&](const std::string& name, const uint64_t value) {
+    os << "MAPPER STATISTICS,," << name << "," << value << "," << std::fixed << std::setprecision(2)
+       << (reads ? double(value) / reads : 0.0) << "\n";
+  };
+  line("Reads", reads);
+  line("Exact seed attempts", seedAttempts);
+  line("Primary accesses: first", primaryFirst);
+  line("Primary accesses: probe", primaryProbe);
+  line("Primary accesses: chain", primaryChain);
+  line("Secondary accesses: first", secondaryFirst);
+  line("Secondary accesses: probe", secondaryProbe);
+  line("Secondary accesses: chain", secondaryChain);
+  line("Primary results: miss", primaryMiss);
+  line("Primary results: hit", primaryHit);
+  line("Primary results: hi-freq", primaryHifreq);
+  line("Primary results: extend", primaryExtend);
+  line("Secondary results: miss", secondaryMiss);
+  line("Secondary results: hit", secondaryHit);
+  line("Largest miss interval", largestMissInterval);
+  line("Longest seed extension", longestExtension);
+  line("Sum of seed extensions", extensionSum);
+  line("Seeds with 1 primary hit", seedFrequencies[0]);
+  line("Seeds with 2 primary hits", seedFrequencies[1]);
+  line("Seeds with 3 primary hits", seedFrequencies[2]);
+  // the classes from 4 onwards are cumulative, as in the mapper cigar
+  std::array<uint64_t, FREQUENCY_CLASS_COUNT> cumulative = seedFrequencies;
+  for (unsigned i = FREQUENCY_CLASS_COUNT - 1; 0 != i; --i) {
+    cumulative[i - 1] += cumulative[i];
+  }
+  for (unsigned i = 3; FREQUENCY_CLASS_COUNT != i; ++i) {
+    line("Seeds with primary freq. " + std::to_string(FREQUENCY_CLASSES[i]) + "+", cumulative[i]);
+  }
+  line("Chain count", chains);
+  os.flush();
+}
+
+}  // namespace map
+}  // namespace dragenos
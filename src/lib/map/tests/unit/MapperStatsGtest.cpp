@@ -0,0 +1,57 @@
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "map/MapperStats.hpp"
+
+using dragenos::map::MapperStats;
+
+static std::string getLine(const std::string& csv, const std::string& name)
+{
+  const std::size_t begin = csv.find(",," + name + ",");
+  EXPECT_NE(std::string::npos, begin) << name;
+  return csv.substr(begin + 2, csv.find('\n', begin) - begin - 2);
+}
+
+TEST(MapperStats, SeedFrequencies)
+{
+  MapperStats stats;
+  for (uint32_t frequency : {0u, 1u, 3u, 4u, 5u, 6u, 127u, 128u, 1000u}) {
+    stats.addSeedFrequency(frequency);
+  }
+  ASSERT_EQ(1u, stats.seedFrequencies[0]);
+  ASSERT_EQ(0u, stats.seedFrequencies[1]);
+  ASSERT_EQ(1u, stats.seedFrequencies[2]);
+  ASSERT_EQ(2u, stats.seedFrequencies[3]);
+  ASSERT_EQ(1u, stats.seedFrequencies[4]);
+  ASSERT_EQ(1u, stats.seedFrequencies[12]);
+  ASSERT_EQ(2u, stats.seedFrequencies[13]);
+}
+
+TEST(MapperStats, Write)
+{
+  MapperStats stats;
+  stats.reads        = 2;
+  stats.primaryFirst = 10;
+  stats.addSeedFrequency(4);
+  stats.addExtension(8);
+  MapperStats other;
+  other.reads        = 2;
+  other.primaryFirst = 5;
+  other.addSeedFrequency(200);
+  other.addExtension(4);
+  stats += other;
+
+  std::ostringstream os;
+  stats.write(os);
+  const std::string csv = os.str();
+  ASSERT_EQ("Primary accesses: first,15,3.75", getLine(csv, "Primary accesses: first"));
+  ASSERT_EQ("Longest seed extension,8,2.00", getLine(csv, "Longest seed extension"));
+  ASSERT_EQ("Sum of seed extensions,12,3.00", getLine(csv, "Sum of seed extensions"));
+  // cumulative from 4 onwards
+  ASSERT_EQ("Seeds with primary freq. 4+,2,0.50", getLine(csv, "Seeds with primary freq. 4+"));
+  ASSERT_EQ("Seeds with primary freq. 6+,1,0.25", getLine(csv, "Seeds with primary freq. 6+"));
+  ASSERT_EQ("Seeds with primary freq. 128+,1,0.25", getLine(csv, "Seeds with primary freq. 128+"));
+  ASSERT_EQ("Seeds with 1 primary hit,0,0.00", getLine(csv, "Seeds with 1 primary hit"));
+}
@@ -28,6 +28,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/thread.hpp>
 
+#include "common/CpuTopology.hpp"
 #include "common/Exceptions.hpp"
 #include "common/Version.hpp"
 #include "options/DragenOsOptions.hpp"
@@ -83,7 +84,12 @@ DragenOsOptions::DragenOsOptions() : refDir_("./"), inputFile1_(""), inputFile2_
           "Value of 1 forces smith waterman on all candidate alignments")(
           "Aligner.sw-method",
           bpo::value<std::string>(&methodSmithWaterman_)->default_value(methodSmithWaterman_),
-          "Smith Waterman implementation (dragen / mengyao  default = dragen)")(
+          "Smith Waterman implementation (dragen / mengyao / wfa  default = mengyao). wfa uses the "
+          "wavefront alignment and falls back to mengyao beyond Aligner.wfa-max-edits")(
+          "Aligner.wfa-max-edits",
+          bpo::value<int>(&wfaMaxEdits_)->default_value(wfaMaxEdits_),
+          "Maximum alignment penalty, in number of mismatches, explored by the wavefront alignment before "
+          "falling back to Smith Waterman")(
           "map-only",
           bpo::value<bool>(&mapOnly_)->default_value(mapOnly_),
           "no real alignment, produces alignment information based on seed chains only")(
@@ -114,6 +120,13 @@ DragenOsOptions::DragenOsOptions() : refDir_("./"), inputFile1_(""), inputFile2_
           "pe-stats-interval-delay",
           bpo::value<uint8_t>(&peStatsIntervalDelay_)->default_value(peStatsIntervalDelay_),
           "Number of intervals of lag between sending reads and using resulting stats")(
+          "pe-stats-in",
+          bpo::value<std::string>(&peStatsIn_),
+          "Insert size model written by --pe-stats-out in a previous run. Used from the first read instead "
+          "of sampling")(
+          "pe-stats-out",
+          bpo::value<std::string>(&peStatsOut_),
+          "File to write the insert size model of the read group to, for --pe-stats-in in later runs")(
           "Mapper.filter-len-ratio",
           bpo::value<double>(&mapperFilterLenRatio_)->default_value(mapperFilterLenRatio_),
           "Ratio for controlling seed chain filtering")(
@@ -129,7 +142,16 @@ DragenOsOptions::DragenOsOptions() : refDir_("./"), inputFile1_(""), inputFile2_
           "num-threads",
           bpo::value<decltype(mapperNumThreads_)>(&mapperNumThreads_)
               ->default_value(std::thread::hardware_concurrency()),
-          "Worker threads for mapper/aligner (default = maximum available on system)")
+          "Worker threads for mapper/aligner (default = maximum available on system)")(
+          "cpu-list",
+          bpo::value<std::string>(&cpuList_),
+          "Logical cpus to run on, such as 0-7,16-23 (default = all the cpus available to the process)")(
+          "pin-threads",
+          bpo::value<std::string>(&pinThreads_)->default_value(pinThreads_),
+          "Restrict the worker threads to num-threads cpus chosen as: none (no restriction), spread (one cpu "
+          "of each physical core before using the SMT siblings) or compact (SMT siblings next to each other). "
+          "The input and output get up to 2 other physical cores, if num-threads leaves any, and share the "
+          "cpus of the workers otherwise, as with the default num-threads")
 
           ("Aligner.sec-aligns",
            bpo::value<int>(&alignerSecAligns_)->default_value(alignerSecAligns_),
@@ -146,7 +168,64 @@ DragenOsOptions::DragenOsOptions() : refDir_("./"), inputFile1_(""), inputFile2_
 
               ("preserve-map-align-order",
                bpo::value<bool>(&preserveMapAlignOrder_)->default_value(preserveMapAlignOrder_),
-               "Preserve the order of mapper/aligner output to produce deterministic results. Impacts performance")
+               "Preserve the order of mapper/aligner output to produce deterministic results. Impacts performance")(
+                  "input-block-min-records",
+                  bpo::value<uint64_t>(&inputBlockMinRecords_)->default_value(inputBlockMinRecords_),
+                  "Smallest number of pairs per input block when reading paired fastq files")(
+                  "input-block-max-records",
+                  bpo::value<uint64_t>(&inputBlockMaxRecords_)->default_value(inputBlockMaxRecords_),
+                  "Largest number of pairs per input block when reading paired fastq files")(
+                  "input-block-min-bytes",
+                  bpo::value<uint64_t>(&inputBlockMinBytes_)->default_value(inputBlockMinBytes_),
+                  "Smallest number of bytes per input block when reading a single input file")(
+                  "input-block-max-bytes",
+                  bpo::value<uint64_t>(&inputBlockMaxBytes_)->default_value(inputBlockMaxBytes_),
+                  "Largest number of bytes per input block when reading a single input file")(
+                  "input-block-memory-limit",
+                  bpo::value<uint64_t>(&inputBlockMemoryLimit_)->default_value(inputBlockMemoryLimit_),
+                  "Maximum bytes held by the input blocks in flight, used to limit the block size. 0 for no limit")(
+                  "memory-limit",
+                  bpo::value<uint64_t>(&memoryLimit_)->default_value(memoryLimit_),
+                  "Maximum bytes for the reference, hash table, aligners, blocks in flight and output queue. "
+                  "When reached, no new block is read until the blocks in flight are stored, and the blocks "
+                  "shrink to fit. 0 for no limit")(
+                  "output-queue-bytes",
+                  bpo::value<uint64_t>(&outputQueueBytes_)->default_value(outputQueueBytes_),
+                  "Maximum bytes of formatted output waiting for the writer thread before the workers block")(
+                  "read-cache-entries",
+                  bpo::value<uint64_t>(&readCacheEntries_)->default_value(readCacheEntries_),
+                  "Number of reads (or pairs) with distinct bases for which each thread keeps the alignment "
+                  "results, reused for the exact repeats. 0 disables the cache")(
+                  "profile",
+                  bpo::value<bool>(&profile_)->default_value(profile_),
+                  "Account the time spent by the threads in each processing stage and write the profile to "
+                  "<output-file-prefix>.perf.json, or to stderr without output directory")(
+                  "profile-counters",
+                  bpo::value<bool>(&profileCounters_)->default_value(profileCounters_),
+                  "Also count the cycles, instructions, last level cache, data TLB and branch misses of each "
+                  "processing stage with the hardware counters (perf_event_open) and add them to the profile. "
+                  "Implies --profile. The profile goes on without them if they are not available")(
+                  "trace-file",
+                  bpo::value<std::string>(&traceFile_)->default_value(traceFile_),
+                  "Record the timeline of the reads, alignments, waits and writes of each thread and write it "
+                  "into this file in the chrome trace event format, for chrome://tracing or ui.perfetto.dev")(
+                  "trace-events",
+                  bpo::value<uint64_t>(&traceEvents_)->default_value(traceEvents_),
+                  "Number of the latest trace events kept per thread")(
+                  "slow-read-log",
+                  bpo::value<std::string>(&slowReadLog_)->default_value(slowReadLog_),
+                  "Record the name, length, alignment time, seed chains, Smith-Waterman calls and rescue attempts "
+                  "of the reads (or pairs) slower to align than slow-read-threshold into this tab separated file")(
+                  "slow-read-threshold",
+                  bpo::value<uint64_t>(&slowReadThreshold_)->default_value(slowReadThreshold_),
+                  "Microseconds from which the alignment of a read (or pair) goes into the slow-read-log")(
+                  "progress-interval",
+                  bpo::value<double>(&progressInterval_)->default_value(progressInterval_),
+                  "Seconds between the status lines showing the progress of the alignment on stderr. 0 disables "
+                  "them")(
+                  "progress-file",
+                  bpo::value<std::string>(&progressFile_)->default_value(progressFile_),
+                  "File rewritten at each progress interval with the status of the alignment in json")
 
                   ("build-hash-table",
                    bpo::value<bool>(&buildHashTable_)->default_value(buildHashTable_),
@@ -317,6 +396,10 @@ void DragenOsOptions::postProcess(bpo::variables_map& vm)
 
   if (alignerPeMeanInsert_ || alignerPeStddevInsert_ || !alignerPeQuartilesInsert_.empty() ||
       alignerPeMeanReadLen_) {
+    if (!peStatsIn_.empty()) {
+      BOOST_THROW_EXCEPTION(InvalidOptionException(
+          "ERROR: pe-stats-in can't be combined with the Aligner.pe-stat-* settings"));
+    }
     if (samplingEnabled_) {
       std::cerr
           << "WARNING: automatic insert-size detection is disabled due to manual override of associated settings.";
@@ -324,6 +407,56 @@ void DragenOsOptions::postProcess(bpo::variables_map& vm)
     samplingEnabled_ = false;
   }
 
+  if (!peStatsIn_.empty() && !boost::filesystem::is_regular_file(peStatsIn_)) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException("pe-stats-in must point to an existing file: " + peStatsIn_));
+  }
+
+  if ("dragen" != methodSmithWaterman_ && "mengyao" != methodSmithWaterman_ &&
+      "wfa" != methodSmithWaterman_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException(
+        "ERROR: Aligner.sw-method must be one of dragen, mengyao or wfa: " + methodSmithWaterman_));
+  }
+
+  if (0 > wfaMaxEdits_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException("ERROR: Aligner.wfa-max-edits must not be negative"));
+  }
+
+  if (!cpuList_.empty()) {
+    try {
+      common::parseCpuList(cpuList_);
+    } catch (common::InvalidParameterException& e) {
+      BOOST_THROW_EXCEPTION(InvalidOptionException("ERROR: cpu-list: " + std::string(e.what())));
+    }
+  }
+
+  if ("none" != pinThreads_ && "spread" != pinThreads_ && "compact" != pinThreads_) {
+    BOOST_THROW_EXCEPTION(
+        InvalidOptionException("ERROR: pin-threads must be one of none, spread or compact: " + pinThreads_));
+  }
+
+  if (!inputBlockMinRecords_ || inputBlockMinRecords_ > inputBlockMaxRecords_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException(
+        "ERROR: input-block-min-records must be positive and not exceed input-block-max-records"));
+  }
+
+  if (!inputBlockMinBytes_ || inputBlockMinBytes_ > inputBlockMaxBytes_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException(
+        "ERROR: input-block-min-bytes must be positive and not exceed input-block-max-bytes"));
+  }
+
+  if (!outputQueueBytes_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException("ERROR: output-queue-bytes must be positive"));
+  }
+
+  if (0.0 > progressInterval_ || (!progressFile_.empty() && 0.0 == progressInterval_)) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException(
+        "ERROR: progress-interval must not be negative, and must be positive when progress-file is given"));
+  }
+
+  if (!traceEvents_) {
+    BOOST_THROW_EXCEPTION(InvalidOptionException("ERROR: trace-events must be positive"));
+  }
+
   if (!outputDirectory_.empty()) {
     if (outputFilePrefix_.empty()) {
       BOOST_THROW_EXCEPTION(InvalidOptionException(
@@ -146,7 +146,7 @@ bool Hashtable::probeBucket(
   return false;
 }
 
-void Hashtable::probeNeighborBuckets(
+unsigned Hashtable::probeNeighborBuckets(
     const uint64_t                    initialBucketIndex,
     const uint64_t                    matchBits,
     const uint8_t                     hashThreadId,
@@ -168,11 +168,12 @@ void Hashtable::probeNeighborBuckets(
         blockStartBucketIndex + ((initialBucketIndex + i) % getBucketsPerBlock());
     if (probeBucket(
             buckets_[currentbucketIndex], matchBits, hashThreadId, hits, extendTableIntervals, trace)) {
-      return;
+      return i;
     }
   }
   // TODO: check if the LF is expected to be always set when probing
   // BOOST_THROW_EXCEPTION(std::invalid_argument("Probing completed through all neighbor buckets without finding any hash record with LF=true"));
+  return Traits::MAX_PROBES - 1;
 }
 
 bool Hashtable::followChain(const HashRecord& record, const Hash hash) const
@@ -305,7 +306,7 @@ bool Hashtable::chainBucket(
   }
 }
 
-void Hashtable::getHits(
+Hashtable::BucketAccesses Hashtable::getHits(
     const Hash&                       hash,
     const bool                        isExtended,
     std::vector<HashRecord>&          hits,
@@ -318,6 +319,7 @@ void Hashtable::getHits(
   const auto bucketIndex        = getBucketIndex(virtualByteAddress);
   const auto hashThreadId       = getThreadIdFromVirtualByteAddress(virtualByteAddress);
   hits.clear();
+  BucketAccesses accesses;
 
   if (trace)
     std::cerr << std::hex << "hash: " << hash << " bucket index: " << bucketIndex << std::dec
@@ -333,7 +335,8 @@ void Hashtable::getHits(
   if (!lastInThread) {
     const bool probing = hits.empty() || (!hits.back().isChainBegin());
     if (probing) {
-      probeNeighborBuckets(bucketIndex, matchBits, hashThreadId, hits, extendTableIntervals, trace);
+      accesses.probes =
+          probeNeighborBuckets(bucketIndex, matchBits, hashThreadId, hits, extendTableIntervals, trace);
     } else /* chaining */
     {
       const auto baseBucketIndex = (bucketIndex >> HashRecord::CHAIN_POINTER_BITS)
@@ -344,7 +347,8 @@ void Hashtable::getHits(
         hits.pop_back();
         BOOST_ASSERT(chainingRecord.isChainRecord());
         const uint64_t chainPointer = chainingRecord.getChainPointer();
-        lastInThread                = chainBucket(
+        ++accesses.chains;
+        lastInThread = chainBucket(
             buckets_[baseBucketIndex + chainPointer],
             hash,
             matchBits,
@@ -373,6 +377,7 @@ void Hashtable::getHits(
     extendTableIntervals.push_back(ExtendTableInterval(begin, hits.end()));
     hits.erase(begin, hits.end());
   }
+  return accesses;
 }
 
 }  // namespace reference
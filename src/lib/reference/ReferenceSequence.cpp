@@ -14,11 +14,99 @@
 
 #include "reference/ReferenceSequence.hpp"
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 #include <boost/format.hpp>
 
 namespace dragenos {
 namespace reference {
 
+namespace {
+
+/// complement of each 4 bits IUPAC code - swaps the A/T and C/G bits
+alignas(16) const std::array<unsigned char, 16> complement4bpb{0b0000,   // 0b0000
+                                                               0b1000,   // 0b0001
+                                                               0b0100,   // 0b0010
+                                                               0b1100,   // 0b0011
+                                                               0b0010,   // 0b0100
+                                                               0b1010,   // 0b0101
+                                                               0b0110,   // 0b0110
+                                                               0b1110,   // 0b0111
+                                                               0b0001,   // 0b1000
+                                                               0b1001,   // 0b1001
+                                                               0b0101,   // 0b1010
+                                                               0b1101,   // 0b1011
+                                                               0b0011,   // 0b1100
+                                                               0b1011,   // 0b1101
+                                                               0b0111,   // 0b1110
+                                                               0b1111};  // 0b1111
+
+/**
+ ** \brief unpack the 4 bits encoded bases in [begin, end) into 1 base per byte
+ **
+ ** An odd begin position is handled with a scalar head, then each 16 bytes of data are split into their
+ ** LSB and MSB nibbles and interleaved back into 32 consecutive bases. The tail is scalar.
+ **/
+template <bool COMPLEMENT>
+void unpackBases(const unsigned char* data, size_t position, const size_t end, unsigned char* out)
+{
+  const auto translate = [](unsigned char base) { return COMPLEMENT ? complement4bpb[base] : base; };
+  if ((position != end) && (position % 2)) {
+    *out++ = translate(data[position / 2] >> 4);
+    ++position;
+  }
+#ifdef __SSSE3__
+  const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+  const __m128i complement = _mm_load_si128(reinterpret_cast<const __m128i*>(complement4bpb.data()));
+  for (; position + 32 <= end; position += 32, out += 32) {
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position / 2));
+    __m128i       lsb    = _mm_and_si128(packed, lowNibbles);
+    __m128i       msb    = _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibbles);
+    if (COMPLEMENT) {
+      lsb = _mm_shuffle_epi8(complement, lsb);
+      msb = _mm_shuffle_epi8(complement, msb);
+    }
+    // even positions are in the LSB: interleaving LSB and MSB restores the sequence order
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(lsb, msb));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(lsb, msb));
+  }
+#endif
+  for (; position != end; ++position) {
+    const unsigned char twoBases = data[position / 2];
+    *out++                       = translate((position % 2) ? (twoBases >> 4) : (twoBases & 0xF));
+  }
+}
+
+}  // namespace
+
+void ReferenceSequence::getBases(size_t beginPosition, size_t endPosition, unsigned char* out) const
+{
+  if (endPosition <= beginPosition) {
+    return;
+  }
+  if ((endPosition - 1) / 2 >= size_) {
+    boost::format message =
+        boost::format("position greater than reference size: %i > 2 * %i") % (endPosition - 1) % size_;
+    BOOST_THROW_EXCEPTION(common::InvalidParameterException(message.str()));
+  }
+  unpackBases<false>(data_, beginPosition, endPosition, out);
+}
+
+void ReferenceSequence::getRcBases(size_t beginPosition, size_t endPosition, unsigned char* out) const
+{
+  if (endPosition <= beginPosition) {
+    return;
+  }
+  if ((endPosition - 1) / 2 >= size_) {
+    boost::format message =
+        boost::format("position greater than reference size: %i > 2 * %i") % (endPosition - 1) % size_;
+    BOOST_THROW_EXCEPTION(common::InvalidParameterException(message.str()));
+  }
+  unpackBases<true>(data_, beginPosition, endPosition, out);
+}
+
 unsigned char ReferenceSequence::getBase(size_t position) const
 {
 #if 0
@@ -64,25 +152,7 @@ unsigned char ReferenceSequence::getBase(size_t position) const
 
 unsigned char ReferenceSequence::getRcBase(size_t position) const
 {
-  unsigned char                              b = getBase(position);
-  const static std::array<unsigned char, 16> translate{0b0000,   // 0b0000
-                                                       0b1000,   // 0b0001
-                                                       0b0100,   // 0b0010
-                                                       0b1100,   // 0b0011
-                                                       0b0010,   // 0b0100
-                                                       0b1010,   // 0b0101
-                                                       0b0110,   // 0b0110
-                                                       0b1110,   // 0b0111
-                                                       0b0001,   // 0b1000
-                                                       0b1001,   // 0b1001
-                                                       0b0101,   // 0b1010
-                                                       0b1101,   // 0b1011
-                                                       0b0011,   // 0b1100
-                                                       0b1011,   // 0b1101
-                                                       0b0111,   // 0b1110
-                                                       0b1111};  // 0b1111
-
-  return translate[b];
+  return complement4bpb[getBase(position)];
 }
 
 char ReferenceSequence::decodeBase(unsigned char base)
@@ -85,6 +85,49 @@ TEST(ReferenceSequence, getBase)
   ASSERT_THROW(referenceSequence.getBase(bases.size()), dragenos::common::InvalidParameterException);
 }
 
+TEST(ReferenceSequence, getBasesBulk)
+{
+  using dragenos::reference::ReferenceSequence;
+  typedef ReferenceSequence::Region Region;
+  // all possible pairs of 4 bits codes, to exercise both the vectorized body and the scalar head and tail
+  std::vector<unsigned char> sequence(300);
+  for (size_t i = 0; sequence.size() > i; ++i) {
+    sequence[i] = (i * 37 + 11) & 0xFF;
+  }
+  ReferenceSequence referenceSequence(std::vector<Region>(), sequence.data(), sequence.size());
+  const size_t      totalBases = sequence.size() * 2;
+  for (size_t begin : {0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 63}) {
+    for (size_t end = begin; totalBases >= end; end += 7) {
+      std::vector<unsigned char> bases(end - begin, 0xAA);
+      std::vector<unsigned char> rcBases(end - begin, 0xAA);
+      referenceSequence.getBases(begin, end, bases.data());
+      referenceSequence.getRcBases(begin, end, rcBases.data());
+      for (size_t position = begin; end > position; ++position) {
+        ASSERT_EQ(referenceSequence.getBase(position), bases[position - begin])
+            << "begin: " << begin << " end: " << end << " position: " << position;
+        ASSERT_EQ(referenceSequence.getRcBase(position), rcBases[position - begin])
+            << "begin: " << begin << " end: " << end << " position: " << position;
+      }
+    }
+  }
+  std::vector<unsigned char> bases(2);
+  ASSERT_THROW(
+      referenceSequence.getBases(totalBases - 1, totalBases + 1, bases.data()),
+      dragenos::common::InvalidParameterException);
+}
+
+TEST(ReferenceSequence, getRcBase)
+{
+  const auto sequence = generateSequence();
+  using dragenos::reference::ReferenceSequence;
+  typedef ReferenceSequence::Region Region;
+  ReferenceSequence referenceSequence(std::vector<Region>(), sequence.data(), sequence.size());
+  ASSERT_EQ(8, referenceSequence.getRcBase(0));
+  ASSERT_EQ(4, referenceSequence.getRcBase(1));
+  ASSERT_EQ(2, referenceSequence.getRcBase(2));
+  ASSERT_EQ(1, referenceSequence.getRcBase(3));
+}
+
 TEST(ReferenceSequence, getSequenceCopy) {}
 
 TEST(ReferenceSequence, getBaseReference) {}
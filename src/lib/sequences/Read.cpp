@@ -14,6 +14,7 @@
 
 #include <emmintrin.h>
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <vector>
@@ -26,19 +27,16 @@ namespace sequences {
 
 Read& Read::operator=(Read&& that)
 {
-  id_       = that.id_;
-  position_ = that.position_;
-  //  name_ = std::move(that.name_);
-  //  bases_ = std::move(that.bases_);
-  //  qualities_ = std::move(that.qualities_);
-  name_.swap(that.name_);
-  bases_.swap(that.bases_);
-  rcBases_.swap(that.rcBases_);
-  qualities_.swap(that.qualities_);
+  id_         = that.id_;
+  position_   = that.position_;
+  nameLength_ = that.nameLength_;
+  length_     = that.length_;
+  stride_     = that.stride_;
+  storage_.swap(that.storage_);
   return *this;
 }
 
-void reverseComplement4bpb(const Read::Bases& bases, Read::Bases& rcBases)
+static void reverseComplement4bpb(const Read::Base* begin, const Read::Base* end, Read::Base* rcBases)
 {
   const char A = 1;
   const char C = 2;
@@ -58,22 +56,37 @@ void reverseComplement4bpb(const Read::Bases& bases, Read::Bases& rcBases)
   //static const char bases[] = {'N', 'A', 'C', 'M', 'G', 'R', 'S', 'V', 'T', 'W', 'Y', 'H', 'K', 'D', 'B', 'N'};
   //static const char bases[] = {'N', 'T', 'G', 'K', 'C', 'Y', 'S', 'B', 'A', 'W', 'R', 'D', 'M', 'H', 'V', 'N'};
   static const char rc[] = {N, T, G, K, C, Y, S, B, A, W, R, D, M, H, V, N};
-  rcBases.resize(bases.size());
-  std::transform(bases.rbegin(), bases.rend(), rcBases.begin(), [](char c) { return rc[c & 0xf]; });
+  std::transform(
+      std::reverse_iterator<const Read::Base*>(end),
+      std::reverse_iterator<const Read::Base*>(begin),
+      rcBases,
+      [](char c) { return rc[c & 0xf]; });
 }
 
-void Read::init(Name&& name, Bases&& bases, Qualities&& qualities, uint64_t id, unsigned position)
+void Read::layout(std::size_t nameLength, std::size_t length, uint64_t id, unsigned position)
 {
-  id_       = id;
-  position_ = position;
-  //  name_ = std::move(name);
-  name_.swap(name);
+  id_         = id;
+  position_   = position;
+  nameLength_ = nameLength;
+  length_     = length;
+  stride_     = (length + PADDING - 1) / PADDING * PADDING;
+  // resize never shrinks the capacity: long reads grow the storage once and for all
+  storage_.resize(qualitiesOffset() + stride_);
+}
 
-  //  bases_ = std::move(bases);
-  bases_.swap(bases);
-  //  qualities_ = std::move(qualities);
-  qualities_.swap(qualities);
-  reverseComplement4bpb(bases_, rcBases_);
+void Read::complete()
+{
+  const Base* bases = getBasesBuffer();
+  reverseComplement4bpb(bases, bases + length_, storage_.data() + rcBasesOffset());
+}
+
+void Read::init(const Name& name, const Bases& bases, const Qualities& qualities, uint64_t id, unsigned position)
+{
+  assert(bases.size() == qualities.size());
+  prepare(name.begin(), name.end(), bases.size(), id, position);
+  std::copy(bases.begin(), bases.end(), getBasesBuffer());
+  std::copy(qualities.begin(), qualities.end(), getQualitiesBuffer());
+  complete();
 }
 
 std::ostream& operator<<(std::ostream& os, const __m128i& i128)
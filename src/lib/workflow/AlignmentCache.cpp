@@ -0,0 +1,107 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <iomanip>
+
+#include "common/Crc32Hw.hpp"
+#include "workflow/AlignmentCache.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+std::ostream& operator<<(std::ostream& os, const AlignmentCache::Stats& stats)
+{
+  return os << stats.hits << " hits out of " << stats.lookups << " lookups (" << std::fixed
+            << std::setprecision(2) << (stats.lookups ? 100.0 * stats.hits / stats.lookups : 0.0)
+            << "%), " << stats.uncacheable << " results not cached because of random samples";
+}
+
+AlignmentCache::AlignmentCache(const std::size_t capacity) : slots_(capacity) {}
+
+std::size_t AlignmentCache::getBytes() const
+{
+  std::size_t ret = (slots_.capacity() + 1) * sizeof(Entry);
+  for (const Entry& entry : slots_) {
+    ret += entry.bases.capacity() + entry.records.capacity() * sizeof(Record);
+  }
+  return ret + pending_.bases.capacity() + pending_.records.capacity() * sizeof(Record);
+}
+
+AlignmentCache::Entry* AlignmentCache::lookup(
+    const align::InsertSizeParameters* insertSizeParameters,
+    const sequences::Read&             read,
+    const sequences::Read*             mate)
+{
+  ++stats_.lookups;
+  const auto bases0 = read.getBases();
+  uint32_t   hash   = common::crc32c_hw(mate ? 1 : 0, bases0.data(), bases0.size());
+  if (mate) {
+    const auto bases1 = mate->getBases();
+    hash              = common::crc32c_hw(hash ^ bases0.size(), bases1.data(), bases1.size());
+  }
+
+  Entry& slot = slots_[hash % slots_.size()];
+  if (slot.valid && hash == slot.hash && bool(mate) == slot.paired && bases0.size() == slot.length0 &&
+      slot.bases.size() == slot.length0 + (mate ? mate->getLength() : 0) &&
+      (!mate || *insertSizeParameters == slot.insertSizeParameters) &&
+      std::equal(bases0.begin(), bases0.end(), slot.bases.begin()) &&
+      (!mate || std::equal(mate->getBases().begin(), mate->getBases().end(), slot.bases.begin() + slot.length0))) {
+    ++stats_.hits;
+    return &slot;
+  }
+
+  pending_.valid  = false;
+  pending_.hash   = hash;
+  pending_.paired = bool(mate);
+  if (mate) {
+    pending_.insertSizeParameters = *insertSizeParameters;
+  }
+  pending_.length0 = bases0.size();
+  pending_.bases.assign(bases0.begin(), bases0.end());
+  if (mate) {
+    pending_.bases.insert(pending_.bases.end(), mate->getBases().begin(), mate->getBases().end());
+  }
+  pending_.recordCount = 0;
+  return nullptr;
+}
+
+void AlignmentCache::record(const std::size_t readPosition, const align::Alignment& alignment)
+{
+  if (pending_.records.size() == pending_.recordCount) {
+    pending_.records.push_back(Record());
+  }
+  Record& record      = pending_.records[pending_.recordCount++];
+  record.readPosition = readPosition;
+  record.alignment    = alignment;
+  record.hasSa        = nullptr != alignment.getSa();
+  if (record.hasSa) {
+    // the target might change after this record is stored
+    record.sa = *alignment.getSa();
+    record.sa.setSa(nullptr);
+  }
+}
+
+void AlignmentCache::commit(const bool dependsOnReadName)
+{
+  if (dependsOnReadName) {
+    ++stats_.uncacheable;
+    return;
+  }
+  pending_.valid = true;
+  std::swap(slots_[pending_.hash % slots_.size()], pending_);
+}
+
+}  // namespace workflow
+}  // namespace dragenos
@@ -0,0 +1,121 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+
+#include "workflow/BlockSizeController.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+constexpr double BlockSizeController::MIN_BLOCK_SECONDS_;
+constexpr double BlockSizeController::MAX_BLOCK_SECONDS_;
+
+BlockSizeController::BlockSizeController(
+    const std::string& unit,
+    std::size_t        minSize,
+    std::size_t        maxSize,
+    std::size_t        initialSize,
+    std::size_t        granularity,
+    std::size_t        memoryLimit,
+    std::size_t        threads,
+    std::ostream&      log)
+  : unit_(unit),
+    minSize_(std::max(minSize, granularity)),
+    maxSize_(std::max(maxSize, std::max(minSize, granularity))),
+    granularity_(std::max<std::size_t>(granularity, 1)),
+    memoryLimit_(memoryLimit),
+    threads_(std::max<std::size_t>(threads, 1)),
+    log_(log),
+    blockSize_(0),
+    changes_(0),
+    blocks_(0),
+    size_(0),
+    bytes_(0),
+    alignSeconds_(0.0),
+    idleCpus_(0),
+    maxBlocksInFlight_(0)
+{
+  blockSize_ = clamp(initialSize);
+}
+
+std::size_t BlockSizeController::clamp(std::size_t size) const
+{
+  size = std::min(std::max(size, minSize_), maxSize_);
+  return std::max(size / granularity_ * granularity_, granularity_);
+}
+
+void BlockSizeController::blockAligned(
+    std::size_t size, std::size_t bytes, double alignSeconds, std::size_t idleCpus, std::size_t blocksInFlight)
+{
+  ++blocks_;
+  size_ += size;
+  bytes_ += bytes;
+  alignSeconds_ += alignSeconds;
+  idleCpus_ += idleCpus;
+  maxBlocksInFlight_ = std::max(maxBlocksInFlight_, blocksInFlight);
+  if (threads_ == blocks_) {
+    decide();
+    blocks_            = 0;
+    size_              = 0;
+    bytes_             = 0;
+    alignSeconds_      = 0.0;
+    idleCpus_          = 0;
+    maxBlocksInFlight_ = 0;
+  }
+}
+
+void BlockSizeController::decide()
+{
+  if (!size_) {
+    return;
+  }
+  // projections for a block of the current size
+  const double blockSeconds = alignSeconds_ / size_ * blockSize_;
+  const double blockBytes   = double(bytes_) / size_ * blockSize_;
+  const double memory       = blockBytes * std::max(maxBlocksInFlight_, threads_);
+  const double idleCpus     = double(idleCpus_) / blocks_;
+
+  std::size_t newSize = blockSize_;
+  const char* reason  = nullptr;
+  if (memoryLimit_ && memory > memoryLimit_) {
+    newSize = blockSize_ / 2;
+    reason  = "blocks in flight exceed the memory limit";
+  } else if (MAX_BLOCK_SECONDS_ < blockSeconds) {
+    newSize = blockSize_ / 2;
+    reason  = "blocks take too long to align";
+  } else if (MIN_BLOCK_SECONDS_ > blockSeconds) {
+    newSize = blockSize_ * 2;
+    reason  = "blocks align too quickly";
+  } else if (1.0 <= idleCpus && MAX_BLOCK_SECONDS_ >= blockSeconds * 2) {
+    newSize = blockSize_ * 2;
+    reason  = "cpus left idle";
+  }
+  // don't grow beyond the memory limit
+  if (newSize > blockSize_ && memoryLimit_ && memory * 2 > memoryLimit_) {
+    newSize = blockSize_;
+  }
+  newSize = clamp(newSize);
+  if (newSize != blockSize_) {
+    log_ << "Block size: " << blockSize_ << " -> " << newSize << " " << unit_ << " (" << reason
+         << ": " << blockSeconds << " seconds per block, " << idleCpus << " idle cpus, "
+         << maxBlocksInFlight_ << " blocks in flight, " << memory / 1024 / 1024 << " MB in flight)"
+         << std::endl;
+    blockSize_ = newSize;
+    ++changes_;
+  }
+}
+
+}  // namespace workflow
+}  // namespace dragenos
@@ -12,6 +12,8 @@
  **
  **/
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <limits>
 
@@ -20,16 +22,23 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include "common/AsyncWriter.hpp"
 #include "common/Debug.hpp"
+#include "common/Profiler.hpp"
+#include "common/Tracer.hpp"
 #include "common/Threads.hpp"
 #include "mapping_stats.hpp"
 
 #include "align/Aligner.hpp"
+#include "align/RecordEncoder.hpp"
+#include "align/RecordStream.hpp"
 #include "align/Sam.hpp"
 #include "fastq/Tokenizer.hpp"
 #include "io/Fastq2ReadTransformer.hpp"
 
+#include "workflow/AlignmentCache.hpp"
 #include "workflow/DualFastq2SamWorkflow.hpp"
+#include "workflow/ThreadPlacement.hpp"
 
 #include "workflow/alignment/AlignmentUtils.hpp"
 
@@ -39,8 +48,9 @@ namespace workflow {
 align::InsertSizeParameters DualFastq2SamWorkflow::requestInsertSizeInfo(
     align::InsertSizeDistribution& insertSizeDistribution, std::istream& inputR1, std::istream& inputR2)
 {
-  fastq::Tokenizer r1Tokenizer(inputR1);
-  fastq::Tokenizer r2Tokenizer(inputR2);
+  const common::StageTimer timer(common::Stage::INSERT_SIZES);
+  fastq::Tokenizer         r1Tokenizer(inputR1);
+  fastq::Tokenizer         r2Tokenizer(inputR2);
 
   align::InsertSizeParameters ret;
   bool                        retDone = false;
@@ -71,23 +81,25 @@ align::InsertSizeParameters DualFastq2SamWorkflow::requestInsertSizeInfo(
 
 template <typename StoreOp>
 void DualFastq2SamWorkflow::alignDualFastq(
-    align::InsertSizeParameters& insertSizeParameters,
-    std::istream&                inputR1,
-    std::istream&                inputR2,
-    align::Aligner&              aligner,
-    const align::SinglePicker&   singlePicker,
-    const align::PairBuilder&    pairBuilder,
-    StoreOp                      store)
+    const align::InsertSizeParameters& insertSizeParameters,
+    std::istream&                      inputR1,
+    std::istream&                      inputR2,
+    int64_t                            fragmentId,
+    align::Aligner&                    aligner,
+    AlignmentCache&                    alignmentCache,
+    const align::SinglePicker&         singlePicker,
+    const align::PairBuilder&          pairBuilder,
+    align::AlignmentPairs&             alignmentPairs,
+    StoreOp                            store)
 {
-  fastq::Tokenizer r1Tokenizer(inputR1);
-  fastq::Tokenizer r2Tokenizer(inputR2);
-
-  align::AlignmentPairs alignmentPairs;
+  // the alignment of the reads is accounted in the stages nested in this one
+  const common::StageTimer timer(common::Stage::TOKENIZE);
+  fastq::Tokenizer         r1Tokenizer(inputR1);
+  fastq::Tokenizer         r2Tokenizer(inputR2);
 
   io::FastqToReadTransformer fastq2Read(options_.inputQnameSuffixDelim_, options_.fastqOffset_);
   align::Aligner::ReadPair   pair;
 
-  int64_t fragmentId = 0;
   while (r1Tokenizer.next() && r2Tokenizer.next()) {
     const auto& r1Token = r1Tokenizer.token();
     const auto& r2Token = r2Tokenizer.token();
@@ -104,8 +116,8 @@ void DualFastq2SamWorkflow::alignDualFastq(
     //    std::cout << "tada: " << fastq2Read.tmpName_.capacity() << std::endl;
 
     alignmentPairs.clear();
-    alignment::alignAndStorePair(
-        insertSizeParameters, pair, aligner, singlePicker, pairBuilder, alignmentPairs, store);
+    alignAndStorePair(
+        alignmentCache, insertSizeParameters, pair, aligner, singlePicker, pairBuilder, alignmentPairs, store);
     ++fragmentId;
   }
 
@@ -116,15 +128,50 @@ void DualFastq2SamWorkflow::alignDualFastq(
   assert(!r1Tokenizer.token().valid() && !r2Tokenizer.next());
 }
 
+void DualFastq2SamWorkflow::splitBlock(const std::vector<char>& block, std::vector<std::size_t>& offsets)
+{
+  static const int FASTQ_LINES_PER_BATCH = RECORDS_PER_BATCH_ * 4;
+
+  offsets.clear();
+  offsets.push_back(0);
+  const char* const begin = block.data();
+  const char* const end   = begin + block.size();
+  int               lines = 0;
+  for (const char* p = std::find(begin, end, '\n'); end != p; p = std::find(p, end, '\n')) {
+    ++p;
+    if (FASTQ_LINES_PER_BATCH == ++lines && end != p) {
+      offsets.push_back(p - begin);
+      lines = 0;
+    }
+  }
+  offsets.push_back(block.size());
+}
+
+std::size_t DualFastq2SamWorkflow::getBlockRecords(const BlockSizeController& blockSizeController) const
+{
+  std::size_t records = blockSizeController.getBlockSize();
+  if (maxBlockRecords_) {
+    records = std::min(records, maxBlockRecords_);
+  }
+  if (initRecords_ > recordsRead_) {
+    // end the block exactly where the initialization of the insert size statistics ends
+    records = std::min(records, initRecords_ - recordsRead_);
+  }
+  return records;
+}
+
 void DualFastq2SamWorkflow::readBlockThread(
     common::ThreadPool::lock_type& lock,
     const int                      ourBlock,
+    const BlockSizeController&     blockSizeController,
     int&                           r1Records,
     std::vector<char>&             r1Block,
     fastq::FastqNRecordReader&     r1Reader,
     int&                           r2Records,
     std::vector<char>&             r2Block,
-    fastq::FastqNRecordReader&     r2Reader)
+    fastq::FastqNRecordReader&     r2Reader,
+    ProgressMonitor&               progress,
+    const ThreadPlacement&         threadPlacement)
 {
   // if a thread is late to the party, both read blocks have been already done.
   // use < instead of != for wait
@@ -133,14 +180,19 @@ void DualFastq2SamWorkflow::readBlockThread(
   }
 
   if (blockToRead_ == ourBlock) {
+    const std::size_t records = getBlockRecords(blockSizeController);
     // in case reading takes time and more than one thread enters, reading will happen in parallel
     if (!r1Eof_ && -1 == r1Records) {
       r1Records = 0;  // we will be reading this block.
       {
         common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+        const ThreadPlacement::IoScope                      io(threadPlacement);
+        const common::StageTimer                            timer(common::Stage::READ);
+        const common::TraceScope                            trace(common::TraceSpan::READ, ourBlock);
         r1Block.clear();
-        r1Records = r1Reader.read(std::back_inserter(r1Block), RECORDS_AT_A_TIME_);
+        r1Records = r1Reader.read(std::back_inserter(r1Block), records);
         r1Eof_    = r1Reader.eof();
+        progress.inputRead(0);
       }
     }
 
@@ -150,9 +202,13 @@ void DualFastq2SamWorkflow::readBlockThread(
       r2Records = 0;
       {
         common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+        const ThreadPlacement::IoScope                      io(threadPlacement);
+        const common::StageTimer                            timer(common::Stage::READ);
+        const common::TraceScope                            trace(common::TraceSpan::READ, ourBlock);
         r2Block.clear();
-        r2Records = r2Reader.read(std::back_inserter(r2Block), RECORDS_AT_A_TIME_);
+        r2Records = r2Reader.read(std::back_inserter(r2Block), records);
         r2Eof_    = r2Reader.eof();
+        progress.inputRead(1);
       }
     }
   }
@@ -185,7 +241,8 @@ void DualFastq2SamWorkflow::parseDualFastq(
   r2Decomp.push(r2Stream);
   r2Decomp.exceptions(std::ios_base::badbit);
   try {
-    parseDualFastq(r1Decomp, r2Decomp, os, insertSizeDistributionLogStream, mappingMetricsLogStream);
+    parseDualFastq(
+        r1Stream, r1Decomp, r2Stream, r2Decomp, os, insertSizeDistributionLogStream, mappingMetricsLogStream);
   } catch (boost::iostreams::gzip_error& e) {
     BOOST_THROW_EXCEPTION(std::runtime_error(
         e.what() + std::string(" ") + std::to_string(e.error()) +
@@ -196,7 +253,9 @@ void DualFastq2SamWorkflow::parseDualFastq(
 }
 
 void DualFastq2SamWorkflow::parseDualFastq(
+    std::istream& r1File,
     std::istream& r1Stream,
+    std::istream& r2File,
     std::istream& r2Stream,
     std::ostream& os,
     std::ostream& insertSizeDistributionLogStream,
@@ -228,6 +287,9 @@ void DualFastq2SamWorkflow::parseDualFastq(
       options_.alignerResqueMinIns_,
       options_.alignerResqueMaxIns_,
       insertSizeDistributionLogStream);
+  if (!options_.peStatsIn_.empty()) {
+    insertSizeDistribution.loadModel(options_.peStatsIn_, options_.rgid_);
+  }
 
   // idle threads needed to hold results that arrive out of order
   const int                             poolThreadCount = options_.mapperNumThreads_ * 2;
@@ -246,20 +308,65 @@ void DualFastq2SamWorkflow::parseDualFastq(
       options_.alignerSecAlignsHard_,
       options_.alignerMapqMinLen_);
 
+  recordsRead_     = 0;
+  initRecords_     = 0;
+  maxBlockRecords_ = 0;
+  if (options_.samplingEnabled_) {
+    const std::size_t initIntervalSize = options_.peStatsIntervalSize_ * (options_.peStatsIntervalDelay_ - 1);
+    if (options_.peStatsIn_.empty()) {
+      initRecords_ = initIntervalSize;
+    }
+    if (options_.peStatsContinuousUpdate_) {
+      // the statistics used by a block must not depend on the results of the same block
+      maxBlockRecords_ = initIntervalSize;
+    }
+  }
+  BlockSizeController blockSizeController(
+      "pairs",
+      options_.inputBlockMinRecords_,
+      options_.inputBlockMaxRecords_,
+      RECORDS_AT_A_TIME_,
+      1000,
+      options_.inputBlockMemoryLimit_ ? options_.inputBlockMemoryLimit_ : memory_.getBlocksBudget(),
+      options_.mapperNumThreads_,
+      std::cerr);
+
   fastq::FastqNRecordReader r1Reader(r1Stream);
   fastq::FastqNRecordReader r2Reader(r2Stream);
 
   const align::Sam sam(referenceDir_.getHashtableConfig());
 
-  std::size_t cpuThreads = 0;
-  std::size_t threadID   = 0;
-  blockToStore_          = options_.preserveMapAlignOrder_ ? 0 : -1;
+  int         cpuThreads           = 0;
+  std::size_t threadID             = 0;
+  std::size_t smithWatermanSkipped = 0;
+  std::size_t speculationHits      = 0;
+  std::size_t speculationMisses    = 0;
+  std::size_t batchesTakenOver     = 0;
+  int         blocksStored         = 0;
+  // memory of the last block stored, the estimate for the next one under the memory limit
+  std::size_t lastBlockBytes = 0;
+  std::size_t memoryWaits    = 0;
+  // time spent waiting for the turn to store, summed over all threads
+  std::chrono::steady_clock::duration orderingBlockedTime(0);
+  AlignmentCache::Stats               alignmentCacheStats;
+  blockToStore_                    = options_.preserveMapAlignOrder_ ? 0 : -1;
+  // the thread placement moves the writer thread to the cpus of the I/O
+  common::AsyncWriter writer(os, options_.outputQueueBytes_);
+  // stopped before the writer goes away
+  ProgressMonitor progress(
+      options_.progressInterval_, options_.progressFile_, poolThreadCount, &writer, &memory_, std::cerr);
+  progress.addInput(options_.inputFile1_, r1File);
+  progress.addInput(options_.inputFile2_, r2File);
+  progress.start();
+  const ThreadPlacement threadPlacement(options_, common::CPU_THREADS(poolThreadCount), writer);
   // let all threads do the job have twice the hardware to make sure there are threads to
   // align while others are stuck in the save queue by one that takes
   // unexpectedly long time
   common::CPU_THREADS(poolThreadCount)
       .execute(
           [&](common::ThreadPool::lock_type& lock) {
+            const common::ProfileThread profileThread("worker");
+            const common::TraceThread   traceThread("worker");
             align::PairBuilder pairBuilder(
                 similarity,
                 options_.alnMinScore_,
@@ -285,7 +392,13 @@ void DualFastq2SamWorkflow::parseDualFastq(
                 options_.alignerMapqMinLen_,
                 options_.alignerUnpairedPen_,
                 options_.mapperFilterLenRatio_,
-                !options_.methodSmithWaterman_.compare("mengyao"));
+                !options_.methodSmithWaterman_.compare("mengyao") || !options_.methodSmithWaterman_.compare("wfa"),
+                !options_.methodSmithWaterman_.compare("wfa"),
+                options_.wfaMaxEdits_);
+            aligner.setSlowReadLog(slowReadLog_);
+            // reused from one pair to the next
+            align::AlignmentPairs alignmentPairs;
+            AlignmentCache        alignmentCache(options_.readCacheEntries_);
 
             std::vector<char> r1Block;
             // arbitrary preallocation to avoid unnecessary copy/paste
@@ -293,19 +406,110 @@ void DualFastq2SamWorkflow::parseDualFastq(
             std::vector<char> r2Block;
             r2Block.reserve(RECORDS_AT_A_TIME_ * 1024);
 
-            // records in output format
-            std::vector<char> tmpBuffer;
-            tmpBuffer.reserve(RECORDS_AT_A_TIME_ * 1024);
-            boost::iostreams::filtering_ostream ostrm;
-            ostrm.push(boost::iostreams::back_insert_device<std::vector<char>>(tmpBuffer));
-            // minimum data required for insert size calculation
-            std::vector<char> insBuffer;
-            insBuffer.reserve(RECORDS_AT_A_TIME_ * 1024);
-
-            ReadGroupAlignmentCounts& mappingMetricsLocal = mappingMetricsVector[threadID];
+            // align one batch of a block, possibly owned by another thread, with the lock released
+            const auto alignBatch = [&](BlockWork& work, const std::size_t batch) {
+              common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+              const common::TraceScope                            trace(common::TraceSpan::ALIGN, work.block);
+              boost::iostreams::filtering_istream                 inputR1;
+              inputR1.push(boost::iostreams::basic_array_source<char>{
+                  work.r1Block->data() + work.r1Offsets[batch], work.r1Block->data() + work.r1Offsets[batch + 1]});
+              boost::iostreams::filtering_istream inputR2;
+              inputR2.push(boost::iostreams::basic_array_source<char>{
+                  work.r2Block->data() + work.r2Offsets[batch], work.r2Block->data() + work.r2Offsets[batch + 1]});
+
+              align::RecordStream& records = work.records[batch];
+              records.clear();
+              aligner.setSlowReadPending(work.slowReadPending);
+
+              alignDualFastq(
+                  *work.insertSizeParameters,
+                  inputR1,
+                  inputR2,
+                  batch * RECORDS_PER_BATCH_,
+                  aligner,
+                  alignmentCache,
+                  singlePicker,
+                  pairBuilder,
+                  alignmentPairs,
+                  [&](const sequences::Read& r, const align::Alignment& a) { records.append(r, a); });
+            };
+
+            // take over a batch of the earliest block in progress before the given one. These are the blocks
+            // the caller waits for: a batch of a later block could hold its turn back. False if there is none
+            // or no cpu for it
+            const auto helpWithBatch = [&](const int beforeBlock) {
+              if (options_.mapperNumThreads_ == cpuThreads) {
+                return false;
+              }
+              BlockWork* earliest = nullptr;
+              for (BlockWork* work : blocksInProgress_) {
+                if (beforeBlock > work->block && work->getBatchCount() != work->nextBatch &&
+                    (!earliest || earliest->block > work->block)) {
+                  earliest = work;
+                }
+              }
+              if (!earliest) {
+                return false;
+              }
+              const std::size_t batch = earliest->nextBatch++;
+              ++cpuThreads;
+              alignBatch(*earliest, batch);
+              --cpuThreads;
+              ++earliest->batchesDone;
+              ++batchesTakenOver;
+              common::CPU_THREADS().notify_all();
+              return true;
+            };
+
+            // slow reads of the speculative alignment, recorded only if it doesn't get redone
+            align::SlowReadLog::Pending speculativeSlowReads;
+            // the block of this thread. Must hold a cpu
+            BlockWork  blockWork;
+            const auto alignBlock = [&](
+                const align::InsertSizeParameters& insertSizeParameters, align::SlowReadLog::Pending* slowReadPending) {
+              blockWork.insertSizeParameters = &insertSizeParameters;
+              blockWork.slowReadPending      = slowReadPending;
+              blockWork.nextBatch            = 0;
+              blockWork.batchesDone          = 0;
+              blocksInProgress_.push_back(&blockWork);
+              common::CPU_THREADS().notify_all();
+              while (blockWork.getBatchCount() != blockWork.nextBatch) {
+                const std::size_t batch = blockWork.nextBatch++;
+                alignBatch(blockWork, batch);
+                ++blockWork.batchesDone;
+              }
+              blocksInProgress_.erase(std::find(blocksInProgress_.begin(), blocksInProgress_.end(), &blockWork));
+              // wait for the batches taken over by other threads
+              while (blockWork.getBatchCount() != blockWork.batchesDone) {
+                common::CPU_THREADS().waitForChange(lock);
+              }
+            };
+
+            std::chrono::steady_clock::duration orderingBlockedTimeLocal(0);
+            const auto                          waitForOrdering = [&]() {
+              const common::TraceScope trace(common::TraceSpan::ORDERING_WAIT, blockWork.block);
+              const auto               waitStart = std::chrono::steady_clock::now();
+              common::CPU_THREADS().waitForChange(lock);
+              orderingBlockedTimeLocal += std::chrono::steady_clock::now() - waitStart;
+            };
+
+            ReadGroupAlignmentCounts&        mappingMetricsLocal = mappingMetricsVector[threadID];
+            ProgressMonitor::WorkerCounters& progressLocal       = progress.getWorker(threadID);
             threadID++;
+            align::SamRecordEncoder encoder(sam, options_.rgid_);
+            // aligner state accounted for this thread
+            std::size_t workerBytes = 0;
 
             do {
+              // no new block until the blocks in flight make room for it
+              if (memory_.isOverLimit(lastBlockBytes) && blockToStart_ != blocksStored) {
+                const common::TraceScope trace(common::TraceSpan::MEMORY_WAIT, blockToStart_);
+                ++memoryWaits;
+                while (memory_.isOverLimit(lastBlockBytes) && blockToStart_ != blocksStored && !r1Eof_ &&
+                       !r2Eof_) {
+                  common::CPU_THREADS().waitForChange(lock);
+                }
+              }
               const int ourBlock = blockToStart_++;
 
               // keep track of which read is reading
@@ -316,7 +520,17 @@ void DualFastq2SamWorkflow::parseDualFastq(
                   lock,
                   [&](common::ThreadPool::lock_type& lock) {
                     readBlockThread(
-                        lock, ourBlock, r1Records, r1Block, r1Reader, r2Records, r2Block, r2Reader);
+                        lock,
+                        ourBlock,
+                        blockSizeController,
+                        r1Records,
+                        r1Block,
+                        r1Reader,
+                        r2Records,
+                        r2Block,
+                        r2Reader,
+                        progress,
+                        threadPlacement);
                   },
                   2);
 
@@ -330,16 +544,56 @@ void DualFastq2SamWorkflow::parseDualFastq(
                   }
 
                   // both reads completed, let others move on
+                  recordsRead_ += r1Records;
+                  memory_.add(common::MemoryComponent::BLOCKS_IN_FLIGHT, r1Block.size() + r2Block.size());
                   ++blockToRead_;
+                  progress.blocksRead(blockToRead_);
                   common::CPU_THREADS().notify_all();
 
-                  while (blockToGetInsertSizes_ != ourBlock) {
-                    common::CPU_THREADS().waitForChange(lock);
+                  {
+                    common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+                    blockWork.block   = ourBlock;
+                    blockWork.r1Block = &r1Block;
+                    blockWork.r2Block = &r2Block;
+                    splitBlock(r1Block, blockWork.r1Offsets);
+                    splitBlock(r2Block, blockWork.r2Offsets);
+                    assert(blockWork.r1Offsets.size() == blockWork.r2Offsets.size());
+                    blockWork.records.resize(blockWork.getBatchCount());
+                    blockWork.samBuffers.resize(blockWork.getBatchCount());
+                  }
+
+                  // align speculatively with the latest known parameters, without waiting for the
+                  // insert size statistics that might need the results of the blocks in flight
+                  {
+                    const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                    while (options_.mapperNumThreads_ == cpuThreads || blockToAlign_ != ourBlock) {
+                      common::CPU_THREADS().waitForChange(lock);
+                    }
+                  }
+                  ++cpuThreads;
+                  ++blockToAlign_;
+                  common::CPU_THREADS().notify_all();
+                  const align::InsertSizeParameters speculativeParameters = latestInsertSizeParameters_;
+                  const auto                        alignStart            = std::chrono::steady_clock::now();
+                  alignBlock(speculativeParameters, &speculativeSlowReads);
+                  auto alignTime = std::chrono::steady_clock::now() - alignStart;
+                  --cpuThreads;
+                  common::CPU_THREADS().notify_all();
+
+                  {
+                    const common::TraceScope trace(common::TraceSpan::INSERT_SIZE_WAIT, ourBlock);
+                    while (blockToGetInsertSizes_ != ourBlock) {
+                      if (!helpWithBatch(ourBlock)) {
+                        common::CPU_THREADS().waitForChange(lock);
+                      }
+                    }
                   }
 
                   align::InsertSizeParameters insertSizeParameters;
                   {
                     common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+                    const common::TraceScope                            trace(
+                        common::TraceSpan::INSERT_SIZES, ourBlock);
                     boost::iostreams::filtering_istream                 inputR1;
                     inputR1.push(boost::iostreams::basic_array_source<char>{
                         &r1Block.front(), &r1Block.front() + r1Block.size()});
@@ -349,89 +603,119 @@ void DualFastq2SamWorkflow::parseDualFastq(
                     insertSizeParameters = requestInsertSizeInfo(insertSizeDistribution, inputR1, inputR2);
                   }
                   assert(blockToGetInsertSizes_ == ourBlock);
+                  latestInsertSizeParameters_ = insertSizeParameters;
+                  progress.insertSizesChanged(insertSizeParameters);
                   ++blockToGetInsertSizes_;
                   common::CPU_THREADS().notify_all();
 
-                  while (options_.mapperNumThreads_ == cpuThreads || blockToAlign_ != ourBlock) {
-                    common::CPU_THREADS().waitForChange(lock);
+                  // reconcile: the output is identical to aligning with the actual parameters
+                  if (speculativeParameters == insertSizeParameters) {
+                    ++speculationHits;
+                  } else {
+                    ++speculationMisses;
+                    speculativeSlowReads.clear();
+                    {
+                      const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                      while (options_.mapperNumThreads_ == cpuThreads) {
+                        common::CPU_THREADS().waitForChange(lock);
+                      }
+                    }
+                    ++cpuThreads;
+                    const auto realignStart = std::chrono::steady_clock::now();
+                    alignBlock(insertSizeParameters, nullptr);
+                    alignTime += std::chrono::steady_clock::now() - realignStart;
+                    --cpuThreads;
+                    common::CPU_THREADS().notify_all();
+                  }
+
+                  // format the output and count the metrics once, from the final records of the block
+                  {
+                    const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                    while (options_.mapperNumThreads_ == cpuThreads) {
+                      common::CPU_THREADS().waitForChange(lock);
+                    }
                   }
                   ++cpuThreads;
-                  ++blockToAlign_;
-                  common::CPU_THREADS().notify_all();
                   {
                     common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
-                    boost::iostreams::filtering_istream                 inputR1;
-                    inputR1.push(boost::iostreams::basic_array_source<char>{
-                        &r1Block.front(), &r1Block.front() + r1Block.size()});
-                    boost::iostreams::filtering_istream inputR2;
-                    inputR2.push(boost::iostreams::basic_array_source<char>{
-                        &r2Block.front(), &r2Block.front() + r2Block.size()});
-                    insBuffer.clear();
-                    tmpBuffer.clear();
-
-                    alignDualFastq(
-                        insertSizeParameters,
-                        inputR1,
-                        inputR2,
-                        aligner,
-                        singlePicker,
-                        pairBuilder,
-                        [&](const sequences::Read& r, const align::Alignment& a) {
-                          sam.generateRecord(ostrm, r, a, options_.rgid_) << "\n";
-
-                          const auto before = insBuffer.size();
-                          insBuffer.resize(before + sequences::SerializedRead::getByteSize(r));
-                          const auto before2 = insBuffer.size();
-                          insBuffer.resize(before2 + align::SerializedAlignment::getByteSize(a));
-
-                          // resize can invalidate references...
-                          sequences::SerializedRead& sr =
-                              *reinterpret_cast<sequences::SerializedRead*>(&insBuffer.front() + before);
-                          sr << r;
-
-                          align::SerializedAlignment& sa =
-                              *reinterpret_cast<align::SerializedAlignment*>(&insBuffer.front() + before2);
-                          sa << a;
-
-                          mappingMetricsLocal.addRecord(sa, sr);
-                        });
-                    ostrm.flush();
+                    const common::StageTimer                            timer(common::Stage::ENCODE);
+                    const common::TraceScope                            trace(common::TraceSpan::ENCODE, ourBlock);
+                    const auto encodeStart = std::chrono::steady_clock::now();
+                    if (slowReadLog_) {
+                      slowReadLog_->record(speculativeSlowReads);
+                    }
+                    for (std::size_t batch = 0; blockWork.getBatchCount() != batch; ++batch) {
+                      std::vector<char>& samBuffer = blockWork.samBuffers[batch];
+                      samBuffer.clear();
+                      boost::iostreams::filtering_ostream ostrm;
+                      ostrm.push(boost::iostreams::back_insert_device<std::vector<char>>(samBuffer));
+                      blockWork.records[batch].forEach(
+                          [&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) {
+                            mappingMetricsLocal.addRecord(a, r);
+                            encoder.encode(ostrm, r, a);
+                          });
+                      ostrm.flush();
+                    }
+                    alignTime += std::chrono::steady_clock::now() - encodeStart;
+                    progressLocal.reads.fetch_add(2 * r1Records, std::memory_order_relaxed);
                   }
-
                   --cpuThreads;
                   common::CPU_THREADS().notify_all();
 
+                  std::size_t blockBytes = r1Block.size() + r2Block.size();
+                  for (std::size_t batch = 0; blockWork.getBatchCount() != batch; ++batch) {
+                    blockBytes += blockWork.samBuffers[batch].size() + blockWork.records[batch].getByteSize();
+                  }
+                  memory_.add(
+                      common::MemoryComponent::BLOCKS_IN_FLIGHT, blockBytes - r1Block.size() - r2Block.size());
+                  blockSizeController.blockAligned(
+                      r1Records,
+                      blockBytes,
+                      std::chrono::duration_cast<std::chrono::duration<double>>(alignTime).count(),
+                      options_.mapperNumThreads_ - cpuThreads,
+                      blockToRead_ - blocksStored);
+
                   if (options_.preserveMapAlignOrder_) {
                     while (blockToStore_ != ourBlock) {
-                      common::CPU_THREADS().waitForChange(lock);
+                      if (!helpWithBatch(ourBlock)) {
+                        waitForOrdering();
+                      }
                     }
                   } else {
                     while (-1 != blockToStore_) {
-                      common::CPU_THREADS().waitForChange(lock);
+                      if (!helpWithBatch(ourBlock)) {
+                        waitForOrdering();
+                      }
                     }
                     blockToStore_ = ourBlock;
                   }
 
                   {
                     common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
-                    for (auto it = insBuffer.begin(); insBuffer.end() != it;) {
-                      char*                            p = &*it;
-                      const sequences::SerializedRead* pRead =
-                          reinterpret_cast<const sequences::SerializedRead*>(p);
-                      it += pRead->getByteSize();
-                      p = &*it;
-                      const align::SerializedAlignment* pAlignment =
-                          reinterpret_cast<const align::SerializedAlignment*>(p);
-                      it += pAlignment->getByteSize();
-                      // sam.generateRecord(os, *pRead, *pAlignment, options_.rgid_) << "\n";
-                      insertSizeDistribution.add(*pAlignment, *pRead);
-                    }
-                    if (!os.write(&tmpBuffer.front(), tmpBuffer.size())) {
-                      throw std::logic_error(
-                          std::string("Error writing output stream. Error: ") + strerror(errno));
+                    const common::StageTimer                            timer(common::Stage::STORE);
+                    const common::TraceScope                            trace(common::TraceSpan::STORE, ourBlock);
+                    for (std::size_t batch = 0; blockWork.getBatchCount() != batch; ++batch) {
+                      // the samples must reach the insert size statistics in the order of the input
+                      if (insertSizeDistribution.isSamplingEnabled()) {
+                        blockWork.records[batch].forEach(
+                            [&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) {
+                              insertSizeDistribution.add(a, r);
+                            });
+                      }
+                      writer.write(blockWork.samBuffers[batch]);
                     }
                   }
+                  memory_.add(common::MemoryComponent::BLOCKS_IN_FLIGHT, -int64_t(blockBytes));
+                  memory_.set(common::MemoryComponent::OUTPUT_QUEUE, writer.getQueuedBytes());
+                  const std::size_t alignerBytes = sizeof(aligner) + aligner.getSmithWatermanProfileBytes() +
+                                                   alignmentCache.getBytes();
+                  memory_.add(common::MemoryComponent::WORKERS, int64_t(alignerBytes) - int64_t(workerBytes));
+                  workerBytes    = alignerBytes;
+                  lastBlockBytes = blockBytes;
+
                   assert(blockToStore_ == ourBlock);
+                  ++blocksStored;
+                  progress.blocksStored(blocksStored);
                   if (options_.preserveMapAlignOrder_) {
                     ++blockToStore_;
                   } else {
@@ -443,8 +727,15 @@ void DualFastq2SamWorkflow::parseDualFastq(
               // else we're a thread that waited to read its block until it learned that there will be no more
               // input data. just quietly exit
             } while (!r1Eof_ && !r2Eof_);
+
+            smithWatermanSkipped += aligner.getSmithWatermanSkipped();
+            alignmentCacheStats += alignmentCache.getStats();
+            mapperStats_ += aligner.getMapperStats();
+            orderingBlockedTime += orderingBlockedTimeLocal;
+            memory_.add(common::MemoryComponent::WORKERS, -int64_t(workerBytes));
           },
           options_.mapperNumThreads_);
+  progress.stop();
 
   // aggregate and print mapping metrics
   for (int ii = 0; ii < mappingMetricsVector.size(); ii++) {
@@ -452,9 +743,30 @@ void DualFastq2SamWorkflow::parseDualFastq(
   }
 
   mappingMetricsGlobal.printStats(std::chrono::system_clock::now() - timeStart);
+  std::cerr << "Smith-Waterman alignments avoided: " << smithWatermanSkipped << std::endl;
+  if (options_.readCacheEntries_) {
+    std::cerr << "Read cache: " << alignmentCacheStats << std::endl;
+  }
+  std::cerr << "Blocks aligned with speculative insert size parameters: " << speculationHits
+            << " kept, " << speculationMisses << " realigned" << std::endl;
+  std::cerr << "Batches taken over by idle threads: " << batchesTakenOver << std::endl;
+  std::cerr << "Final block size: " << blockSizeController.getBlockSize() << " pairs after "
+            << blockSizeController.getChanges() << " changes" << std::endl;
+  writer.close();
+  memory_.set(common::MemoryComponent::OUTPUT_QUEUE, 0);
+  std::cerr << "Output writer: " << writer << std::endl;
+  if (memory_.getLimit()) {
+    std::cerr << "Memory limit: reading waited " << memoryWaits << " times for the blocks in flight" << std::endl;
+  }
+  std::cerr << "Time blocked on output ordering: "
+            << std::chrono::duration_cast<std::chrono::duration<double>>(orderingBlockedTime).count()
+            << " thread-seconds" << std::endl;
 
   insertSizeDistribution.forceInitDoneSending();
   std::cerr << insertSizeDistribution << std::endl;
+  if (!options_.peStatsOut_.empty()) {
+    insertSizeDistribution.saveModel(options_.peStatsOut_, options_.rgid_);
+  }
 }
 
 }  // namespace workflow
@@ -29,6 +29,7 @@
 #include "common/hash_generation/gen_hash_table.h"
 #include "common/hash_generation/hash_table_compress.h"
 #include "workflow/GenHashTableWorkflow.hpp"
+#include "workflow/ThreadPlacement.hpp"
 
 #include "common/public/linux_utils.hpp"
 
@@ -279,6 +280,7 @@ void buildHashTable(const options::DragenOsOptions& opts)
 
   DRAGEN_OS_THREAD_CERR << "Version: " << common::Version::string() << std::endl;
   DRAGEN_OS_THREAD_CERR << "argc: " << opts.argc() << " argv: " << opts.getCommandLine() << std::endl;
+  restrictCpus(opts);
 
   std::cout << "==================================================================\n";
   std::cout << "Building hash table from " << opts.htReference_ << "\n";
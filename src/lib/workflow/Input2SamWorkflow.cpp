@@ -12,10 +12,14 @@
  **
  **/
 
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <fstream>
+#include <iterator>
 #include <limits>
+#include <memory>
 
 #include "boost/iostreams/filter/gzip.hpp"
 
@@ -24,10 +28,17 @@
 #include <boost/iostreams/filtering_stream.hpp>
 
 #include "align/Aligner.hpp"
+#include "align/RecordEncoder.hpp"
+#include "align/RecordStream.hpp"
 #include "align/Sam.hpp"
+#include "align/SlowReadLog.hpp"
 #include "bam/BamBlockReader.hpp"
 #include "bam/Tokenizer.hpp"
+#include "common/AsyncWriter.hpp"
 #include "common/Debug.hpp"
+#include "common/MemoryAccounting.hpp"
+#include "common/Profiler.hpp"
+#include "common/Tracer.hpp"
 #include "common/Threads.hpp"
 #include "fastq/FastqBlockReader.hpp"
 #include "fastq/Tokenizer.hpp"
@@ -37,8 +48,12 @@
 #include "options/DragenOsOptions.hpp"
 #include "reference/ReferenceDir.hpp"
 
+#include "workflow/AlignmentCache.hpp"
+#include "workflow/BlockSizeController.hpp"
 #include "workflow/DualFastq2SamWorkflow.hpp"
 #include "workflow/Input2SamWorkflow.hpp"
+#include "workflow/ProgressMonitor.hpp"
+#include "workflow/ThreadPlacement.hpp"
 
 #include "workflow/alignment/AlignmentUtils.hpp"
 
@@ -61,6 +76,7 @@ align::InsertSizeParameters requestInsertSizeInfo(
     align::InsertSizeDistribution&  insertSizeDistribution,
     std::istream&                   input)
 {
+  const common::StageTimer   timer(common::Stage::INSERT_SIZES);
   Tokenizer                  tokenizer(input);
   align::Aligner::Read::Name lastName;
 
@@ -117,18 +133,20 @@ io::BamToReadTransformer makeReadTransformer<io::BamToReadTransformer>(
  */
 template <typename ReadTransformer, typename Tokenizer, typename StoreOp>
 void alignSingleInput(
-    align::InsertSizeParameters&    insertSizeParameters,
-    const options::DragenOsOptions& options,
-    std::istream&                   input,
-    align::Aligner&                 aligner,
-    const align::SinglePicker&      singlePicker,
-    const align::PairBuilder&       pairBuilder,
-    StoreOp                         store)
+    const align::InsertSizeParameters& insertSizeParameters,
+    const options::DragenOsOptions&    options,
+    std::istream&                      input,
+    align::Aligner&                    aligner,
+    AlignmentCache&                    alignmentCache,
+    const align::SinglePicker&         singlePicker,
+    const align::PairBuilder&          pairBuilder,
+    align::AlignmentPairs&             alignmentPairs,
+    align::Aligner::Alignments&        alignments,
+    StoreOp                            store)
 {
-  Tokenizer tokenizer(input);
-
-  align::AlignmentPairs      alignmentPairs;
-  align::Aligner::Alignments alignments;
+  // the alignment of the reads is accounted in the stages nested in this one
+  const common::StageTimer timer(common::Stage::TOKENIZE);
+  Tokenizer                tokenizer(input);
 
   ReadTransformer          input2Read = makeReadTransformer<ReadTransformer>(options);
   align::Aligner::ReadPair pair;
@@ -139,15 +157,17 @@ void alignSingleInput(
     const auto& token = tokenizer.token();
 
     const auto& name = token.getName(options.inputQnameSuffixDelim_);
-    if (options.interleaved_ && align::Aligner::Read::Name(name.first, name.second) == lastName) {
+    // compared in place, not to allocate a name for each read
+    if (options.interleaved_ && lastName.size() == std::size_t(std::distance(name.first, name.second)) &&
+        std::equal(name.first, name.second, lastName.begin())) {
       // interleaved fastq case, just treat it as paired
       input2Read(token, 1, fragmentId - 1, pair[1]);
-      alignment::alignAndStorePair(
-          insertSizeParameters, pair, aligner, singlePicker, pairBuilder, alignmentPairs, store);
+      alignAndStorePair(
+          alignmentCache, insertSizeParameters, pair, aligner, singlePicker, pairBuilder, alignmentPairs, store);
       lastName.clear();
     } else {
       if (!lastName.empty()) {
-        alignment::alignAndStoreSingle(pair.at(0), aligner, singlePicker, alignments, store);
+        alignAndStoreSingle(alignmentCache, pair.at(0), aligner, singlePicker, alignments, store);
       }
       input2Read(token, 0, fragmentId, pair[0]);
       ++fragmentId;
@@ -157,7 +177,7 @@ void alignSingleInput(
 
   if (!lastName.empty()) {
     // last unprocesses single-ended read
-    alignment::alignAndStoreSingle(pair.at(0), aligner, singlePicker, alignments, store);
+    alignAndStoreSingle(alignmentCache, pair.at(0), aligner, singlePicker, alignments, store);
   }
 
   assert(input.eof());
@@ -180,14 +200,19 @@ fastq::FastqBlockReader makeBlockReader<fastq::FastqBlockReader>(
   return fastq::FastqBlockReader(is);
 }
 
+/// file is the file under the decompressed stream is, for the progress
 template <typename ReadTransformer, typename Tokenizer, typename BlockReader>
 void parseSingleInput(
+    std::istream&                   file,
     std::istream&                   is,
     std::ostream&                   os,
     const options::DragenOsOptions& options,
     const reference::ReferenceDir7& referenceDir,
     const reference::Hashtable&     hashtable,
-    std::ostream&                   mappingMetricsLogStream)
+    std::ostream&                   mappingMetricsLogStream,
+    map::MapperStats&               mapperStats,
+    common::MemoryAccounting&       memory,
+    align::SlowReadLog*             slowReadLog)
 {
   std::chrono::system_clock::time_point timeStart = std::chrono::system_clock::now();
 
@@ -212,6 +237,9 @@ void parseSingleInput(
       options.alignerResqueMinIns_,
       options.alignerResqueMaxIns_,
       std::cerr);
+  if (!options.peStatsIn_.empty()) {
+    insertSizeDistribution.loadModel(options.peStatsIn_, options.rgid_);
+  }
 
   const align::SimilarityScores similarity(options.matchScore_, options.mismatchScore_);
   align::SinglePicker           singlePicker(
@@ -235,17 +263,49 @@ void parseSingleInput(
   BlockReader reader = makeBlockReader<BlockReader>(is, options);
 
   std::size_t threadID              = 0;
-  std::size_t cpuThreads            = 0;
+  std::size_t smithWatermanSkipped  = 0;
+  int         cpuThreads            = 0;
   int         blockToRead           = 0;
   int         blockToGetInsertSizes = 0;
   int         blockToAlign          = 0;
   int         blockToStore          = options.preserveMapAlignOrder_ ? 0 : -1;
+  std::size_t speculationHits       = 0;
+  std::size_t speculationMisses     = 0;
+  int         blocksStored          = 0;
+  // memory of the last block stored, the estimate for the next one under the memory limit
+  std::size_t lastBlockBytes = 0;
+  std::size_t memoryWaits    = 0;
+  // parameters of the last block that got its insert sizes. Used to align the next blocks speculatively
+  align::InsertSizeParameters latestInsertSizeParameters;
+  AlignmentCache::Stats       alignmentCacheStats;
+
+  // initial block size, adapted as the blocks get aligned
+  static const std::size_t BUFFER_SIZE = 1024 * 256;
+  BlockSizeController      blockSizeController(
+      "bytes",
+      options.inputBlockMinBytes_,
+      options.inputBlockMaxBytes_,
+      BUFFER_SIZE,
+      4096,
+      options.inputBlockMemoryLimit_ ? options.inputBlockMemoryLimit_ : memory.getBlocksBudget(),
+      options.mapperNumThreads_,
+      std::cerr);
+  // the thread placement moves the writer thread to the cpus of the I/O
+  common::AsyncWriter writer(os, options.outputQueueBytes_);
+  // stopped before the writer goes away
+  ProgressMonitor progress(
+      options.progressInterval_, options.progressFile_, poolThreadCount, &writer, &memory, std::cerr);
+  progress.addInput(options.inputFile1_, file);
+  progress.start();
+  const ThreadPlacement threadPlacement(options, common::CPU_THREADS(poolThreadCount), writer);
   // let all threads do the job have twice the hardware to make sure there are threads to
   // align while others are stuck in the save queue by one that takes
   // unexpectedly long time
   common::CPU_THREADS(poolThreadCount)
       .execute(
           [&](common::ThreadPool::lock_type& lock) {
+            const common::ProfileThread profileThread("worker");
+            const common::TraceThread   traceThread("worker");
             align::PairBuilder pairBuilder(
                 similarity,
                 options.alnMinScore_,
@@ -270,32 +330,112 @@ void parseSingleInput(
                 options.alignerMapqMinLen_,
                 options.alignerUnpairedPen_,
                 options.mapperFilterLenRatio_,
-                !options.methodSmithWaterman_.compare("mengyao"));
-
-            static const std::size_t BUFFER_SIZE = 1024 * 256;
-
+                !options.methodSmithWaterman_.compare("mengyao") || !options.methodSmithWaterman_.compare("wfa"),
+                !options.methodSmithWaterman_.compare("wfa"),
+                options.wfaMaxEdits_);
+            aligner.setSlowReadLog(slowReadLog);
+            // reused from one read to the next
+            align::AlignmentPairs      alignmentPairs;
+            align::Aligner::Alignments alignments;
+            AlignmentCache             alignmentCache(options.readCacheEntries_);
+
+            // records of the block, produced once by the aligner
+            align::RecordStream records;
+            // slow reads of the speculative alignment, recorded only if it doesn't get redone
+            align::SlowReadLog::Pending speculativeSlowReads;
             // records in output format
             std::vector<char> tmpBuffer;
             tmpBuffer.reserve(BUFFER_SIZE * 2);
             boost::iostreams::filtering_ostream ostrm;
             ostrm.push(boost::iostreams::back_insert_device<std::vector<char>>(tmpBuffer));
+            align::SamRecordEncoder encoder(sam, options.rgid_);
 
             //    char              inBuffer[BUFFER_SIZE];
             std::vector<char> inBuffer(BUFFER_SIZE);
-            std::vector<char> outBuffer;
 
             //    auto                      lock                = common::CPU_THREADS().lock();
-            ReadGroupAlignmentCounts& mappingMetricsLocal = mappingMetricsVector[threadID];
+            ReadGroupAlignmentCounts&        mappingMetricsLocal = mappingMetricsVector[threadID];
+            ProgressMonitor::WorkerCounters& progressLocal       = progress.getWorker(threadID);
             threadID++;
+            // aligner state accounted for this thread
+            std::size_t workerBytes = 0;
 
             while (!reader.eof()) {
-              const std::size_t n = reader.read(&inBuffer[0], BUFFER_SIZE);
+              // no new block until the blocks in flight make room for it
+              if (memory.isOverLimit(lastBlockBytes) && blockToRead != blocksStored) {
+                const common::TraceScope trace(common::TraceSpan::MEMORY_WAIT, blockToRead);
+                ++memoryWaits;
+                while (memory.isOverLimit(lastBlockBytes) && blockToRead != blocksStored) {
+                  common::CPU_THREADS().waitForChange(lock);
+                }
+                if (reader.eof()) {
+                  break;
+                }
+              }
+              const std::size_t blockSize = blockSizeController.getBlockSize();
+              if (inBuffer.size() < blockSize) {
+                inBuffer.resize(blockSize);
+              }
+              std::size_t n = 0;
+              {
+                const ThreadPlacement::IoScope io(threadPlacement);
+                const common::StageTimer       timer(common::Stage::READ);
+                const common::TraceScope       trace(common::TraceSpan::READ, blockToRead);
+                n = reader.read(&inBuffer[0], blockSize);
+                progress.inputRead(0);
+              }
+              memory.add(common::MemoryComponent::BLOCKS_IN_FLIGHT, n);
 
               const int ourBlock = blockToRead;
               ++blockToRead;
+              progress.blocksRead(blockToRead);
+
+              const auto alignBlock = [&](const align::InsertSizeParameters& insertSizeParameters) {
+                common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+                const common::TraceScope                            trace(common::TraceSpan::ALIGN, ourBlock);
+                //    std::cerr << "read n:" << n << " end: " << std::string(buffer, buffer + n) << std::endl;
+                boost::iostreams::filtering_istream istrm;
+                istrm.push(boost::iostreams::basic_array_source<char>{&inBuffer[0], &inBuffer[0] + n});
+                records.clear();
 
-              while (blockToGetInsertSizes != ourBlock) {
-                common::CPU_THREADS().waitForChange(lock);
+                alignSingleInput<ReadTransformer, Tokenizer>(
+                    insertSizeParameters,
+                    options,
+                    istrm,
+                    aligner,
+                    alignmentCache,
+                    singlePicker,
+                    pairBuilder,
+                    alignmentPairs,
+                    alignments,
+                    [&](const sequences::Read& r, const align::Alignment& a) { records.append(r, a); });
+              };
+
+              // align speculatively with the latest known parameters, without waiting for the
+              // insert size statistics that might need the results of the blocks in flight
+              {
+                const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                while (options.mapperNumThreads_ == cpuThreads || blockToAlign != ourBlock) {
+                  common::CPU_THREADS().waitForChange(lock);
+                }
+              }
+              ++cpuThreads;
+              ++blockToAlign;
+              common::CPU_THREADS().notify_all();
+              const align::InsertSizeParameters speculativeParameters = latestInsertSizeParameters;
+              const auto                        alignStart            = std::chrono::steady_clock::now();
+              aligner.setSlowReadPending(&speculativeSlowReads);
+              alignBlock(speculativeParameters);
+              aligner.setSlowReadPending(nullptr);
+              auto alignTime = std::chrono::steady_clock::now() - alignStart;
+              --cpuThreads;
+              common::CPU_THREADS().notify_all();
+
+              {
+                const common::TraceScope trace(common::TraceSpan::INSERT_SIZE_WAIT, ourBlock);
+                while (blockToGetInsertSizes != ourBlock) {
+                  common::CPU_THREADS().waitForChange(lock);
+                }
               }
 
               align::InsertSizeParameters insertSizeParameters;
@@ -303,93 +443,117 @@ void parseSingleInput(
                 // sending paired data to readgroup_insert_stats is only allowed if it is treated as paired
                 // data. Else, the sent and received counts will mismatch and the whole thing gets stuck
                 common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
+                const common::TraceScope                            trace(common::TraceSpan::INSERT_SIZES, ourBlock);
                 boost::iostreams::filtering_istream                 istrm;
                 istrm.push(boost::iostreams::basic_array_source<char>{&inBuffer[0], &inBuffer[0] + n});
                 insertSizeParameters =
                     requestInsertSizeInfo<Tokenizer>(options, insertSizeDistribution, istrm);
               }
               assert(blockToGetInsertSizes == ourBlock);
+              latestInsertSizeParameters = insertSizeParameters;
+              if (options.interleaved_) {
+                progress.insertSizesChanged(insertSizeParameters);
+              }
               ++blockToGetInsertSizes;
               common::CPU_THREADS().notify_all();
 
-              while (options.mapperNumThreads_ == cpuThreads || blockToAlign != ourBlock) {
-                common::CPU_THREADS().waitForChange(lock);
+              // reconcile: the output is identical to aligning with the actual parameters
+              if (speculativeParameters == insertSizeParameters) {
+                ++speculationHits;
+              } else {
+                ++speculationMisses;
+                speculativeSlowReads.clear();
+                {
+                  const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                  while (options.mapperNumThreads_ == cpuThreads) {
+                    common::CPU_THREADS().waitForChange(lock);
+                  }
+                }
+                ++cpuThreads;
+                const auto realignStart = std::chrono::steady_clock::now();
+                alignBlock(insertSizeParameters);
+                alignTime += std::chrono::steady_clock::now() - realignStart;
+                --cpuThreads;
+                common::CPU_THREADS().notify_all();
+              }
+
+              // format the output and count the metrics once, from the final records of the block
+              {
+                const common::TraceScope trace(common::TraceSpan::CPU_WAIT, ourBlock);
+                while (options.mapperNumThreads_ == cpuThreads) {
+                  common::CPU_THREADS().waitForChange(lock);
+                }
               }
               ++cpuThreads;
-              ++blockToAlign;
-              common::CPU_THREADS().notify_all();
               {
                 common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
-                //    std::cerr << "read n:" << n << " end: " << std::string(buffer, buffer + n) << std::endl;
-                boost::iostreams::filtering_istream istrm;
-                istrm.push(boost::iostreams::basic_array_source<char>{&inBuffer[0], &inBuffer[0] + n});
-                outBuffer.clear();
+                const common::StageTimer                            timer(common::Stage::ENCODE);
+                const common::TraceScope                            trace(common::TraceSpan::ENCODE, ourBlock);
+                const auto encodeStart = std::chrono::steady_clock::now();
+                if (slowReadLog) {
+                  slowReadLog->record(speculativeSlowReads);
+                }
                 tmpBuffer.clear();
-
-                alignSingleInput<ReadTransformer, Tokenizer>(
-                    insertSizeParameters,
-                    options,
-                    istrm,
-                    aligner,
-                    singlePicker,
-                    pairBuilder,
-                    [&](const sequences::Read& r, const align::Alignment& a) {
-                      sam.generateRecord(ostrm, r, a, options.rgid_) << "\n";
-
-                      const auto before = outBuffer.size();
-                      outBuffer.resize(before + sequences::SerializedRead::getByteSize(r));
-                      const auto before2 = outBuffer.size();
-                      outBuffer.resize(before2 + align::SerializedAlignment::getByteSize(a));
-
-                      // resize can invalidate references...
-                      sequences::SerializedRead& sr =
-                          *reinterpret_cast<sequences::SerializedRead*>(&outBuffer.front() + before);
-                      sr << r;
-
-                      align::SerializedAlignment& sa =
-                          *reinterpret_cast<align::SerializedAlignment*>(&outBuffer.front() + before2);
-                      sa << a;
-
-                      mappingMetricsLocal.addRecord(sa, sr);
-                    });
+                uint64_t reads = 0;
+                records.forEach([&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) {
+                  mappingMetricsLocal.addRecord(a, r);
+                  encoder.encode(ostrm, r, a);
+                  reads += !a.isSecondaryAlignment() && !a.isSupplementaryAlignment();
+                });
                 ostrm.flush();
+                alignTime += std::chrono::steady_clock::now() - encodeStart;
+                progressLocal.reads.fetch_add(reads, std::memory_order_relaxed);
               }
-
               --cpuThreads;
               common::CPU_THREADS().notify_all();
 
-              if (options.preserveMapAlignOrder_) {
-                while (blockToStore != ourBlock) {
-                  common::CPU_THREADS().waitForChange(lock);
-                }
-              } else {
-                while (-1 != blockToStore) {
-                  common::CPU_THREADS().waitForChange(lock);
+              const std::size_t blockBytes = n + tmpBuffer.size() + records.getByteSize();
+              memory.add(common::MemoryComponent::BLOCKS_IN_FLIGHT, blockBytes - n);
+              blockSizeController.blockAligned(
+                  n,
+                  blockBytes,
+                  std::chrono::duration_cast<std::chrono::duration<double>>(alignTime).count(),
+                  options.mapperNumThreads_ - cpuThreads,
+                  blockToRead - blocksStored);
+
+              {
+                const common::TraceScope trace(common::TraceSpan::ORDERING_WAIT, ourBlock);
+                if (options.preserveMapAlignOrder_) {
+                  while (blockToStore != ourBlock) {
+                    common::CPU_THREADS().waitForChange(lock);
+                  }
+                } else {
+                  while (-1 != blockToStore) {
+                    common::CPU_THREADS().waitForChange(lock);
+                  }
+                  blockToStore = ourBlock;
                 }
-                blockToStore = ourBlock;
               }
 
               {
                 common::unlock_guard<common::ThreadPool::lock_type> unlock(lock);
-                for (auto it = outBuffer.begin(); outBuffer.end() != it;) {
-                  char*                            p = &*it;
-                  const sequences::SerializedRead* pRead =
-                      reinterpret_cast<const sequences::SerializedRead*>(p);
-                  it += pRead->getByteSize();
-                  p = &*it;
-                  const align::SerializedAlignment* pAlignment =
-                      reinterpret_cast<const align::SerializedAlignment*>(p);
-                  it += pAlignment->getByteSize();
-                  // sam.generateRecord(os, *pRead, *pAlignment, options.rgid_) << "\n";
-                  insertSizeDistribution.add(*pAlignment, *pRead);
-                }
-                if (!os.write(&tmpBuffer.front(), tmpBuffer.size())) {
-                  throw std::logic_error(
-                      std::string("Error writing output stream. Error: ") + strerror(errno));
+                const common::StageTimer                            timer(common::Stage::STORE);
+                const common::TraceScope                            trace(common::TraceSpan::STORE, ourBlock);
+                // the samples must reach the insert size statistics in the order of the input
+                if (insertSizeDistribution.isSamplingEnabled()) {
+                  records.forEach([&](const sequences::SerializedRead& r, const align::SerializedAlignment& a) {
+                    insertSizeDistribution.add(a, r);
+                  });
                 }
+                writer.write(tmpBuffer);
               }
 
+              memory.add(common::MemoryComponent::BLOCKS_IN_FLIGHT, -int64_t(blockBytes));
+              memory.set(common::MemoryComponent::OUTPUT_QUEUE, writer.getQueuedBytes());
+              const std::size_t alignerBytes = sizeof(aligner) + aligner.getSmithWatermanProfileBytes() +
+                                               alignmentCache.getBytes();
+              memory.add(common::MemoryComponent::WORKERS, int64_t(alignerBytes) - int64_t(workerBytes));
+              workerBytes    = alignerBytes;
+              lastBlockBytes = blockBytes;
+
               assert(ourBlock == blockToStore);
+              ++blocksStored;
+              progress.blocksStored(blocksStored);
               if (options.preserveMapAlignOrder_) {
                 ++blockToStore;
               } else {
@@ -397,8 +561,14 @@ void parseSingleInput(
               }
               common::CPU_THREADS().notify_all();
             }
+
+            smithWatermanSkipped += aligner.getSmithWatermanSkipped();
+            alignmentCacheStats += alignmentCache.getStats();
+            mapperStats += aligner.getMapperStats();
+            memory.add(common::MemoryComponent::WORKERS, -int64_t(workerBytes));
           },
           options.mapperNumThreads_);
+  progress.stop();
 
   // aggregate and print mapping metrics
   for (int ii = 0; ii < mappingMetricsVector.size(); ii++) {
@@ -406,10 +576,27 @@ void parseSingleInput(
   }
 
   mappingMetricsGlobal.printStats(std::chrono::system_clock::now() - timeStart);
+  std::cerr << "Smith-Waterman alignments avoided: " << smithWatermanSkipped << std::endl;
+  if (options.readCacheEntries_) {
+    std::cerr << "Read cache: " << alignmentCacheStats << std::endl;
+  }
+  std::cerr << "Blocks aligned with speculative insert size parameters: " << speculationHits
+            << " kept, " << speculationMisses << " realigned" << std::endl;
+  std::cerr << "Final block size: " << blockSizeController.getBlockSize() << " bytes after "
+            << blockSizeController.getChanges() << " changes" << std::endl;
+  writer.close();
+  memory.set(common::MemoryComponent::OUTPUT_QUEUE, 0);
+  std::cerr << "Output writer: " << writer << std::endl;
+  if (memory.getLimit()) {
+    std::cerr << "Memory limit: reading waited " << memoryWaits << " times for the blocks in flight" << std::endl;
+  }
 
   insertSizeDistribution.forceInitDoneSending();
   if (options.interleaved_) {
     std::cerr << insertSizeDistribution << std::endl;
+    if (!options.peStatsOut_.empty()) {
+      insertSizeDistribution.saveModel(options.peStatsOut_, options.rgid_);
+    }
   }
 }
 
@@ -428,7 +615,10 @@ void parseSingleInput(
     const options::DragenOsOptions& options,
     const reference::ReferenceDir7& referenceDir,
     const reference::Hashtable&     hashtable,
-    std::ostream&                   mappingMetricsLogStream)
+    std::ostream&                   mappingMetricsLogStream,
+    map::MapperStats&               mapperStats,
+    common::MemoryAccounting&       memory,
+    align::SlowReadLog*             slowReadLog)
 {
   std::cerr << "Running fastq workflow on " << options.mapperNumThreads_ << " threads. System supports "
             << std::thread::hardware_concurrency() << " threads." << std::endl;
@@ -444,10 +634,28 @@ void parseSingleInput(
   try {
     if (isBam(options.inputFile1_)) {
       parseSingleInput<io::BamToReadTransformer, bam::Tokenizer, bam::BamBlockReader>(
-          input, os, options, referenceDir, hashtable, mappingMetricsLogStream);
+          file,
+          input,
+          os,
+          options,
+          referenceDir,
+          hashtable,
+          mappingMetricsLogStream,
+          mapperStats,
+          memory,
+          slowReadLog);
     } else {
       parseSingleInput<io::FastqToReadTransformer, fastq::Tokenizer, fastq::FastqBlockReader>(
-          input, os, options, referenceDir, hashtable, mappingMetricsLogStream);
+          file,
+          input,
+          os,
+          options,
+          referenceDir,
+          hashtable,
+          mappingMetricsLogStream,
+          mapperStats,
+          memory,
+          slowReadLog);
     }
   } catch (boost::iostreams::gzip_error& e) {
     BOOST_THROW_EXCEPTION(std::runtime_error(
@@ -466,6 +674,26 @@ void input2Sam(const dragenos::options::DragenOsOptions& options)
 
   DRAGEN_OS_THREAD_CERR << "Version: " << common::Version::string() << std::endl;
   DRAGEN_OS_THREAD_CERR << "argc: " << options.argc() << " argv: " << options.getCommandLine() << std::endl;
+  restrictCpus(options);
+  if (options.profileCounters_) {
+    common::Profiler::instance().enable(common::PerfCounters::getHardwareEvents());
+    if (!common::Profiler::instance().getCountersError().empty()) {
+      std::cerr << "WARNING: profiling without the hardware counters: "
+                << common::Profiler::instance().getCountersError() << std::endl;
+    }
+  } else if (options.profile_) {
+    common::Profiler::instance().enable();
+  }
+  // created upfront, not to find out that it can't be after the whole run
+  std::ofstream traceStream;
+  if (!options.traceFile_.empty()) {
+    traceStream.open(options.traceFile_);
+    if (!traceStream) {
+      BOOST_THROW_EXCEPTION(common::IoException(
+          errno, std::string("Failed to create trace file: ") + options.traceFile_ + ": " + strerror(errno)));
+    }
+    common::Tracer::instance().enable(options.traceEvents_);
+  }
 
   const reference::ReferenceDir7 referenceDir(
       options.refDir_, options.mmapReference_, options.loadReference_);
@@ -485,6 +713,27 @@ void input2Sam(const dragenos::options::DragenOsOptions& options)
   const reference::Hashtable hashtable(
       &referenceDir.getHashtableConfig(), referenceDir.getHashtableData(), referenceDir.getExtendTableData());
 
+  common::MemoryAccounting memory(options.memoryLimit_);
+  memory.addRegion(
+      common::MemoryComponent::HASH_TABLE,
+      referenceDir.getHashtableData(),
+      referenceDir.getHashtableConfig().getHashtableBytes());
+  if (referenceDir.getExtendTableData()) {
+    memory.addRegion(
+        common::MemoryComponent::EXTEND_TABLE,
+        referenceDir.getExtendTableData(),
+        referenceDir.getHashtableConfig().getExtendTableBytes());
+  }
+  memory.addRegion(
+      common::MemoryComponent::REFERENCE,
+      referenceDir.getReferenceSequence().getData(),
+      referenceDir.getReferenceSequence().getSize());
+  if (memory.isOverLimit(0)) {
+    std::cerr << "WARNING: memory-limit " << options.memoryLimit_ << " is below the " << memory.getTotal()
+              << " bytes of the reference and hash table: aligning with the smallest blocks, one at a time"
+              << std::endl;
+  }
+
   std::ofstream os;
   namespace bfs = boost::filesystem;
   if (!options.outputDirectory_.empty()) {
@@ -530,15 +779,31 @@ void input2Sam(const dragenos::options::DragenOsOptions& options)
     }
   }
 
+  std::ofstream                       slowReadStream;
+  std::unique_ptr<align::SlowReadLog> slowReadLog;
+  if (!options.slowReadLog_.empty()) {
+    slowReadStream.open(options.slowReadLog_);
+    if (!slowReadStream) {
+      BOOST_THROW_EXCEPTION(common::IoException(
+          errno,
+          std::string("Failed to create slow read log: ") + options.slowReadLog_ + ": " + strerror(errno)));
+    }
+    slowReadLog.reset(new align::SlowReadLog(slowReadStream, options.slowReadThreshold_ * 1000));
+  }
+
+  map::MapperStats mapperStats;
   if (options.inputFile2_.empty()) {
     parseSingleInput(
         samFile,
         options,
         referenceDir,
         hashtable,
-        mappingMetricsLogStream.is_open() ? mappingMetricsLogStream : std::cerr);
+        mappingMetricsLogStream.is_open() ? mappingMetricsLogStream : std::cerr,
+        mapperStats,
+        memory,
+        slowReadLog.get());
   } else {
-    DualFastq2SamWorkflow workflow(options, referenceDir, hashtable);
+    DualFastq2SamWorkflow workflow(options, referenceDir, hashtable, memory, slowReadLog.get());
     std::ofstream         insertSizeDistributionLogStream;
 
     if (!options.outputDirectory_.empty()) {
@@ -568,6 +833,56 @@ void input2Sam(const dragenos::options::DragenOsOptions& options)
         samFile,
         insertSizeDistributionLogStream.is_open() ? insertSizeDistributionLogStream : std::cerr,
         mappingMetricsLogStream.is_open() ? mappingMetricsLogStream : std::cerr);
+    mapperStats = workflow.getMapperStats();
+  }
+  memory.report(std::cerr);
+  if (slowReadLog) {
+    std::cerr << "Slow reads: " << slowReadLog->getCount() << " took at least " << options.slowReadThreshold_
+              << " us to align, recorded into " << options.slowReadLog_ << std::endl;
+  }
+
+  if (!options.outputDirectory_.empty()) {
+    const auto filePath =
+        bfs::path(options.outputDirectory_) / (options.outputFilePrefix_ + ".mapper_stats.csv");
+    std::ofstream mapperStatsStream(filePath.c_str());
+    if (!mapperStatsStream) {
+      BOOST_THROW_EXCEPTION(common::IoException(
+          errno,
+          std::string("Failed to create mapper stats file: ") + filePath.string() + ": " + strerror(errno)));
+    }
+    mapperStats.write(mapperStatsStream);
+    if (options.verbose_) {
+      std::cerr << "INFO: writing mapper stats into " << filePath << std::endl;
+    }
+  }
+
+  if (common::Profiler::instance().isEnabled()) {
+    if (options.outputDirectory_.empty()) {
+      common::Profiler::instance().report(std::cerr);
+    } else {
+      const auto    filePath = bfs::path(options.outputDirectory_) / (options.outputFilePrefix_ + ".perf.json");
+      std::ofstream perfStream(filePath.c_str());
+      if (!perfStream) {
+        BOOST_THROW_EXCEPTION(common::IoException(
+            errno, std::string("Failed to create profile file: ") + filePath.string() + ": " + strerror(errno)));
+      }
+      common::Profiler::instance().report(perfStream);
+      if (options.verbose_) {
+        std::cerr << "INFO: writing the profile into " << filePath << std::endl;
+      }
+    }
+  }
+
+  if (traceStream.is_open()) {
+    common::Tracer::instance().write(traceStream);
+    traceStream.close();
+    if (!traceStream) {
+      BOOST_THROW_EXCEPTION(common::IoException(
+          errno, std::string("Failed to write trace file: ") + options.traceFile_ + ": " + strerror(errno)));
+    }
+    if (options.verbose_) {
+      std::cerr << "INFO: writing the trace into " << options.traceFile_ << std::endl;
+    }
   }
 }
 
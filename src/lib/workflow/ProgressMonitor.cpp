@@ -0,0 +1,249 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "workflow/ProgressMonitor.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+namespace {
+
+/// H:MM:SS
+std::string formatDuration(const double seconds)
+{
+  const uint64_t     total = std::round(seconds);
+  std::ostringstream os;
+  os << total / 3600 << ':' << std::setfill('0') << std::setw(2) << total / 60 % 60 << ':' << std::setw(2)
+     << total % 60;
+  return os.str();
+}
+
+const char* const INSERT_SIZE_STATES[] = {"none", "sampling", "initialized"};
+
+}  // namespace
+
+ProgressMonitor::ProgressMonitor(
+    const double                    intervalSeconds,
+    const std::string&              statusFile,
+    const std::size_t               workers,
+    const common::AsyncWriter*      writer,
+    const common::MemoryAccounting* memory,
+    std::ostream&                   log)
+  : interval_(intervalSeconds),
+    statusFile_(statusFile),
+    workerCount_(workers),
+    workers_(new WorkerCounters[workers]),
+    writer_(writer),
+    memory_(memory),
+    log_(log),
+    start_(std::chrono::steady_clock::now()),
+    lastTime_(start_)
+{
+}
+
+ProgressMonitor::~ProgressMonitor()
+{
+  stop();
+}
+
+void ProgressMonitor::addInput(const std::string& path, std::istream& file)
+{
+  struct stat st;
+  // pipes and other streams have no size to compare with
+  const uint64_t fileBytes = (0 == stat(path.c_str(), &st) && S_ISREG(st.st_mode)) ? st.st_size : 0;
+  inputs_.emplace_back(new Input(path, file, fileBytes));
+}
+
+void ProgressMonitor::start()
+{
+  start_    = std::chrono::steady_clock::now();
+  lastTime_ = start_;
+  if (0.0 < interval_.count() && !thread_.joinable()) {
+    stopping_ = false;
+    thread_   = std::thread(&ProgressMonitor::run, this);
+  }
+}
+
+void ProgressMonitor::stop()
+{
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    stopped_.notify_all();
+    thread_.join();
+  }
+}
+
+void ProgressMonitor::inputRead(const std::size_t input)
+{
+  Input&               in       = *inputs_.at(input);
+  const std::streamoff position = in.file->tellg();
+  if (0 <= position) {
+    in.bytes.store(position, std::memory_order_relaxed);
+  }
+}
+
+void ProgressMonitor::insertSizesChanged(const align::InsertSizeParameters& parameters)
+{
+  insertSizeMean_.store(parameters.mean_, std::memory_order_relaxed);
+  insertSizeMin_.store(parameters.min_, std::memory_order_relaxed);
+  insertSizeMax_.store(parameters.max_, std::memory_order_relaxed);
+  insertSizeState_.store(parameters.isInitDone() ? 2 : 1, std::memory_order_relaxed);
+}
+
+ProgressMonitor::Status ProgressMonitor::sample(const std::chrono::steady_clock::time_point now)
+{
+  Status status;
+  status.seconds = std::chrono::duration<double>(now - start_).count();
+  for (std::size_t i = 0; workerCount_ != i; ++i) {
+    status.reads += workers_[i].reads.load(std::memory_order_relaxed);
+  }
+  const double intervalSeconds = std::chrono::duration<double>(now - lastTime_).count();
+  if (0.0 < intervalSeconds) {
+    status.readsPerSecond = (status.reads - lastReads_) / intervalSeconds;
+  }
+  lastTime_  = now;
+  lastReads_ = status.reads;
+
+  bool sizeKnown = !inputs_.empty();
+  for (const auto& input : inputs_) {
+    status.inputBytes += input->bytes.load(std::memory_order_relaxed);
+    status.inputFileBytes += input->fileBytes;
+    sizeKnown = sizeKnown && input->fileBytes;
+  }
+  if (!sizeKnown) {
+    status.inputFileBytes = 0;
+  }
+  // the input is consumed at the average rate since the start
+  if (status.inputFileBytes && status.inputBytes && 0.0 < status.seconds) {
+    const uint64_t left = status.inputFileBytes - std::min(status.inputFileBytes, status.inputBytes);
+    status.etaSeconds   = left / (status.inputBytes / status.seconds);
+  }
+
+  status.blocksRead       = blocksRead_.load(std::memory_order_relaxed);
+  status.blocksStored     = blocksStored_.load(std::memory_order_relaxed);
+  status.outputQueueBytes = writer_ ? writer_->getQueuedBytes() : 0;
+  if (memory_) {
+    status.memoryBytes         = memory_->getTotal();
+    status.blocksInFlightBytes = memory_->get(common::MemoryComponent::BLOCKS_IN_FLIGHT);
+  }
+  const auto process  = common::MemoryAccounting::getProcessMemory();
+  status.rssBytes     = process.rss;
+  status.peakRssBytes = process.peakRss;
+  status.insertSizeState  = INSERT_SIZE_STATES[insertSizeState_.load(std::memory_order_relaxed)];
+  status.insertSizeMean   = insertSizeMean_.load(std::memory_order_relaxed);
+  status.insertSizeMin    = insertSizeMin_.load(std::memory_order_relaxed);
+  status.insertSizeMax    = insertSizeMax_.load(std::memory_order_relaxed);
+  return status;
+}
+
+void ProgressMonitor::writeLine(std::ostream& os, const Status& status)
+{
+  std::ostringstream line;
+  line << "Progress: " << formatDuration(status.seconds) << " elapsed, " << status.reads << " reads, "
+       << std::fixed << std::setprecision(0) << status.readsPerSecond << " reads/s, input ";
+  if (status.inputFileBytes) {
+    line << std::setprecision(1) << 100.0 * status.inputBytes / status.inputFileBytes << "% of "
+         << status.inputFileBytes / 1024 / 1024 << " MB, ETA "
+         << (0.0 > status.etaSeconds ? std::string("unknown") : formatDuration(status.etaSeconds));
+  } else {
+    line << status.inputBytes / 1024 / 1024 << " MB";
+  }
+  line << ", " << status.blocksRead - status.blocksStored << " blocks in flight ("
+       << status.blocksInFlightBytes / 1024 / 1024 << " MB), output queue " << status.outputQueueBytes / 1024 / 1024
+       << " MB, memory " << status.memoryBytes / 1024 / 1024 << " MB accounted, RSS "
+       << status.rssBytes / 1024 / 1024 << " MB (peak " << status.peakRssBytes / 1024 / 1024
+       << " MB), insert size " << status.insertSizeState;
+  if ("initialized" == status.insertSizeState) {
+    line << " mean " << status.insertSizeMean << " [" << status.insertSizeMin << ", " << status.insertSizeMax
+         << "]";
+  }
+  // a single write keeps the line in one piece among the logs of the other threads
+  line << '\n';
+  os << line.str() << std::flush;
+}
+
+void ProgressMonitor::writeJson(std::ostream& os, const Status& status)
+{
+  os << "{\n"
+     << "  \"seconds\": " << status.seconds << ",\n"
+     << "  \"reads\": " << status.reads << ",\n"
+     << "  \"readsPerSecond\": " << status.readsPerSecond << ",\n"
+     << "  \"inputBytes\": " << status.inputBytes << ",\n"
+     << "  \"inputFileBytes\": " << status.inputFileBytes << ",\n"
+     << "  \"etaSeconds\": ";
+  if (0.0 > status.etaSeconds) {
+    os << "null";
+  } else {
+    os << status.etaSeconds;
+  }
+  os << ",\n"
+     << "  \"blocksRead\": " << status.blocksRead << ",\n"
+     << "  \"blocksStored\": " << status.blocksStored << ",\n"
+     << "  \"outputQueueBytes\": " << status.outputQueueBytes << ",\n"
+     << "  \"memory\": {\"accountedBytes\": " << status.memoryBytes
+     << ", \"blocksInFlightBytes\": " << status.blocksInFlightBytes << ", \"rssBytes\": " << status.rssBytes
+     << ", \"peakRssBytes\": " << status.peakRssBytes << "},\n"
+     << "  \"insertSize\": {\"state\": \"" << status.insertSizeState << "\", \"mean\": " << status.insertSizeMean
+     << ", \"min\": " << status.insertSizeMin << ", \"max\": " << status.insertSizeMax << "}\n"
+     << "}\n";
+}
+
+void ProgressMonitor::writeStatusFile(const Status& status) const
+{
+  const std::string tmp = statusFile_ + ".tmp";
+  {
+    std::ofstream os(tmp);
+    writeJson(os, status);
+    os.close();
+    if (!os) {
+      log_ << "WARNING: failed to write the progress into " << tmp << ": " << strerror(errno) << std::endl;
+      return;
+    }
+  }
+  if (std::rename(tmp.c_str(), statusFile_.c_str())) {
+    log_ << "WARNING: failed to rename " << tmp << " to " << statusFile_ << ": " << strerror(errno)
+         << std::endl;
+  }
+}
+
+void ProgressMonitor::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_.wait_for(lock, interval_, [this]() { return stopping_; })) {
+    lock.unlock();
+    const Status status = sample(std::chrono::steady_clock::now());
+    writeLine(log_, status);
+    if (!statusFile_.empty()) {
+      writeStatusFile(status);
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace workflow
+}  // namespace dragenos
@@ -0,0 +1,124 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <tuple>
+
+#include "workflow/ThreadPlacement.hpp"
+
+namespace dragenos {
+namespace workflow {
+
+void restrictCpus(const options::DragenOsOptions& options)
+{
+  if (!options.cpuList_.empty()) {
+    common::setAllowedCpus(common::parseCpuList(options.cpuList_));
+    std::cerr << "Running on cpus: " << options.cpuList_ << std::endl;
+  }
+}
+
+std::pair<std::vector<int>, std::vector<int>> splitCpus(
+    const std::vector<common::LogicalCpu>& placement, const std::size_t alignerCount, const std::size_t ioCoreCount)
+{
+  std::pair<std::vector<int>, std::vector<int>> ret;
+  std::set<std::pair<int, int>>                 alignerCores;
+  for (std::size_t i = 0; std::min(alignerCount, placement.size()) != i; ++i) {
+    ret.first.push_back(placement[i].cpu);
+    alignerCores.insert(std::make_pair(placement[i].package, placement[i].core));
+  }
+  std::set<std::pair<int, int>> ioCores;
+  for (const common::LogicalCpu& c : placement) {
+    const std::pair<int, int> core(c.package, c.core);
+    if (!alignerCores.count(core) && (ioCores.count(core) || ioCoreCount > ioCores.size())) {
+      ioCores.insert(core);
+      ret.second.push_back(c.cpu);
+    }
+  }
+  return ret;
+}
+
+ThreadPlacement::ThreadPlacement(
+    const options::DragenOsOptions& options, common::ThreadPool& pool, common::AsyncWriter& writer)
+  : pool_(pool)
+{
+  if ("none" == options.pinThreads_) {
+    return;
+  }
+  const common::CpuTopology             topology(common::getAllowedCpus());
+  const std::vector<common::LogicalCpu> placement = topology.getPlacement("spread" == options.pinThreads_);
+  // one cpu for each of the workers that can align at the same time
+  std::tie(alignerCpus_, ioCpus_) =
+      splitCpus(placement, std::max(1, options.mapperNumThreads_), IO_CORES);
+  callerCpus_ = common::getThreadCpus(pthread_self());
+  pool_.setCpus(alignerCpus_);
+  common::setThreadCpus(pthread_self(), alignerCpus_);
+  writer.setCpus(ioCpus_.empty() ? alignerCpus_ : ioCpus_);
+
+  const auto print = [&placement](const std::vector<int>& cpus) {
+    for (const int cpu : cpus) {
+      std::cerr << " "
+                << *std::find_if(placement.begin(), placement.end(), [cpu](const common::LogicalCpu& c) {
+                     return cpu == c.cpu;
+                   });
+    }
+  };
+  std::cerr << "Thread placement (" << options.pinThreads_ << " over " << topology.getCoreCount()
+            << " cores): " << pool.size() << " workers on";
+  print(alignerCpus_);
+  if (ioCpus_.empty()) {
+    std::cerr << ", input and output on the same cpus: no physical core left for them";
+  } else {
+    std::cerr << ", input and output on";
+    print(ioCpus_);
+  }
+  std::cerr << std::endl;
+}
+
+ThreadPlacement::~ThreadPlacement()
+{
+  if (callerCpus_.empty()) {
+    return;
+  }
+  try {
+    pool_.setCpus(callerCpus_);
+    common::setThreadCpus(pthread_self(), callerCpus_);
+  } catch (const std::exception& e) {
+    std::cerr << "WARNING: failed to restore the cpus of the threads: " << e.what() << std::endl;
+  }
+}
+
+ThreadPlacement::IoScope::IoScope(const ThreadPlacement& placement) : placement_(placement)
+{
+  if (!placement_.ioCpus_.empty()) {
+    common::setThreadCpus(pthread_self(), placement_.ioCpus_);
+  }
+}
+
+ThreadPlacement::IoScope::~IoScope()
+{
+  if (placement_.ioCpus_.empty()) {
+    return;
+  }
+  try {
+    common::setThreadCpus(pthread_self(), placement_.alignerCpus_);
+  } catch (const std::exception& e) {
+    std::cerr << "WARNING: failed to move the thread back to the cpus of the aligners: " << e.what()
+              << std::endl;
+  }
+}
+
+}  // namespace workflow
+}  // namespace dragenos
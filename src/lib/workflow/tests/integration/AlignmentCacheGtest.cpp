@@ -0,0 +1,125 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "workflow/AlignmentCache.hpp"
+
+using namespace dragenos;
+typedef sequences::Read             Read;
+typedef sequences::ReadPair         ReadPair;
+typedef Read::Name                  Name;
+typedef Read::Bases                 Bases;
+typedef Read::Qualities             Qualities;
+typedef align::Alignment            Alignment;
+typedef align::InsertSizeParameters InsertSizeParameters;
+typedef workflow::AlignmentCache    AlignmentCache;
+
+struct Stored {
+  const Read* read;
+  Alignment   alignment;
+  int         saPosition;
+};
+
+static void initPair(ReadPair& pair, const char* name)
+{
+  pair[0].init(Name(name, name + 2), Bases({1, 2, 4, 8}), Qualities({30, 30, 30, 30}), 0, 0);
+  pair[1].init(Name(name, name + 2), Bases({8, 4, 2}), Qualities({20, 20, 20}), 0, 1);
+}
+
+TEST(AlignmentCache, Disabled)
+{
+  AlignmentCache cache(0);
+  ASSERT_FALSE(cache.isEnabled());
+}
+
+TEST(AlignmentCache, ReplayPair)
+{
+  AlignmentCache             cache(16);
+  const InsertSizeParameters parameters(
+      1, 100, 50, 1, 200, uint16_t(7), InsertSizeParameters::Orientation::pe_orient_fr_c, true);
+  std::vector<Stored>        stored;
+  const auto                 store = [&](const Read& read, const Alignment& a) {
+    stored.push_back(Stored{&read, a, a.getSa() ? a.getSa()->getPosition() : -1});
+  };
+
+  ReadPair first;
+  initPair(first, "r1");
+  ASSERT_TRUE(cache.isEnabled());
+  ASSERT_FALSE(cache.replay(parameters, first, store));
+
+  // supplementary of read 1 pointing to its primary, stored after it and changed in between
+  Alignment primary(Alignment::FIRST_IN_TEMPLATE);
+  primary.setPosition(100);
+  primary.setCigarOperations("4M");
+  Alignment supplementary(Alignment::SUPPLEMENTARY_ALIGNMENT);
+  supplementary.setPosition(500);
+  supplementary.setCigarOperations("2M2S");
+  supplementary.setSa(&primary);
+  cache.record(0, supplementary);
+  primary.setSa(&supplementary);
+  primary.setPosition(101);
+  cache.record(0, primary);
+  Alignment mate(Alignment::LAST_IN_TEMPLATE);
+  mate.setPosition(300);
+  mate.setCigarOperations("3M");
+  cache.record(1, mate);
+  cache.commit(false);
+
+  // same bases, another name
+  ReadPair second;
+  initPair(second, "r2");
+  ASSERT_TRUE(cache.replay(parameters, second, store));
+  ASSERT_EQ(3u, stored.size());
+  ASSERT_EQ(&second[0], stored[0].read);
+  ASSERT_EQ(500, stored[0].alignment.getPosition());
+  ASSERT_EQ(supplementary.getCigar(), stored[0].alignment.getCigar());
+  // the SA tag is the one of the first time
+  ASSERT_EQ(100, stored[0].saPosition);
+  ASSERT_EQ(&second[0], stored[1].read);
+  ASSERT_EQ(101, stored[1].alignment.getPosition());
+  ASSERT_EQ(500, stored[1].saPosition);
+  ASSERT_EQ(&second[1], stored[2].read);
+  ASSERT_EQ(Alignment::LAST_IN_TEMPLATE, stored[2].alignment.getFlags());
+  ASSERT_EQ(-1, stored[2].saPosition);
+
+  // other insert size parameters
+  InsertSizeParameters other = parameters;
+  other.max_                 = 101;
+  ASSERT_FALSE(cache.replay(other, second, store));
+  cache.commit(false);
+  // other mate
+  second[1].init(Name({'r', '3'}), Bases({8, 4, 1}), Qualities({20, 20, 20}), 0, 1);
+  ASSERT_FALSE(cache.replay(parameters, second, store));
+  cache.commit(false);
+  // the read alone
+  ASSERT_FALSE(cache.replay(second[0], store));
+  ASSERT_EQ(3u, stored.size());
+
+  ASSERT_EQ(5u, cache.getStats().lookups);
+  ASSERT_EQ(1u, cache.getStats().hits);
+}
+
+TEST(AlignmentCache, DependsOnReadName)
+{
+  AlignmentCache      cache(16);
+  std::vector<Stored> stored;
+  const auto          store = [&](const Read& read, const Alignment& a) {
+    stored.push_back(Stored{&read, a, -1});
+  };
+  Read read;
+  read.init(Name({'r'}), Bases({1, 1, 2}), Qualities({30, 30, 30}), 0, 0);
+
+  ASSERT_FALSE(cache.replay(read, store));
+  cache.record(0, Alignment(Alignment::UNMAPPED));
+  cache.commit(true);
+  ASSERT_FALSE(cache.replay(read, store));
+  cache.record(0, Alignment(Alignment::UNMAPPED));
+  cache.commit(false);
+  ASSERT_TRUE(cache.replay(read, store));
+  ASSERT_EQ(1u, stored.size());
+  ASSERT_EQ(Alignment::UNMAPPED, stored[0].alignment.getFlags());
+
+  ASSERT_EQ(3u, cache.getStats().lookups);
+  ASSERT_EQ(1u, cache.getStats().hits);
+  ASSERT_EQ(1u, cache.getStats().uncacheable);
+}
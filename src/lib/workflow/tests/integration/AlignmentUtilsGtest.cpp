@@ -0,0 +1,221 @@
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "workflow/alignment/AlignmentUtils.hpp"
+
+using namespace dragenos;
+typedef sequences::Read  Read;
+typedef align::Alignment Alignment;
+
+namespace {
+
+/// what goes into the SAM record of an alignment, apart from the read
+struct Record {
+  uint64_t         id;
+  unsigned         readPosition;
+  short            reference;
+  int              position;
+  align::FlagType  flags;
+  std::string      cigar;
+  align::MapqType  mapq;
+  align::ScoreType xs;
+};
+
+std::ostream& operator<<(std::ostream& os, const Record& record)
+{
+  return os << "Record(" << record.id << "/" << record.readPosition << "," << record.reference << ":"
+            << record.position << "," << record.flags << "f," << record.cigar << "," << record.mapq << "mq,"
+            << record.xs << "xs)";
+}
+
+bool operator==(const Record& left, const Record& right)
+{
+  return left.id == right.id && left.readPosition == right.readPosition && left.reference == right.reference &&
+         left.position == right.position && left.flags == right.flags && left.cigar == right.cigar &&
+         left.mapq == right.mapq && left.xs == right.xs;
+}
+
+const std::size_t READ_LENGTH = 151;
+
+/**
+ ** \brief aligns simulated reads with the default options against the small fixture of data/
+ **
+ ** The fixture is a 20 kb sequence with repeats indexed with 21 base seeds. Only its compressed hash table
+ ** is available, which makes the setup a bit slow, so it is shared by all the tests.
+ **/
+class SmithWatermanSkip : public ::testing::Test {
+protected:
+  static std::unique_ptr<reference::ReferenceDir7> referenceDir_;
+  static std::unique_ptr<reference::Hashtable>     hashtable_;
+
+  const align::SimilarityScores similarity_;
+  const align::SinglePicker     singlePicker_;
+  std::mt19937                  generator_;
+  std::pair<uint64_t, uint64_t> range_;
+
+  SmithWatermanSkip()
+    : similarity_(1, -4),
+      singlePicker_(similarity_, 22, 8, 0, 0, 0, false, 50),
+      generator_(42)
+  {
+  }
+
+  static void SetUpTestCase()
+  {
+    // the sources are at src/lib/workflow/tests/integration
+    const auto dir =
+        boost::filesystem::path(__FILE__).parent_path() / "../../../../../data/small/small-20k-repeats.v8";
+    referenceDir_.reset(new reference::ReferenceDir7(dir, false, false));
+    hashtable_.reset(new reference::Hashtable(
+        &referenceDir_->getHashtableConfig(),
+        referenceDir_->getHashtableData(),
+        referenceDir_->getExtendTableData()));
+  }
+
+  static void TearDownTestCase()
+  {
+    hashtable_.reset();
+    referenceDir_.reset();
+  }
+
+  void SetUp() override
+  {
+    const auto& config = referenceDir_->getHashtableConfig();
+    range_             = config.getPositionRange(config.getSequences().front());
+  }
+
+  std::unique_ptr<align::Aligner> makeAligner(const bool skip) const
+  {
+    std::unique_ptr<align::Aligner> aligner(new align::Aligner(
+        *referenceDir_, *hashtable_, false, 0, similarity_, 7, 1, 5, 22, 50, 80, 4.0, true, false, 8));
+    aligner->setSmithWatermanSkip(skip);
+    return aligner;
+  }
+
+  std::vector<unsigned char> getBases(const uint64_t position, const std::size_t length)
+  {
+    std::vector<unsigned char> bases(length);
+    referenceDir_->getReferenceSequence().getBases(position, position + length, bases.data());
+    return bases;
+  }
+
+  uint64_t randomPosition(const std::size_t length)
+  {
+    return std::uniform_int_distribution<uint64_t>(range_.first, range_.second - length)(generator_);
+  }
+
+  /// every other read comes from the first of the three diverged copies of the region at 2000, 8000 and
+  /// 14000 in the fixture, where the alignments of the other copies can be skipped
+  uint64_t simulatedPosition(const uint64_t id, const std::size_t length)
+  {
+    return id % 2 ? randomPosition(length)
+                  : range_.first + std::uniform_int_distribution<uint64_t>(1900, 2600)(generator_);
+  }
+
+  /// reverse complement of 4 bit encoded bases
+  static Read::Bases reverseComplement(const Read::Bases& bases)
+  {
+    Read::Bases ret(bases.rbegin(), bases.rend());
+    for (auto& base : ret) {
+      base = ((base & 1) << 3) | ((base & 2) << 1) | ((base & 4) >> 1) | ((base & 8) >> 3);
+    }
+    return ret;
+  }
+
+  /**
+   ** \brief READ_LENGTH bases from the reference at the given position, changed according to the kind:
+   ** 0 exact, 1 mismatches, 2 insertion, 3 deletion, 4 chimera with another random position
+   **/
+  Read::Bases simulateBases(const uint64_t position, const unsigned kind)
+  {
+    Read::Bases bases;
+    switch (kind) {
+    case 2:
+      bases = getBases(position, READ_LENGTH - 2);
+      bases.insert(bases.begin() + READ_LENGTH / 2, {1, 8});
+      break;
+    case 3:
+      bases = getBases(position, READ_LENGTH + 3);
+      bases.erase(bases.begin() + READ_LENGTH / 2, bases.begin() + READ_LENGTH / 2 + 3);
+      break;
+    case 4: {
+      bases              = getBases(position, READ_LENGTH * 3 / 5);
+      const auto chimera = getBases(randomPosition(READ_LENGTH), READ_LENGTH - bases.size());
+      bases.insert(bases.end(), chimera.begin(), chimera.end());
+      break;
+    }
+    default:
+      bases = getBases(position, READ_LENGTH);
+    }
+    if (1 == kind) {
+      for (std::size_t i = 17; bases.size() > i; i += 41) {
+        bases[i] = 1 == bases[i] ? 2 : 1;
+      }
+    }
+    return bases;
+  }
+
+  static void initRead(Read& read, const uint64_t id, const unsigned readPosition, const Read::Bases& bases)
+  {
+    const std::string name = "r" + std::to_string(id);
+    read.init(
+        Read::Name(name.begin(), name.end()), bases, Read::Qualities(bases.size(), 30), id, readPosition);
+  }
+
+  static void store(std::vector<Record>& records, const Read& read, const Alignment& alignment)
+  {
+    std::ostringstream cigar;
+    cigar << alignment.getCigar();
+    records.push_back(Record{read.getId(),
+                             read.getPosition(),
+                             alignment.getReference(),
+                             alignment.getPosition(),
+                             alignment.getFlags(),
+                             cigar.str(),
+                             alignment.getMapq(),
+                             alignment.getXs()});
+  }
+};
+
+std::unique_ptr<reference::ReferenceDir7> SmithWatermanSkip::referenceDir_;
+std::unique_ptr<reference::Hashtable>     SmithWatermanSkip::hashtable_;
+
+}  // namespace
+
+TEST_F(SmithWatermanSkip, SingleEndedOutputUnchanged)
+{
+  const auto                 skipping = makeAligner(true);
+  const auto                 aligning = makeAligner(false);
+  align::Aligner::Alignments alignments;
+  std::vector<Record>        expected;
+  std::vector<Record>        actual;
+
+  Read read;
+  for (uint64_t id = 0; 1000 != id; ++id) {
+    const auto bases = simulateBases(simulatedPosition(id, READ_LENGTH * 2), id % 5);
+    initRead(read, id, 0, (id / 10) % 2 ? reverseComplement(bases) : bases);
+    workflow::alignment::alignAndStoreSingle(
+        read, *aligning, singlePicker_, alignments, [&](const Read& read, const Alignment& a) {
+          store(expected, read, a);
+        });
+    workflow::alignment::alignAndStoreSingle(
+        read, *skipping, singlePicker_, alignments, [&](const Read& read, const Alignment& a) {
+          store(actual, read, a);
+        });
+  }
+
+  ASSERT_EQ(0u, aligning->getSmithWatermanSkipped());
+  // or the test proves nothing
+  ASSERT_LT(0u, skipping->getSmithWatermanSkipped());
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0; expected.size() != i; ++i) {
+    ASSERT_EQ(expected[i], actual[i]) << "record " << i;
+  }
+}
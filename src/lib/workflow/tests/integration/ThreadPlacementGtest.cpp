@@ -0,0 +1,56 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "workflow/ThreadPlacement.hpp"
+
+using namespace dragenos;
+typedef common::LogicalCpu LogicalCpu;
+typedef std::vector<int>   Cpus;
+
+// 4 physical cores of one package with 2 SMT siblings each: cpus 0-3 and their siblings 4-7
+static const std::vector<LogicalCpu> SPREAD = {
+    {0, 0, 0}, {1, 0, 1}, {2, 0, 2}, {3, 0, 3}, {4, 0, 0}, {5, 0, 1}, {6, 0, 2}, {7, 0, 3}};
+static const std::vector<LogicalCpu> COMPACT = {
+    {0, 0, 0}, {4, 0, 0}, {1, 0, 1}, {5, 0, 1}, {2, 0, 2}, {6, 0, 2}, {3, 0, 3}, {7, 0, 3}};
+
+TEST(ThreadPlacement, SpreadLeavesCoresToTheIo)
+{
+  const auto split = workflow::splitCpus(SPREAD, 2, 2);
+  ASSERT_EQ(Cpus({0, 1}), split.first);
+  // both siblings of the two cores left
+  ASSERT_EQ(Cpus({2, 3, 6, 7}), split.second);
+}
+
+TEST(ThreadPlacement, SiblingsOfTheAlignersExcluded)
+{
+  const auto split = workflow::splitCpus(SPREAD, 5, 2);
+  ASSERT_EQ(Cpus({0, 1, 2, 3, 4}), split.first);
+  ASSERT_EQ(Cpus(), split.second);
+}
+
+TEST(ThreadPlacement, CompactUpToIoCoreCount)
+{
+  const auto split = workflow::splitCpus(COMPACT, 3, 1);
+  ASSERT_EQ(Cpus({0, 4, 1}), split.first);
+  // core 1 is half used by the aligners, so the I/O gets core 2 only
+  ASSERT_EQ(Cpus({2, 6}), split.second);
+}
+
+TEST(ThreadPlacement, NoCoreLeft)
+{
+  const auto split = workflow::splitCpus(SPREAD, 8, 2);
+  ASSERT_EQ(Cpus({0, 1, 2, 3, 4, 5, 6, 7}), split.first);
+  ASSERT_EQ(Cpus(), split.second);
+  // more aligners than cpus
+  ASSERT_EQ(Cpus({0, 1, 2, 3, 4, 5, 6, 7}), workflow::splitCpus(SPREAD, 16, 2).first);
+}
+
+TEST(ThreadPlacement, MultiplePackages)
+{
+  // same core ids in both packages
+  const std::vector<LogicalCpu> placement = {{0, 0, 0}, {2, 1, 0}, {1, 0, 1}, {3, 1, 1}};
+  const auto                    split     = workflow::splitCpus(placement, 1, 2);
+  ASSERT_EQ(Cpus({0}), split.first);
+  ASSERT_EQ(Cpus({2, 1}), split.second);
+}
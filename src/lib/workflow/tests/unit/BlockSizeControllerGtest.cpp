@@ -0,0 +1,80 @@
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "workflow/BlockSizeController.hpp"
+
+using namespace dragenos;
+typedef workflow::BlockSizeController BlockSizeController;
+
+// feed one window of identical blocks of the current size
+static void window(
+    BlockSizeController& controller,
+    std::size_t          threads,
+    double               secondsPerUnit,
+    std::size_t          bytesPerUnit,
+    std::size_t          idleCpus,
+    std::size_t          blocksInFlight)
+{
+  for (std::size_t i = 0; threads > i; ++i) {
+    const std::size_t size = controller.getBlockSize();
+    controller.blockAligned(size, size * bytesPerUnit, size * secondsPerUnit, idleCpus, blocksInFlight);
+  }
+}
+
+TEST(BlockSizeController, bounds)
+{
+  std::ostringstream  log;
+  BlockSizeController controller("records", 1000, 64000, 1000000, 1000, 0, 4, log);
+  ASSERT_EQ(64000u, controller.getBlockSize());
+  BlockSizeController rounded("records", 1000, 64000, 12345, 1000, 0, 4, log);
+  ASSERT_EQ(12000u, rounded.getBlockSize());
+}
+
+TEST(BlockSizeController, latency)
+{
+  std::ostringstream  log;
+  BlockSizeController controller("records", 1000, 64000, 8000, 1000, 0, 4, log);
+  // fast blocks grow up to the upper bound
+  for (int i = 0; 10 > i; ++i) {
+    window(controller, 4, 1e-6, 100, 0, 4);
+  }
+  ASSERT_EQ(64000u, controller.getBlockSize());
+  ASSERT_EQ(3u, controller.getChanges());
+  ASSERT_NE(std::string::npos, log.str().find("8000 -> 16000 records"));
+
+  // decisions are taken once per window
+  controller.blockAligned(64000, 0, 64000 * 1e-3, 0, 4);
+  ASSERT_EQ(64000u, controller.getBlockSize());
+
+  // slow blocks shrink down to the lower bound
+  BlockSizeController slow("records", 1000, 64000, 8000, 1000, 0, 4, log);
+  for (int i = 0; 10 > i; ++i) {
+    window(slow, 4, 1e-2, 100, 0, 4);
+  }
+  ASSERT_EQ(1000u, slow.getBlockSize());
+
+  // blocks in the target range don't move unless cpus are idle
+  BlockSizeController steady("records", 1000, 64000, 8000, 1000, 0, 4, log);
+  window(steady, 4, 1e-4, 100, 0, 4);
+  ASSERT_EQ(8000u, steady.getBlockSize());
+  window(steady, 4, 1e-4, 100, 2, 4);
+  ASSERT_EQ(16000u, steady.getBlockSize());
+  window(steady, 4, 1e-4, 100, 2, 4);
+  ASSERT_EQ(32000u, steady.getBlockSize());
+  // unless doubling would make the blocks too slow
+  window(steady, 4, 1e-4, 100, 2, 4);
+  ASSERT_EQ(32000u, steady.getBlockSize());
+}
+
+TEST(BlockSizeController, memory)
+{
+  std::ostringstream log;
+  // 8 blocks of 8000 records at 1KB each in flight: 64MB
+  BlockSizeController controller("records", 1000, 64000, 8000, 1000, 32 * 1024 * 1024, 4, log);
+  window(controller, 4, 1e-6, 1024, 0, 8);
+  ASSERT_EQ(4000u, controller.getBlockSize());
+  // fast blocks don't grow beyond the memory limit
+  window(controller, 4, 1e-6, 1024, 0, 8);
+  ASSERT_EQ(4000u, controller.getBlockSize());
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "workflow/ProgressMonitor.hpp"
+
+using namespace dragenos;
+namespace bfs = boost::filesystem;
+typedef workflow::ProgressMonitor ProgressMonitor;
+
+TEST(ProgressMonitor, sample)
+{
+  std::ostringstream log;
+  ProgressMonitor    progress(0.0, "", 4, nullptr, nullptr, log);
+  const auto         start = std::chrono::steady_clock::now();
+  progress.start();
+
+  progress.getWorker(0).reads += 1000;
+  progress.getWorker(3).reads += 3000;
+  progress.blocksRead(5);
+  progress.blocksStored(2);
+  auto status = progress.sample(start + std::chrono::seconds(2));
+  ASSERT_EQ(4000u, status.reads);
+  ASSERT_EQ("none", status.insertSizeState);
+  ASSERT_EQ(5, status.blocksRead);
+  ASSERT_EQ(2, status.blocksStored);
+  // no input registered
+  ASSERT_EQ(0u, status.inputFileBytes);
+  ASSERT_GT(0.0, status.etaSeconds);
+
+  // the rate only covers the interval since the previous sample
+  progress.getWorker(1).reads += 500;
+  status = progress.sample(start + std::chrono::seconds(4));
+  ASSERT_EQ(4500u, status.reads);
+  ASSERT_NEAR(250.0, status.readsPerSecond, 5.0);
+
+  align::InsertSizeParameters parameters(
+      100, 600, 350, 50, 800, 1, align::InsertSizeParameters::Orientation::pe_orient_fr_c, false);
+  progress.insertSizesChanged(parameters);
+  ASSERT_EQ("sampling", progress.sample(start + std::chrono::seconds(5)).insertSizeState);
+  parameters.isInitStatDone_ = true;
+  progress.insertSizesChanged(parameters);
+  status = progress.sample(start + std::chrono::seconds(6));
+  ASSERT_EQ("initialized", status.insertSizeState);
+  ASSERT_EQ(350, status.insertSizeMean);
+
+  std::ostringstream line;
+  ProgressMonitor::writeLine(line, status);
+  ASSERT_NE(std::string::npos, line.str().find("4500 reads"));
+  ASSERT_NE(std::string::npos, line.str().find("3 blocks in flight (0 MB)"));
+  ASSERT_NE(std::string::npos, line.str().find("RSS 100 MB (peak 200 MB)"));
+  ASSERT_NE(std::string::npos, line.str().find("insert size initialized mean 350 [100, 600]"));
+  ASSERT_EQ('\n', line.str().back());
+}
+
+TEST(ProgressMonitor, input)
+{
+  const std::string path = (bfs::temp_directory_path() / bfs::unique_path()).string();
+  {
+    std::ofstream os(path);
+    os << std::string(1000, 'A');
+  }
+  std::ifstream      file(path);
+  std::ostringstream log;
+  ProgressMonitor    progress(0.0, "", 1, nullptr, nullptr, log);
+  progress.addInput(path, file);
+  const auto start = std::chrono::steady_clock::now();
+  progress.start();
+
+  char buffer[250];
+  file.read(buffer, sizeof(buffer));
+  progress.inputRead(0);
+  const auto status = progress.sample(start + std::chrono::seconds(10));
+  ASSERT_EQ(250u, status.inputBytes);
+  ASSERT_EQ(1000u, status.inputFileBytes);
+  // a quarter in 10 seconds leaves 30 seconds
+  ASSERT_NEAR(30.0, status.etaSeconds, 0.5);
+
+  std::ostringstream line;
+  ProgressMonitor::writeLine(line, status);
+  ASSERT_NE(std::string::npos, line.str().find("input 25.0%"));
+  ASSERT_NE(std::string::npos, line.str().find("ETA 0:00:30"));
+  std::remove(path.c_str());
+}
+
+TEST(ProgressMonitor, statusFile)
+{
+  const std::string  path = (bfs::temp_directory_path() / bfs::unique_path()).string();
+  std::ostringstream log;
+  {
+    ProgressMonitor progress(0.01, path, 1, nullptr, nullptr, log);
+    progress.getWorker(0).reads += 42;
+    progress.start();
+    // the status line is printed before the status file is renamed into place
+    for (int i = 0; 500 > i && !std::ifstream(path).good(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    progress.stop();
+  }
+  ASSERT_NE(std::string::npos, log.str().find("Progress: 0:00:00 elapsed, 42 reads"));
+  std::ifstream      is(path);
+  std::ostringstream json;
+  json << is.rdbuf();
+  ASSERT_NE(std::string::npos, json.str().find("\"reads\": 42,"));
+  ASSERT_NE(std::string::npos, json.str().find("\"etaSeconds\": null,"));
+  ASSERT_NE(std::string::npos, json.str().find("\"rssBytes\": 104857600, \"peakRssBytes\": 209715200}"));
+  std::ifstream tmp(path + ".tmp");
+  ASSERT_FALSE(tmp.good());
+  std::remove(path.c_str());
+}
@@ -0,0 +1,20 @@
+#include "common/MemoryAccounting.hpp"
+
+namespace dragenos {
+namespace common {
+
+uint64_t MemoryAccounting::getTotal() const
+{
+  return 0;
+}
+
+MemoryAccounting::ProcessMemory MemoryAccounting::getProcessMemory()
+{
+  ProcessMemory ret;
+  ret.rss     = 100 * 1024 * 1024;
+  ret.peakRss = 200 * 1024 * 1024;
+  return ret;
+}
+
+}  // namespace common
+}  // namespace dragenos
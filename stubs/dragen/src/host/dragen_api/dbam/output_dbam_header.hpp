@@ -124,7 +124,7 @@ public:
   bool isDuplicate() const { return (alignment_.isDuplicate()); }
 
   const uint8_t *getConstQualities() const {
-    return reinterpret_cast<const uint8_t *>(read_.getQualities().first);
+    return reinterpret_cast<const uint8_t *>(read_.getQualities().data());
   }
 
   uint8_t getPeStatsInterval() const { return peStatsInterval_; }
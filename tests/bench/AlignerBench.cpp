@@ -0,0 +1,62 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchFixtures.hpp"
+#include "align/Aligner.hpp"
+
+using namespace dragenos;
+
+/// arguments: read length, one mismatch every that many bases (0 for none)
+static void AlignerInitializeUngappedAlignmentScores(benchmark::State& state)
+{
+  const auto& fixtures = bench::Fixtures::instance();
+  // the potential score of the ungapped alignments is only defined for 21 base seeds
+  if (21 != fixtures.getHashtable().getPrimarySeedBases()) {
+    state.SkipWithError("needs a reference with 21 base primary seeds, see DRAGEN_OS_BENCH_REFERENCE");
+    return;
+  }
+  const align::SimilarityScores similarity(1, -4);
+  align::Aligner                aligner(
+      fixtures.getReferenceDir(),
+      fixtures.getHashtable(),
+      false,
+      0,
+      similarity,
+      7,
+      1,
+      5,
+      22,
+      50,
+      80,
+      4.0,
+      false,
+      false,
+      0);
+  std::vector<uint64_t>              positions;
+  const std::vector<sequences::Read> reads =
+      fixtures.simulateReads(1024, state.range(0), state.range(1), &positions);
+  align::Alignment alignment;
+  std::size_t      i = 0;
+  for (auto _ : state) {
+    // the odd reads are reverse complemented
+    const std::size_t read = (i++ % (reads.size() / 2)) * 2;
+    alignment.reset();
+    benchmark::DoNotOptimize(
+        aligner.initializeUngappedAlignmentScores(reads[read], false, positions[read], alignment));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(AlignerInitializeUngappedAlignmentScores)->Args({100, 0})->Args({151, 0})->Args({151, 25});
@@ -0,0 +1,125 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "BenchFixtures.hpp"
+#include "common/Exceptions.hpp"
+#include "fastq/Tokenizer.hpp"
+#include "io/Fastq2ReadTransformer.hpp"
+
+namespace dragenos {
+namespace bench {
+
+const Fixtures& Fixtures::instance()
+{
+  static const Fixtures fixtures;
+  return fixtures;
+}
+
+Fixtures::Fixtures()
+{
+  const char* const             path = std::getenv("DRAGEN_OS_BENCH_REFERENCE");
+  const boost::filesystem::path dir(path ? path : "data/small/small-20k-repeats.v8");
+  // the fixtures in data/ only ship the compressed hash table
+  const bool load = boost::filesystem::exists(dir / "hash_table.bin");
+  referenceDir_.reset(new reference::ReferenceDir7(dir, false, load));
+  hashtable_.reset(new reference::Hashtable(
+      &referenceDir_->getHashtableConfig(),
+      referenceDir_->getHashtableData(),
+      referenceDir_->getExtendTableData()));
+}
+
+std::pair<uint64_t, uint64_t> Fixtures::getPositionRange() const
+{
+  const auto& config = referenceDir_->getHashtableConfig();
+  return config.getPositionRange(config.getSequences().front());
+}
+
+std::vector<unsigned char> Fixtures::getReferenceBases(const std::size_t begin, const std::size_t end) const
+{
+  std::vector<unsigned char> bases(end - begin);
+  referenceDir_->getReferenceSequence().getBases(begin, end, bases.data());
+  return bases;
+}
+
+std::string Fixtures::simulateFastq(
+    const std::size_t      count,
+    const std::size_t      length,
+    const unsigned         mismatchPeriod,
+    std::vector<uint64_t>* positions,
+    const unsigned         seed) const
+{
+  const auto range = getPositionRange();
+  if (range.second < range.first + length) {
+    BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+        "reads of " + std::to_string(length) + " bases don't fit in the first reference sequence"));
+  }
+  std::mt19937                            generator(seed);
+  std::uniform_int_distribution<uint64_t> offsets(range.first, range.second - length);
+  std::uniform_int_distribution<unsigned> shifts(1, 3);
+  static const char                       ACGT[] = "ACGT";
+
+  std::ostringstream fastq;
+  std::string        bases;
+  for (std::size_t i = 0; count != i; ++i) {
+    const uint64_t position = offsets(generator);
+    const auto     encoded  = getReferenceBases(position, position + length);
+    if (positions) {
+      positions->push_back(position);
+    }
+    bases.clear();
+    for (const auto base : encoded) {
+      bases.push_back(sequences::Read::decodeBase(base));
+    }
+    for (std::size_t j = mismatchPeriod / 2; mismatchPeriod && bases.size() > j; j += mismatchPeriod) {
+      const char* const found = std::find(ACGT, ACGT + 4, bases[j]);
+      bases[j]                = ACGT[((found - ACGT) + shifts(generator)) % 4];
+    }
+    if (i % 2) {
+      std::string rc(bases.rbegin(), bases.rend());
+      std::transform(rc.begin(), rc.end(), rc.begin(), [](const char b) {
+        return 'A' == b ? 'T' : 'C' == b ? 'G' : 'G' == b ? 'C' : 'T' == b ? 'A' : 'N';
+      });
+      bases.swap(rc);
+    }
+    fastq << "@sim-" << i << "-" << position << "\n" << bases << "\n+\n" << std::string(length, 'F') << "\n";
+  }
+  return fastq.str();
+}
+
+std::vector<sequences::Read> Fixtures::simulateReads(
+    const std::size_t      count,
+    const std::size_t      length,
+    const unsigned         mismatchPeriod,
+    std::vector<uint64_t>* positions,
+    const unsigned         seed) const
+{
+  std::istringstream           input(simulateFastq(count, length, mismatchPeriod, positions, seed));
+  fastq::Tokenizer             tokenizer(input);
+  io::FastqToReadTransformer   transformer;
+  std::vector<sequences::Read> reads(count);
+  for (std::size_t i = 0; count != i && tokenizer.next(); ++i) {
+    transformer(tokenizer.token(), 0, i, reads[i]);
+  }
+  return reads;
+}
+
+}  // namespace bench
+}  // namespace dragenos
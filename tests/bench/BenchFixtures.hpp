@@ -0,0 +1,78 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#ifndef BENCH_BENCH_FIXTURES_HPP
+#define BENCH_BENCH_FIXTURES_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "reference/Hashtable.hpp"
+#include "reference/ReferenceDir.hpp"
+#include "sequences/Read.hpp"
+
+namespace dragenos {
+namespace bench {
+
+/**
+ ** \brief inputs shared by all the benchmarks, created once on first use
+ **
+ ** The reference is the hash table directory named by the environment variable
+ ** DRAGEN_OS_BENCH_REFERENCE, data/small/small-20k-repeats.v8 by default. The reads are
+ ** sampled from its first sequence with a deterministic generator, so that the results of
+ ** two runs on the same reference are comparable.
+ **/
+class Fixtures {
+public:
+  static const Fixtures& instance();
+
+  const reference::ReferenceDir7& getReferenceDir() const { return *referenceDir_; }
+  const reference::Hashtable&     getHashtable() const { return *hashtable_; }
+
+  /**
+   ** \brief fastq text of count reads of the given length
+   **
+   ** One base in every mismatchPeriod is replaced with another one, none if 0. Every other
+   ** read is reverse complemented. The reference offsets of the reads go to positions, if any.
+   **/
+  std::string simulateFastq(
+      std::size_t            count,
+      std::size_t            length,
+      unsigned               mismatchPeriod,
+      std::vector<uint64_t>* positions = nullptr,
+      unsigned               seed      = 42) const;
+  /// the reads of simulateFastq, through the same parsing as the fastq input of dragen-os
+  std::vector<sequences::Read> simulateReads(
+      std::size_t            count,
+      std::size_t            length,
+      unsigned               mismatchPeriod,
+      std::vector<uint64_t>* positions = nullptr,
+      unsigned               seed      = 42) const;
+  /// reference bases in the 4 bits per base encoding of the reads
+  std::vector<unsigned char> getReferenceBases(std::size_t begin, std::size_t end) const;
+  /// first and last+1 offsets of the first reference sequence
+  std::pair<uint64_t, uint64_t> getPositionRange() const;
+
+private:
+  Fixtures();
+
+  std::unique_ptr<reference::ReferenceDir7> referenceDir_;
+  std::unique_ptr<reference::Hashtable>     hashtable_;
+};
+
+}  // namespace bench
+}  // namespace dragenos
+
+#endif  // #ifndef BENCH_BENCH_FIXTURES_HPP
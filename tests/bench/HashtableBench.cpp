@@ -0,0 +1,77 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <algorithm>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchFixtures.hpp"
+#include "sequences/Seed.hpp"
+
+using namespace dragenos;
+
+/// hashes random seed values with the primary hasher of the reference
+static void CrcHasherGetHash64(benchmark::State& state)
+{
+  const auto&                             hasher = *bench::Fixtures::instance().getHashtable().getPrimaryHasher();
+  std::mt19937_64                         generator(42);
+  std::vector<uint64_t>                   keys(4096);
+  std::uniform_int_distribution<uint64_t> values;
+  std::generate(keys.begin(), keys.end(), [&]() { return values(generator); });
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hasher.getHash64(keys[i++ % keys.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CrcHasherGetHash64);
+
+/// hashes of the primary seeds of reads sampled from the reference, either all hits or random
+static std::vector<uint64_t> getSeedHashes(const bool fromReference)
+{
+  const auto&           fixtures   = bench::Fixtures::instance();
+  const auto&           hashtable  = fixtures.getHashtable();
+  const unsigned        seedLength = hashtable.getPrimarySeedBases();
+  std::vector<uint64_t> hashes;
+  std::mt19937_64       generator(42);
+  for (const auto& read : fixtures.simulateReads(256, 151, 0)) {
+    for (unsigned offset = 0; offset + seedLength <= read.getLength(); offset += 2) {
+      const sequences::Seed seed(&read, offset, seedLength);
+      const auto            forward = seed.getPrimaryData(false);
+      const auto            reverse = seed.getPrimaryData(true);
+      const auto            data    = fromReference ? std::min(forward, reverse)
+                                                    : generator() & ((uint64_t(1) << (2 * seedLength)) - 1);
+      hashes.push_back(hashtable.getPrimaryHasher()->getHash64(data));
+    }
+  }
+  return hashes;
+}
+
+static void HashtableGetHits(benchmark::State& state)
+{
+  const auto&                                 hashtable = bench::Fixtures::instance().getHashtable();
+  const std::vector<uint64_t>                 hashes    = getSeedHashes(state.range(0));
+  std::vector<reference::HashRecord>          hits;
+  std::vector<reference::ExtendTableInterval> intervals;
+  std::size_t                                 i = 0;
+  for (auto _ : state) {
+    intervals.clear();
+    hashtable.getHits(hashes[i++ % hashes.size()], false, hits, intervals);
+    benchmark::DoNotOptimize(hits.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+// 1: seeds of the reference, 0: random seeds, mostly misses
+BENCHMARK(HashtableGetHits)->Arg(1)->Arg(0);
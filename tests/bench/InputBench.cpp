@@ -0,0 +1,63 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchFixtures.hpp"
+#include "fastq/Tokenizer.hpp"
+#include "io/Fastq2ReadTransformer.hpp"
+
+using namespace dragenos;
+
+static const std::size_t FASTQ_READS = 10000;
+
+/// argument: read length. One iteration parses the whole fastq
+static void FastqTokenizerNext(benchmark::State& state)
+{
+  const std::string fastq = bench::Fixtures::instance().simulateFastq(FASTQ_READS, state.range(0), 0);
+  for (auto _ : state) {
+    std::istringstream input(fastq);
+    fastq::Tokenizer   tokenizer(input);
+    std::size_t        records = 0;
+    while (tokenizer.next()) {
+      ++records;
+    }
+    benchmark::DoNotOptimize(records);
+  }
+  state.SetItemsProcessed(state.iterations() * FASTQ_READS);
+  state.SetBytesProcessed(state.iterations() * fastq.size());
+}
+BENCHMARK(FastqTokenizerNext)->Arg(100)->Arg(151);
+
+/// argument: read length. Tokenizes and converts the records into reads, as the fastq input does
+static void FastqToReadTransformer(benchmark::State& state)
+{
+  const std::string          fastq = bench::Fixtures::instance().simulateFastq(FASTQ_READS, state.range(0), 0);
+  io::FastqToReadTransformer transformer;
+  sequences::Read            read;
+  for (auto _ : state) {
+    std::istringstream input(fastq);
+    fastq::Tokenizer   tokenizer(input);
+    uint64_t           fragmentId = 0;
+    while (tokenizer.next()) {
+      transformer(tokenizer.token(), 0, fragmentId++, read);
+    }
+    benchmark::DoNotOptimize(read.getBases().data());
+  }
+  state.SetItemsProcessed(state.iterations() * FASTQ_READS);
+  state.SetBytesProcessed(state.iterations() * fastq.size());
+}
+BENCHMARK(FastqToReadTransformer)->Arg(100)->Arg(151);
@@ -0,0 +1,37 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchFixtures.hpp"
+#include "map/ChainBuilder.hpp"
+#include "map/Mapper.hpp"
+
+using namespace dragenos;
+
+/// arguments: read length, one mismatch every that many bases (0 for none)
+static void MapperGetPositionChains(benchmark::State& state)
+{
+  const auto&                        fixtures = bench::Fixtures::instance();
+  const map::Mapper                  mapper(&fixtures.getHashtable());
+  map::ChainBuilder                  chainBuilder(4.0);
+  const std::vector<sequences::Read> reads = fixtures.simulateReads(1024, state.range(0), state.range(1));
+  std::size_t                        i     = 0;
+  for (auto _ : state) {
+    mapper.getPositionChains(reads[i++ % reads.size()], chainBuilder);
+    benchmark::DoNotOptimize(chainBuilder.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MapperGetPositionChains)->Args({100, 0})->Args({151, 0})->Args({151, 25});
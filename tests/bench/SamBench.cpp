@@ -0,0 +1,69 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "BenchFixtures.hpp"
+#include "align/Sam.hpp"
+
+using namespace dragenos;
+
+/// argument: read length. Formats a mapped paired record into a buffer, as the workflows do
+static void SamGenerateRecord(benchmark::State& state)
+{
+  const auto&                        fixtures = bench::Fixtures::instance();
+  const align::Sam                   sam(fixtures.getReferenceDir().getHashtableConfig());
+  std::vector<uint64_t>              positions;
+  const std::vector<sequences::Read> reads = fixtures.simulateReads(256, state.range(0), 25, &positions);
+  const auto                         range = fixtures.getPositionRange();
+
+  std::vector<align::Alignment> alignments(reads.size());
+  for (std::size_t i = 0; reads.size() != i; ++i) {
+    align::Alignment& alignment = alignments[i];
+    alignment.reset(
+        align::Alignment::MULTIPLE_SEGMENTS | align::Alignment::ALL_PROPERLY_ALIGNED |
+        (i % 2 ? align::Alignment::REVERSE_COMPLEMENT | align::Alignment::LAST_IN_TEMPLATE
+               : align::Alignment::FIRST_IN_TEMPLATE | align::Alignment::REVERSE_COMPLEMENT_NEXT_SEGMENT));
+    alignment.setCigarOperations(std::string(reads[i].getLength(), 'M'));
+    alignment.setReference(0);
+    alignment.setPosition(positions[i] - range.first);
+    alignment.setNextReference(0);
+    alignment.setNextPosition(positions[i ^ 1] - range.first);
+    alignment.setTemplateLength(int64_t(positions[i ^ 1]) - int64_t(positions[i]));
+    alignment.setScore(reads[i].getLength() - 5 * reads[i].getLength() / 25);
+    alignment.setMismatchCount(reads[i].getLength() / 25);
+    alignment.setMapq(60);
+  }
+
+  std::vector<char>                   buffer;
+  boost::iostreams::filtering_ostream os;
+  os.push(boost::iostreams::back_insert_device<std::vector<char>>(buffer));
+  const std::string rgid = "1";
+  std::size_t       i    = 0;
+  for (auto _ : state) {
+    const std::size_t record = i++ % reads.size();
+    sam.generateRecord(os, reads[record], alignments[record], rgid) << '\n';
+    if (!record) {
+      os.flush();
+      buffer.clear();
+    }
+  }
+  os.flush();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SamGenerateRecord)->Arg(100)->Arg(151);
@@ -0,0 +1,109 @@
+/**
+ ** DRAGEN Open Source Software
+ ** Copyright (c) 2019-2020 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ **/
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchFixtures.hpp"
+#include "align/SmithWaterman.hpp"
+#include "align/VectorSmithWaterman.hpp"
+
+using namespace dragenos;
+typedef align::SmithWaterman SmithWaterman;
+
+namespace {
+
+/// a read and the reference around it, as prepared by the AlignmentGenerator
+struct Problem {
+  std::vector<unsigned char> query;
+  std::vector<unsigned char> database;
+};
+
+/**
+ ** \brief queries from the reference with a mismatch every 25 bases and optionally a deletion
+ **
+ ** The database starts SW_CELLS + 1 bases before the query, which is where the aligner expects
+ ** the alignment to start.
+ **/
+std::vector<Problem> getProblems(const std::size_t length, const unsigned deletion)
+{
+  const auto&                             fixtures = bench::Fixtures::instance();
+  const auto                              range    = fixtures.getPositionRange();
+  const std::size_t                       margin   = SmithWaterman::SW_CELLS + 1;
+  std::mt19937                            generator(42);
+  std::uniform_int_distribution<uint64_t> positions(range.first + margin, range.second - length - 2 * margin);
+  std::vector<Problem>                    problems(64);
+  for (auto& problem : problems) {
+    const uint64_t position = positions(generator);
+    problem.database        = fixtures.getReferenceBases(position - margin, position + length + deletion + margin);
+    problem.query           = fixtures.getReferenceBases(position, position + length + deletion);
+    problem.query.erase(problem.query.begin() + length / 2, problem.query.begin() + length / 2 + deletion);
+    for (std::size_t i = 12; problem.query.size() > i; i += 25) {
+      problem.query[i] = (1 == problem.query[i]) ? 2 : 1;
+    }
+  }
+  return problems;
+}
+
+}  // namespace
+
+/// arguments: read length, deletion length
+static void SmithWatermanAlign(benchmark::State& state)
+{
+  const align::SimilarityScores similarity(1, -4);
+  SmithWaterman                 smithWaterman(similarity, 7, 1, 5);
+  const std::vector<Problem>    problems = getProblems(state.range(0), state.range(1));
+  std::string                   cigar;
+  std::size_t                   i = 0;
+  for (auto _ : state) {
+    const Problem& problem = problems[i++ % problems.size()];
+    benchmark::DoNotOptimize(smithWaterman.align(
+        problem.query.data(),
+        problem.query.data() + problem.query.size(),
+        problem.database.data(),
+        problem.database.data() + problem.database.size(),
+        1,
+        SmithWaterman::width,
+        false,
+        cigar));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SmithWatermanAlign)->Args({100, 0})->Args({151, 0})->Args({151, 3});
+
+/// arguments: read length, deletion length. Includes the query profile, built once per read by the aligner
+static void VectorSmithWatermanAlign(benchmark::State& state)
+{
+  const align::SimilarityScores similarity(1, -4);
+  align::VectorSmithWaterman    smithWaterman(similarity, 7, 1, 5);
+  const std::vector<Problem>    problems = getProblems(state.range(0), state.range(1));
+  std::string                   cigar;
+  std::size_t                   i = 0;
+  for (auto _ : state) {
+    const Problem& problem = problems[i++ % problems.size()];
+    smithWaterman.initReadContext(problem.query.data(), problem.query.data() + problem.query.size(), 0);
+    benchmark::DoNotOptimize(smithWaterman.align(
+        problem.query.data(),
+        problem.query.data() + problem.query.size(),
+        problem.database.data(),
+        problem.database.data() + problem.database.size(),
+        false,
+        cigar,
+        0));
+    smithWaterman.destroyReadContext(0);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(VectorSmithWatermanAlign)->Args({100, 0})->Args({151, 0})->Args({151, 3});
@@ -1,11 +1,19 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -16,6 +24,11 @@
 #include <boost/functional/hash.hpp>
 #include <boost/program_options.hpp>
 
+// compare a new SAM file against a reference SAM file, in any order. Both
+// inputs are first partitioned by read name into buckets on disk, then the
+// buckets are compared by a pool of threads, so that the memory only has to
+// hold a few buckets at a time
+
 class Sam {
 public:
   Sam &operator=(const std::string &line);
@@ -58,7 +71,7 @@ private:
   int mapq_;
 };
 
-typedef std::pair<unsigned, unsigned> Count;
+typedef std::pair<uint64_t, uint64_t> Count;
 typedef std::pair<std::string, unsigned>
     AltID; // for secondary/supplementary alignments
 
@@ -73,14 +86,16 @@ struct Statistics {
     mapqDirection.fill(Count(0, 0));
     cigar.fill(Count(0, 0));
   }
+  // accumulate the statistics of another bucket
+  Statistics &operator+=(const Statistics &rhs);
   void write(const std::string outputDirectory) const;
   static unsigned mapqBin(const int mapq);
-  unsigned missing = 0;
-  unsigned extra = 0;
-  unsigned match = 0;
-  unsigned mismatch = 0;
-  unsigned moreAlignments = 0;
-  unsigned lessAlignments = 0;
+  uint64_t missing = 0;
+  uint64_t extra = 0;
+  uint64_t match = 0;
+  uint64_t mismatch = 0;
+  uint64_t moreAlignments = 0;
+  uint64_t lessAlignments = 0;
   Count unmapped = {0, 0};
   Count mapped = {0, 0};
   std::array<Count, 4> position; // MAPQ: 60, 30-59, 1-29, 0
@@ -89,35 +104,151 @@ struct Statistics {
   std::array<Count, 4> mapqDirection;
   std::array<Count, 4> cigar;
 
-  // note that a record may contribute to multiple mismatched tags
-  std::unordered_map<std::string, std::array<Count, 4>> tags;
-  std::unordered_map<std::string, int> missingTags;
-  std::unordered_map<std::string, int> extraTags;
+  // note that a record may contribute to multiple mismatched tags. Ordered so
+  // that the report does not depend on the order of the buckets
+  std::map<std::string, std::array<Count, 4>> tags;
+  std::map<std::string, uint64_t> missingTags;
+  std::map<std::string, uint64_t> extraTags;
 
   // secondary alignments stats
-  unsigned secondaryMissing = 0;
-  unsigned secondaryExtra = 0;
-  unsigned secondaryMatch = 0;
+  uint64_t secondaryMissing = 0;
+  uint64_t secondaryExtra = 0;
+  uint64_t secondaryMatch = 0;
 
   // supplementary alignments stats
-  unsigned supplementaryMissing = 0;
-  unsigned supplementaryExtra = 0;
-  unsigned supplementaryMatch = 0;
+  uint64_t supplementaryMissing = 0;
+  uint64_t supplementaryExtra = 0;
+  uint64_t supplementaryMatch = 0;
+};
+
+// labels of the MAPQ bins in the names of the mismatch files
+static const std::array<std::string, 4> MAPQ_FILE_LABELS{"60", "30-59", "1-29",
+                                                          "0"};
+
+// the lists of mismatching records of one thread, keyed by output file name.
+// Only the lists enabled on the command line are kept, and they get appended
+// to the output files after each bucket
+class Mismatches {
+public:
+  explicit Mismatches(const std::unordered_set<std::string> &enabled)
+      : enabled_(enabled) {}
+  // the new record into <list>.sam and the reference one into
+  // <list>Reference.sam
+  void add(const std::string &list, const Sam &newRecord,
+           const Sam &refRecord) {
+    add(list + ".sam", newRecord);
+    add(list + "Reference.sam", refRecord);
+  }
+  void add(const std::string &file, const Sam &record) {
+    if (enabled_.count(file)) {
+      records_[file] += record.getUnparsed();
+      records_[file] += '\n';
+    }
+  }
+  std::unordered_map<std::string, std::string> &getRecords() {
+    return records_;
+  }
+
+private:
+  const std::unordered_set<std::string> &enabled_;
+  std::unordered_map<std::string, std::string> records_;
+};
+
+// the output files of the enabled mismatch lists, shared by the threads
+class MismatchFiles {
+public:
+  MismatchFiles(const boost::filesystem::path &outputDirectory,
+                const std::unordered_set<std::string> &enabled) {
+    for (const auto &file : enabled) {
+      const boost::filesystem::path path = outputDirectory / file;
+      std::unique_ptr<std::ofstream> os(new std::ofstream(path.string()));
+      if (!*os) {
+        std::cerr << "failed to create " << path.string() << ": " << errno
+                  << ": " << strerror(errno) << std::endl;
+        exit(2);
+      }
+      files_.emplace(file, std::move(os));
+    }
+  }
+  void append(Mismatches &mismatches) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &kv : mismatches.getRecords()) {
+      *files_.at(kv.first) << kv.second;
+      kv.second.clear();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<std::ofstream>> files_;
+};
+
+// records of one input distributed by read name into bucket files. The
+// records are buffered in memory and appended to the files by chunks, so that
+// the number of buckets is not limited by the number of open files
+class BucketWriter {
+public:
+  static const std::size_t CHUNK = 64 * 1024;
+
+  BucketWriter(const boost::filesystem::path &directory,
+               const std::string &prefix, const std::size_t buckets)
+      : directory_(directory), prefix_(prefix), chunks_(buckets) {}
+  ~BucketWriter() { flush(); }
+  boost::filesystem::path getPath(const std::size_t bucket) const {
+    return directory_ / (prefix_ + "-" + std::to_string(bucket) + ".sam");
+  }
+  static std::size_t getBucket(const std::string &line,
+                               const std::size_t buckets) {
+    const std::size_t nameEnd = std::min(line.find('\t'), line.size());
+    return std::hash<std::string>()(line.substr(0, nameEnd)) % buckets;
+  }
+  void add(const std::string &line) {
+    std::string &chunk = chunks_[getBucket(line, chunks_.size())];
+    chunk += line;
+    chunk += '\n';
+    if (CHUNK <= chunk.size()) {
+      write(chunk, getPath(&chunk - chunks_.data()));
+    }
+  }
+  void flush() {
+    for (std::size_t bucket = 0; chunks_.size() != bucket; ++bucket) {
+      write(chunks_[bucket], getPath(bucket));
+    }
+  }
+
+private:
+  const boost::filesystem::path directory_;
+  const std::string prefix_;
+  std::vector<std::string> chunks_;
+
+  static void write(std::string &chunk, const boost::filesystem::path &path) {
+    if (chunk.empty()) {
+      return;
+    }
+    std::ofstream os(path.string(), std::ios_base::app);
+    if (!(os << chunk)) {
+      std::cerr << "failed to write " << path.string() << ": " << errno << ": "
+                << strerror(errno) << std::endl;
+      exit(2);
+    }
+    chunk.clear();
+  }
+};
+
+// all the records of one bucket of one input
+struct Bucket {
+  // primary records grouped by read name
+  std::unordered_map<std::string, std::vector<Sam>> samRecords;
+  SamBuffer secondaryBuffers;
+  SamBuffer supplementaryBuffers;
 };
 
-bool getSamRecords(std::istream &is, std::vector<Sam> &samRecords,
-                   SamBuffer &secondaryBuffers, SamBuffer &supplementaryBuffers,
-                   Sam &next);
-void compare(
-    std::vector<Sam> &referenceRecords, std::vector<Sam> &newRecords,
-    Statistics &statistics, std::ostream &missingMappings,
-    std::ostream &extraMappings, std::ostream &positionMismatch,
-    std::ostream &positionMismatchReference, std::ostream &flagMismatch,
-    std::ostream &flagMismatchReference, std::ostream &cigarMismatch,
-    std::ostream &cigarMismatchReference, std::ostream &pairEndInfoMismatch,
-    std::ostream &pairEndInfoMismatchReference,
-    std::map<std::string, std::shared_ptr<std::ostream>> &tagMismatch,
-    std::map<std::string, std::shared_ptr<std::ostream>> &tagMismatchReference);
+std::size_t partition(const std::string &inputFile, BucketWriter &buckets);
+void loadBucket(const boost::filesystem::path &path, Bucket &bucket);
+void compareBucket(Bucket &reference, Bucket &newRecords,
+                   Statistics &statistics, Mismatches &mismatches);
+void compare(std::vector<Sam> &referenceRecords, std::vector<Sam> &newRecords,
+             Statistics &statistics, Mismatches &mismatches);
 std::ostream &operator<<(std::ostream &os, const Sam &sam);
 std::ostream &operator<<(std::ostream &os, const Statistics &statistics);
 
@@ -126,37 +257,20 @@ void compareSecondary(SamBuffer &refSamBuffer, SamBuffer &newSamBuffer,
 void compareSupplementary(SamBuffer &refSamBuffer, SamBuffer &newSamBuffer,
                           Statistics &statistics);
 
-void makeMismatchFiles(
-    const std::string &tag, const std::string &fileSuffix,
-    const boost::filesystem::path &outputDirectory,
-    std::map<std::string, std::shared_ptr<std::ostream>> &tagMismatch) {
-  tagMismatch.emplace(
-      tag + std::to_string(Statistics::mapqBin(0)),
-      std::make_shared<std::ofstream>(
-          (outputDirectory / ("tag" + tag + "Mismatch0" + fileSuffix))
-              .string()));
-  tagMismatch.emplace(
-      tag + std::to_string(Statistics::mapqBin(1)),
-      std::make_shared<std::ofstream>(
-          (outputDirectory / ("tag" + tag + "Mismatch1-29" + fileSuffix))
-              .string()));
-  tagMismatch.emplace(
-      tag + std::to_string(Statistics::mapqBin(30)),
-      std::make_shared<std::ofstream>(
-          (outputDirectory / ("tag" + tag + "Mismatch30-59" + fileSuffix))
-              .string()));
-  tagMismatch.emplace(
-      tag + std::to_string(Statistics::mapqBin(60)),
-      std::make_shared<std::ofstream>(
-          (outputDirectory / ("tag" + tag + "Mismatch60" + fileSuffix))
-              .string()));
+void enableTagMismatchFiles(const std::string &tag,
+                            std::unordered_set<std::string> &enabled) {
+  for (const auto &label : MAPQ_FILE_LABELS) {
+    enabled.insert("tag" + tag + "Mismatch" + label + ".sam");
+    enabled.insert("tag" + tag + "Mismatch" + label + "Reference.sam");
+  }
 }
 
 int main(int argc, char *argv[]) {
   namespace po = boost::program_options;
   po::options_description options(
       "Usage: compare reference.sam new.sam [options]\n"
-      "compare the specified 'new.sam' file against 'reference.sam'.\n"
+      "compare the specified 'new.sam' file against 'reference.sam'. The "
+      "records can come in any order.\n"
       "Supported options are:");
   options.add_options()("help", "produce help message")(
       "key-value,k", po::value<bool>()->default_value(false),
@@ -180,7 +294,18 @@ int main(int argc, char *argv[]) {
                   "should be produced")(
       "pair-end-mismatches", po::value<bool>()->default_value(false),
       "speicifes that the list of records that are inconsistent from pair-end "
-      "mapping(sam files are expected to be sorted by read name and FR order)")(
+      "mapping should be produced")(
+      "buckets,b", po::value<std::size_t>()->default_value(1024),
+      "number of buckets the records are partitioned into by read name. Each "
+      "thread holds the records of one bucket of both inputs in memory")(
+      "threads,t",
+      po::value<unsigned>()->default_value(std::thread::hardware_concurrency()),
+      "number of threads comparing the buckets")(
+      "temp-directory", po::value<std::string>()->default_value(""),
+      "directory for the bucket files, the output directory by default. They "
+      "take as much space as both inputs")(
+      "keep-buckets", po::value<bool>()->default_value(false),
+      "keep the bucket files instead of removing them at the end")(
       "input-file,i", po::value<std::vector<std::string>>(),
       "input SAM files reference.sam and new.sam -- these can also be "
       "specified simply as positional options");
@@ -199,7 +324,8 @@ int main(int argc, char *argv[]) {
     return 1;
   }
   const std::vector<std::string> inputFiles =
-      vm["input-file"].as<std::vector<std::string>>();
+      vm.count("input-file") ? vm["input-file"].as<std::vector<std::string>>()
+                             : std::vector<std::string>();
   if (2 != inputFiles.size()) {
     std::cerr << "ERROR: exactly two input files must be specified: "
                  "reference.sam and new.sam"
@@ -207,141 +333,98 @@ int main(int argc, char *argv[]) {
     std::cout << options << "\n";
     return 1;
   }
-  std::array<std::ifstream, 2> is;
-  for (auto i : {0, 1}) {
-    is[i].open(argv[i + 1]);
-    if (!is[i]) {
-      std::cerr << "failed to open " << inputFiles[i] << ": " << errno << ": "
-                << strerror(errno) << std::endl;
-      exit(2);
-    }
-  }
-
-  std::array<SamBuffer, 2> secondaryBuffers;
-  std::array<SamBuffer, 2> supplementaryBuffers;
-
-  // skip the headers
-  std::array<Sam, 2> nextRecords;
-  for (auto i : {0, 1}) {
-    std::string line;
-    while (getline(is[i], line) && ('@' == line[0])) {
-    }
-    nextRecords[i] = line;
+  const std::size_t bucketCount = vm["buckets"].as<std::size_t>();
+  const unsigned threadCount = std::max(1u, vm["threads"].as<unsigned>());
+  if (!bucketCount) {
+    std::cerr << "ERROR: at least one bucket is needed" << std::endl;
+    return 1;
   }
-  // compare
-  std::array<std::vector<Sam>, 2> samRecords;
 
-  getSamRecords(is[0], samRecords[0], secondaryBuffers[0],
-                supplementaryBuffers[0], nextRecords[0]);
-  getSamRecords(is[1], samRecords[1], secondaryBuffers[1],
-                supplementaryBuffers[1], nextRecords[1]);
-  Statistics statistics;
-  // while (getSamRecords(is[0], samRecords[0], nextRecords[0]) ||
-  // getSamRecords(is[1], samRecords[1], nextRecords[1]))
-  std::ofstream positionMismatch;
-  std::ofstream positionMismatchReference;
   const boost::filesystem::path outputDirectory =
       vm["output"].as<std::string>();
+  const boost::filesystem::path bucketDirectory =
+      boost::filesystem::path(vm["temp-directory"].as<std::string>().empty()
+                                  ? outputDirectory
+                                  : vm["temp-directory"].as<std::string>()) /
+      "compare-buckets";
+  boost::filesystem::remove_all(bucketDirectory);
+  boost::filesystem::create_directories(bucketDirectory);
+
+  // partition both inputs at once
+  std::array<std::size_t, 2> records{{0, 0}};
+  {
+    BucketWriter referenceBuckets(bucketDirectory, "reference", bucketCount);
+    BucketWriter newBuckets(bucketDirectory, "new", bucketCount);
+    std::thread reference([&]() {
+      records[0] = partition(inputFiles[0], referenceBuckets);
+    });
+    records[1] = partition(inputFiles[1], newBuckets);
+    reference.join();
+  }
+  std::cerr << "Partitioned " << records[0] << " and " << records[1]
+            << " records into " << bucketCount << " buckets" << std::endl;
+
+  std::unordered_set<std::string> enabled;
   if (vm["position-mismatches"].as<bool>()) {
-    positionMismatch.open((outputDirectory / "positionMismatch.sam").c_str());
-    positionMismatchReference.open(
-        (outputDirectory / "positionMismatchReference.sam").c_str());
+    enabled.insert({"positionMismatch.sam", "positionMismatchReference.sam"});
   }
-  std::ofstream cigarMismatch;
-  std::ofstream cigarMismatchReference;
   if (vm["cigar-mismatches"].as<bool>()) {
-    cigarMismatch.open((outputDirectory / "cigarMismatch.sam").c_str());
-    cigarMismatchReference.open(
-        (outputDirectory / "cigarMismatchReference.sam").c_str());
+    enabled.insert({"cigarMismatch.sam", "cigarMismatchReference.sam"});
   }
-  std::ofstream missingMappings;
   if (vm["missing-mappings"].as<bool>()) {
-    missingMappings.open((outputDirectory / "missingMappings.sam").c_str());
+    enabled.insert("missingMappings.sam");
   }
-
-  std::ofstream extraMappings;
   if (vm["extra-mappings"].as<bool>()) {
-    extraMappings.open((outputDirectory / "extraMappings.sam").c_str());
+    enabled.insert("extraMappings.sam");
   }
-
-  std::ofstream flagMismatch;
-  std::ofstream flagMismatchReference;
   if (vm["flag-mismatches"].as<bool>()) {
-    flagMismatch.open((outputDirectory / "flagMismatch.sam").c_str());
-    flagMismatchReference.open(
-        (outputDirectory / "flagMismatchReference.sam").c_str());
+    enabled.insert({"flagMismatch.sam", "flagMismatchReference.sam"});
   }
-
-  std::ofstream pairEndInfoMismatch;
-  std::ofstream pairEndInfoMismatchReference;
   if (vm["pair-end-mismatches"].as<bool>()) {
-    pairEndInfoMismatch.open((outputDirectory / "pairEndMismatch.sam").c_str());
-    pairEndInfoMismatchReference.open(
-        (outputDirectory / "pairEndMismatchReference.sam").c_str());
-  }
-
-  std::map<std::string, std::shared_ptr<std::ostream>> tagMismatch;
-  std::map<std::string, std::shared_ptr<std::ostream>> tagMismatchReference;
-  makeMismatchFiles("XS", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("XS", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-  makeMismatchFiles("NM", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("NM", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-  makeMismatchFiles("AS", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("AS", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-  makeMismatchFiles("XQ", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("XQ", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-  makeMismatchFiles("SA", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("SA", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-  makeMismatchFiles("MAPQ", ".sam", outputDirectory, tagMismatch);
-  makeMismatchFiles("MAPQ", "Reference.sam", outputDirectory,
-                    tagMismatchReference);
-
-  std::vector<Sam> empty;
-  int counter = 0;
-  while ((!samRecords[0].empty()) || (!samRecords[1].empty())) {
-    // make sure that the comparison is for the same read name of against an
-    // empty set
-    if (counter % 1000000 == 0)
-      std::cerr << "Input " << counter << " Records(Single or Pair)...\n";
-    counter++;
-    compareSecondary(secondaryBuffers[0], secondaryBuffers[1], statistics);
-    compareSupplementary(supplementaryBuffers[0], supplementaryBuffers[1],
-                         statistics);
-    if (samRecords[0].empty() || samRecords[1].empty() ||
-        (samRecords[0][0].getName() == samRecords[1][0].getName())) {
-      compare(samRecords[0], samRecords[1], statistics, missingMappings,
-              extraMappings, positionMismatch, positionMismatchReference,
-              flagMismatch, flagMismatchReference, cigarMismatch,
-              cigarMismatchReference, pairEndInfoMismatch,
-              pairEndInfoMismatchReference, tagMismatch, tagMismatchReference);
-      getSamRecords(is[0], samRecords[0], secondaryBuffers[0],
-                    supplementaryBuffers[0], nextRecords[0]);
-      getSamRecords(is[1], samRecords[1], secondaryBuffers[1],
-                    supplementaryBuffers[1], nextRecords[1]);
-    } else if (samRecords[0][0].getName() < samRecords[1][0].getName()) {
-      compare(samRecords[0], empty, statistics, missingMappings, extraMappings,
-              positionMismatch, positionMismatchReference, flagMismatch,
-              flagMismatchReference, cigarMismatch, cigarMismatchReference,
-              pairEndInfoMismatch, pairEndInfoMismatchReference, tagMismatch,
-              tagMismatchReference);
-      getSamRecords(is[0], samRecords[0], secondaryBuffers[0],
-                    supplementaryBuffers[0], nextRecords[0]);
-    } else // (samRecords[0].getName() > samRecords[1].getName())
-    {
-      compare(empty, samRecords[1], statistics, missingMappings, extraMappings,
-              positionMismatch, positionMismatchReference, flagMismatch,
-              flagMismatchReference, cigarMismatch, cigarMismatchReference,
-              pairEndInfoMismatch, pairEndInfoMismatchReference, tagMismatch,
-              tagMismatchReference);
-      getSamRecords(is[1], samRecords[1], secondaryBuffers[1],
-                    supplementaryBuffers[1], nextRecords[1]);
-    }
+    enabled.insert({"pairEndMismatch.sam", "pairEndMismatchReference.sam"});
+  }
+  for (const std::string tag : {"XS", "NM", "AS", "XQ", "SA", "MAPQ"}) {
+    enableTagMismatchFiles(tag, enabled);
+  }
+  MismatchFiles mismatchFiles(outputDirectory, enabled);
+
+  // compare the buckets in parallel
+  std::vector<Statistics> threadStatistics(threadCount);
+  std::atomic<std::size_t> nextBucket(0);
+  std::atomic<std::size_t> comparedBuckets(0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; threadCount != t; ++t) {
+    threads.emplace_back([&, t]() {
+      Mismatches mismatches(enabled);
+      for (std::size_t bucket = nextBucket++; bucketCount > bucket;
+           bucket = nextBucket++) {
+        std::array<Bucket, 2> buckets;
+        loadBucket(bucketDirectory / ("reference-" + std::to_string(bucket) +
+                                      ".sam"),
+                   buckets[0]);
+        loadBucket(bucketDirectory /
+                       ("new-" + std::to_string(bucket) + ".sam"),
+                   buckets[1]);
+        compareBucket(buckets[0], buckets[1], threadStatistics[t], mismatches);
+        mismatchFiles.append(mismatches);
+        const std::size_t compared = ++comparedBuckets;
+        if (0 == compared % std::max<std::size_t>(1, bucketCount / 10)) {
+          std::cerr << "Compared " << compared << " buckets...\n";
+        }
+      }
+    });
   }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  Statistics statistics;
+  for (const auto &s : threadStatistics) {
+    statistics += s;
+  }
+  if (!vm["keep-buckets"].as<bool>()) {
+    boost::filesystem::remove_all(bucketDirectory);
+  }
+
   if (vm["key-value"].as<bool>()) {
     std::cout << statistics << std::endl;
   } else {
@@ -403,61 +486,70 @@ bool Sam::operator==(const Sam &rhs) const {
          mapq_ == rhs.getMapq() and cigar_ == rhs.getCigar();
 }
 
-bool getSamRecords(std::istream &is, std::vector<Sam> &samRecords,
-                   SamBuffer &secondaryBuffers, SamBuffer &supplementaryBuffers,
-                   Sam &next) {
-  samRecords.clear();
-  secondaryBuffers.clear();
-  supplementaryBuffers.clear();
+
+std::size_t partition(const std::string &inputFile, BucketWriter &buckets) {
+  std::ifstream is(inputFile);
   if (!is) {
-    return false;
-  }
-  if (next.isSecondary()) {
-    secondaryBuffers.insert(std::make_pair(
-        std::make_pair(next.getName() + (next.isFirst() ? "1" : "2") +
-                           next.getCigar() + next.getSequence(),
-                       next.getPosition()),
-        next));
-  } else if (next.isSupplementary()) {
-    supplementaryBuffers.insert(std::make_pair(
-        std::make_pair(next.getName() + (next.isFirst() ? "1" : "2") +
-                           next.getCigar() + next.getSequence(),
-                       next.getPosition()),
-        next));
-  } else {
-    samRecords.push_back(next);
+    std::cerr << "failed to open " << inputFile << ": " << errno << ": "
+              << strerror(errno) << std::endl;
+    exit(2);
+  }
+  std::size_t records = 0;
+  std::string line;
+  while (getline(is, line)) {
+    // skip the headers
+    if (line.empty() || '@' == line[0]) {
+      continue;
+    }
+    buckets.add(line);
+    ++records;
   }
+  return records;
+}
+
+void loadBucket(const boost::filesystem::path &path, Bucket &bucket) {
+  // buckets without records have no file
+  std::ifstream is(path.string());
   std::string line;
-  Sam last = next;
-  while (getline(is, line) && ((next = line).getName() == last.getName())) {
+  Sam next;
+  while (getline(is, line)) {
+    next = line;
+    const AltID id(next.getName() + (next.isFirst() ? "1" : "2") +
+                       next.getCigar() + next.getSequence(),
+                   next.getPosition());
     if (next.isSecondary()) {
-      secondaryBuffers.insert(std::make_pair(
-          std::make_pair(next.getName() + (next.isFirst() ? "1" : "2") +
-                             next.getCigar() + next.getSequence(),
-                         next.getPosition()),
-          next));
+      bucket.secondaryBuffers.insert(std::make_pair(id, next));
     } else if (next.isSupplementary()) {
-      supplementaryBuffers.insert(std::make_pair(
-          std::make_pair(next.getName() + (next.isFirst() ? "1" : "2") +
-                             next.getCigar() + next.getSequence(),
-                         next.getPosition()),
-          next));
+      bucket.supplementaryBuffers.insert(std::make_pair(id, next));
     } else {
-      samRecords.push_back(next);
+      bucket.samRecords[next.getName()].push_back(next);
+    }
+  }
+}
+
+void compareBucket(Bucket &reference, Bucket &newRecords,
+                   Statistics &statistics, Mismatches &mismatches) {
+  // the keys of the alternative alignments include the read name
+  compareSecondary(reference.secondaryBuffers, newRecords.secondaryBuffers,
+                   statistics);
+  compareSupplementary(reference.supplementaryBuffers,
+                       newRecords.supplementaryBuffers, statistics);
+  std::vector<Sam> empty;
+  for (auto &kv : reference.samRecords) {
+    const auto found = newRecords.samRecords.find(kv.first);
+    compare(kv.second,
+            newRecords.samRecords.end() == found ? empty : found->second,
+            statistics, mismatches);
+  }
+  for (auto &kv : newRecords.samRecords) {
+    if (!reference.samRecords.count(kv.first)) {
+      compare(empty, kv.second, statistics, mismatches);
     }
-    last = next;
   }
-  return true;
 }
 
-void compareSingle(
-    const Sam &refRecord, const Sam &newRecord, Statistics &statistics,
-    std::ostream &positionMismatch, std::ostream &positionMismatchReference,
-    std::ostream &flagMismatch, std::ostream &flagMismatchReference,
-    std::ostream &cigarMismatch, std::ostream &cigarMismatchReference,
-    std::map<std::string, std::shared_ptr<std::ostream>> &tagMismatch,
-    std::map<std::string, std::shared_ptr<std::ostream>>
-        &tagMismatchReference) {
+void compareSingle(const Sam &refRecord, const Sam &newRecord,
+                   Statistics &statistics, Mismatches &mismatches) {
   if (refRecord.isUnmapped()) {
     if (newRecord.isUnmapped()) {
       ++statistics.unmapped.first;
@@ -490,9 +582,8 @@ void compareSingle(
     // both mapped at the same location - keep comparing
   } else {
     ++statistics.position[mapqBin].second;
-    if (positionMismatch && (3 != mapqBin)) {
-      positionMismatch << newRecord.getUnparsed() << std::endl;
-      positionMismatchReference << refRecord.getUnparsed() << std::endl;
+    if (3 != mapqBin) {
+      mismatches.add("positionMismatch", newRecord, refRecord);
     }
     return;
   }
@@ -501,9 +592,8 @@ void compareSingle(
       ++statistics.flags[i].first;
     } else {
       ++statistics.flags[i].second;
-      if (flagMismatch && (3 != mapqBin)) {
-        flagMismatch << newRecord.getUnparsed() << std::endl;
-        flagMismatchReference << refRecord.getUnparsed() << std::endl;
+      if (3 != mapqBin) {
+        mismatches.add("flagMismatch", newRecord, refRecord);
       }
     }
   }
@@ -516,20 +606,15 @@ void compareSingle(
     } else {
       ++statistics.mapqDirection[mapqBin].second;
     }
-    const std::string key = "MAPQ" + std::to_string(mapqBin);
-    const auto stream = tagMismatch.find(key);
-    if (tagMismatch.end() != stream) {
-      *stream->second << newRecord.getUnparsed() << std::endl;
-      *tagMismatchReference.at(key) << refRecord.getUnparsed() << std::endl;
-    }
+    mismatches.add("tagMAPQMismatch" + MAPQ_FILE_LABELS[mapqBin], newRecord,
+                   refRecord);
   }
   if (refRecord.getCigar() == newRecord.getCigar()) {
     ++statistics.cigar[mapqBin].first;
   } else {
     ++statistics.cigar[mapqBin].second;
-    if (cigarMismatch && (3 != mapqBin)) {
-      cigarMismatch << newRecord.getUnparsed() << std::endl;
-      cigarMismatchReference << refRecord.getUnparsed() << std::endl;
+    if (3 != mapqBin) {
+      mismatches.add("cigarMismatch", newRecord, refRecord);
     }
   }
 
@@ -542,13 +627,9 @@ void compareSingle(
           statistics.tags[kv.first].at(mapqBin).first++;
         } else {
           statistics.tags[kv.first].at(mapqBin).second++;
-          const std::string key = kv.first + std::to_string(mapqBin);
-          const auto stream = tagMismatch.find(key);
-          if (tagMismatch.end() != stream) {
-            *stream->second << newRecord.getUnparsed() << std::endl;
-            *tagMismatchReference.at(key)
-                << refRecord.getUnparsed() << std::endl;
-          }
+          mismatches.add("tag" + kv.first + "Mismatch" +
+                             MAPQ_FILE_LABELS[mapqBin],
+                         newRecord, refRecord);
         }
       } else {
         statistics.missingTags[kv.first]++;
@@ -567,34 +648,21 @@ void compareSingle(
 }
 
 void compare(std::vector<Sam> &referenceRecords, std::vector<Sam> &newRecords,
-             Statistics &statistics, std::ostream &missingMappings,
-             std::ostream &extraMappings, std::ostream &positionMismatch,
-             std::ostream &positionMismatchReference,
-             std::ostream &flagMismatch, std::ostream &flagMismatchReference,
-             std::ostream &cigarMismatch, std::ostream &cigarMismatchReference,
-             std::ostream &pairEndInfoMismatch,
-             std::ostream &pairEndInfoMismatchReference,
-             std::map<std::string, std::shared_ptr<std::ostream>> &tagMismatch,
-             std::map<std::string, std::shared_ptr<std::ostream>>
-                 &tagMismatchReference) {
+             Statistics &statistics, Mismatches &mismatches) {
   if (referenceRecords.empty() && newRecords.empty()) {
     std::cerr << "No SAM record to compare" << std::endl;
     exit(3);
   }
   if (newRecords.empty()) {
     for (const auto &refRec : referenceRecords) {
-      if (missingMappings) {
-        missingMappings << refRec.getUnparsed() << std::endl;
-      }
+      mismatches.add("missingMappings.sam", refRec);
       ++statistics.missing;
     }
     return;
   }
   if (referenceRecords.empty()) {
     for (const auto &newRec : newRecords) {
-      if (extraMappings) {
-        extraMappings << newRec.getUnparsed() << std::endl;
-      }
+      mismatches.add("extraMappings.sam", newRec);
       ++statistics.extra;
     }
     return;
@@ -633,17 +701,13 @@ void compare(std::vector<Sam> &referenceRecords, std::vector<Sam> &newRecords,
     Sam missingRec = referenceRecords[0].getFlag(6) == newRecords[0].getFlag(6)
                          ? referenceRecords[1]
                          : referenceRecords[0];
-    if (missingMappings) {
-      missingMappings << missingRec.getUnparsed() << std::endl;
-    }
+    mismatches.add("missingMappings.sam", missingRec);
     ++statistics.missing;
   } else if (referenceRecords.size() == 1 && newRecords.size() == 2) {
     Sam newRec = referenceRecords[0].getFlag(6) == newRecords[0].getFlag(6)
                      ? newRecords[1]
                      : newRecords[0];
-    if (extraMappings) {
-      extraMappings << newRec.getUnparsed() << std::endl;
-    }
+    mismatches.add("extraMappings.sam", newRec);
     ++statistics.extra;
   }
 
@@ -652,11 +716,7 @@ void compare(std::vector<Sam> &referenceRecords, std::vector<Sam> &newRecords,
     for (const auto &newRec : newRecords) {
       if (refRec.getFlag(6) == newRec.getFlag(6)) // both or neither
       {
-        compareSingle(refRec, newRec, statistics, positionMismatch,
-                      positionMismatchReference, flagMismatch,
-                      flagMismatchReference, cigarMismatch,
-                      cigarMismatchReference, tagMismatch,
-                      tagMismatchReference);
+        compareSingle(refRec, newRec, statistics, mismatches);
       }
     }
   }
@@ -760,6 +820,48 @@ std::ostream &operator<<(std::ostream &os, const Statistics &statistics) {
   return os;
 }
 
+Statistics &Statistics::operator+=(const Statistics &rhs) {
+  const auto add = [](Count &lhs, const Count &rhs) {
+    lhs.first += rhs.first;
+    lhs.second += rhs.second;
+  };
+  missing += rhs.missing;
+  extra += rhs.extra;
+  match += rhs.match;
+  mismatch += rhs.mismatch;
+  moreAlignments += rhs.moreAlignments;
+  lessAlignments += rhs.lessAlignments;
+  add(unmapped, rhs.unmapped);
+  add(mapped, rhs.mapped);
+  for (unsigned i = 0; 4 > i; ++i) {
+    add(position[i], rhs.position[i]);
+    add(mapq[i], rhs.mapq[i]);
+    add(mapqDirection[i], rhs.mapqDirection[i]);
+    add(cigar[i], rhs.cigar[i]);
+  }
+  for (unsigned i = 0; 12 > i; ++i) {
+    add(flags[i], rhs.flags[i]);
+  }
+  for (const auto &kv : rhs.tags) {
+    for (unsigned i = 0; 4 > i; ++i) {
+      add(tags[kv.first][i], kv.second[i]);
+    }
+  }
+  for (const auto &kv : rhs.missingTags) {
+    missingTags[kv.first] += kv.second;
+  }
+  for (const auto &kv : rhs.extraTags) {
+    extraTags[kv.first] += kv.second;
+  }
+  secondaryMissing += rhs.secondaryMissing;
+  secondaryExtra += rhs.secondaryExtra;
+  secondaryMatch += rhs.secondaryMatch;
+  supplementaryMissing += rhs.supplementaryMissing;
+  supplementaryExtra += rhs.supplementaryExtra;
+  supplementaryMatch += rhs.supplementaryMatch;
+  return *this;
+}
+
 unsigned Statistics::mapqBin(const int mapq) {
   if (255 == mapq)
     return 3; // MAPQ not available
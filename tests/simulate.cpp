@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+// simulate single-end or paired reads from all the sequences of a fasta
+// reference, with substitutions and indels, in parallel and reproducibly: the
+// reads are generated in fixed size chunks, each with its own random generator
+
+struct Contig {
+  std::string name;
+  std::string bases;
+};
+
+struct Parameters {
+  unsigned readLength;
+  double errorRate;
+  double indelRate;
+  double insertMean;
+  double insertStddev;
+  bool paired;
+  unsigned seed;
+};
+
+static const std::size_t CHUNK_READS = 1 << 14;
+// consecutive fragments overlapping an N or a sequence end before giving up
+static const std::size_t MAX_REJECTED = 1 << 20;
+
+static std::vector<Contig> loadFasta(const std::string &path) {
+  std::vector<Contig> contigs;
+  std::ifstream is(path);
+  if (!is) {
+    std::cerr << "failed to open " << path << ": " << errno << ": "
+              << strerror(errno) << std::endl;
+    exit(2);
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if ('>' == line[0]) {
+      const auto ws = line.find_first_of(" \t");
+      contigs.push_back(Contig{line.substr(1, ws - 1), ""});
+    } else if (!contigs.empty()) {
+      std::transform(line.begin(), line.end(), line.begin(), ::toupper);
+      contigs.back().bases += line;
+    }
+  }
+  return contigs;
+}
+
+static char complement(const char base) {
+  switch (base) {
+  case 'A':
+    return 'T';
+  case 'C':
+    return 'G';
+  case 'G':
+    return 'C';
+  case 'T':
+    return 'A';
+  default:
+    return 'N';
+  }
+}
+
+static std::string reverseComplement(const std::string &bases) {
+  std::string result(bases.rbegin(), bases.rend());
+  std::transform(result.begin(), result.end(), result.begin(), complement);
+  return result;
+}
+
+// copy readLength bases of the template with substitutions, insertions and
+// deletions at the requested rates
+static std::string mutate(const std::string &bases, const Parameters &p,
+                          std::mt19937_64 &generator) {
+  static const char BASES[] = "ACGT";
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::uniform_int_distribution<unsigned> other(1, 3);
+  std::string read;
+  read.reserve(p.readLength);
+  for (std::size_t i = 0; bases.size() > i && p.readLength > read.size();
+       ++i) {
+    const double draw = uniform(generator);
+    if (draw < p.indelRate / 2) {
+      // insertion before the base
+      read.push_back(BASES[other(generator)]);
+      --i;
+    } else if (draw < p.indelRate) {
+      // deletion of the base
+    } else if (draw < p.indelRate + p.errorRate) {
+      const char *base = std::find(BASES, BASES + 4, bases[i]);
+      read.push_back(BASES[(base - BASES + other(generator)) % 4]);
+    } else {
+      read.push_back(bases[i]);
+    }
+  }
+  return read;
+}
+
+static void appendRecord(std::string &fastq, const std::string &name,
+                         const std::string &bases) {
+  fastq += '@';
+  fastq += name;
+  fastq += '\n';
+  fastq += bases;
+  fastq += "\n+\n";
+  fastq.append(bases.size(), 'F');
+  fastq += '\n';
+}
+
+// fills the fastq records of both mates for the reads [begin, end)
+static void simulateChunk(const std::vector<Contig> &contigs,
+                          const std::vector<uint64_t> &offsets,
+                          const Parameters &p, const std::size_t chunk,
+                          const std::size_t begin, const std::size_t end,
+                          std::string &fastq1, std::string &fastq2) {
+  std::seed_seq seed{uint64_t(p.seed), uint64_t(chunk)};
+  std::mt19937_64 generator(seed);
+  std::uniform_int_distribution<uint64_t> offset(0, offsets.back() - 1);
+  std::normal_distribution<double> insert(p.insertMean, p.insertStddev);
+  std::bernoulli_distribution reverse(0.5);
+  // extra template bases to absorb the deletions
+  const unsigned margin = 8 + 4 * p.indelRate * p.readLength;
+  fastq1.clear();
+  fastq2.clear();
+  std::size_t rejected = 0;
+  for (std::size_t i = begin; end != i;) {
+    if (MAX_REJECTED < rejected++) {
+      std::cerr << "failed to find fragments of " << p.insertMean
+                << " bases without N in the reference" << std::endl;
+      exit(2);
+    }
+    const std::size_t length =
+        p.paired ? std::max<double>(p.readLength, std::round(insert(generator)))
+                 : p.readLength;
+    const uint64_t global = offset(generator);
+    const auto contig =
+        std::upper_bound(offsets.begin(), offsets.end(), global) -
+        offsets.begin() - 1;
+    const std::string &bases = contigs[contig].bases;
+    const uint64_t position = global - offsets[contig];
+    // the fragment is surrounded by margin bases on both sides
+    if (position + length + 2 * margin > bases.size()) {
+      continue;
+    }
+    const std::string window = bases.substr(position, length + 2 * margin);
+    if (std::string::npos != window.find_first_not_of("ACGT")) {
+      continue;
+    }
+    const std::string forward = window.substr(margin);
+    const std::string backward =
+        reverseComplement(window.substr(0, margin + length));
+    const bool isReverse = reverse(generator);
+    std::ostringstream name;
+    name << "sim_" << i << '_' << contigs[contig].name << '_'
+         << position + margin + 1 << '_' << length << '_'
+         << (isReverse ? 'r' : 'f');
+    appendRecord(fastq1, name.str(),
+                 mutate(isReverse ? backward : forward, p, generator));
+    if (p.paired) {
+      appendRecord(fastq2, name.str(),
+                   mutate(isReverse ? forward : backward, p, generator));
+    }
+    rejected = 0;
+    ++i;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  namespace po = boost::program_options;
+  po::options_description options(
+      "Usage: simulate -f reference.fa -o prefix [options]\n"
+      "simulate reads from all the sequences of 'reference.fa' into "
+      "prefix_1.fastq and prefix_2.fastq for paired reads, prefix.fastq "
+      "otherwise.\nThe read names encode the sequence, the 1-based position "
+      "and the length of the fragment and its strand.\n"
+      "Supported options are:");
+  options.add_options()("help", "produce help message")(
+      "fasta,f", po::value<std::string>(), "reference in FASTA format")(
+      "output,o", po::value<std::string>()->default_value("simulated"),
+      "prefix of the output fastq files")(
+      "reads,n", po::value<std::size_t>()->default_value(1000000),
+      "number of reads, or pairs of reads")(
+      "read-length,l", po::value<unsigned>()->default_value(151),
+      "length of the reads")(
+      "paired", po::value<bool>()->default_value(true),
+      "simulate pairs of reads in FR orientation")(
+      "error-rate", po::value<double>()->default_value(0.002),
+      "probability of a substitution at each base")(
+      "indel-rate", po::value<double>()->default_value(0.0002),
+      "probability of an insertion or deletion at each base")(
+      "insert-mean", po::value<double>()->default_value(350),
+      "mean of the normally distributed fragment length of the pairs")(
+      "insert-stddev", po::value<double>()->default_value(50),
+      "standard deviation of the fragment length of the pairs")(
+      "threads,t",
+      po::value<unsigned>()->default_value(std::thread::hardware_concurrency()),
+      "number of threads generating the reads")(
+      "seed", po::value<unsigned>()->default_value(1),
+      "seed of the random generators, the output only depends on it");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, options), vm);
+  po::notify(vm);
+  if (vm.count("help") || !vm.count("fasta")) {
+    std::cout << options << "\n";
+    return 1;
+  }
+  const Parameters p{vm["read-length"].as<unsigned>(),
+                     vm["error-rate"].as<double>(),
+                     vm["indel-rate"].as<double>(),
+                     vm["insert-mean"].as<double>(),
+                     vm["insert-stddev"].as<double>(),
+                     vm["paired"].as<bool>(),
+                     vm["seed"].as<unsigned>()};
+  const std::size_t reads = vm["reads"].as<std::size_t>();
+  const unsigned threads = std::max(1U, vm["threads"].as<unsigned>());
+  const std::string prefix = vm["output"].as<std::string>();
+
+  const std::vector<Contig> contigs = loadFasta(vm["fasta"].as<std::string>());
+  // sequences are sampled proportionally to their length
+  std::vector<uint64_t> offsets(1, 0);
+  for (const auto &contig : contigs) {
+    offsets.push_back(offsets.back() + contig.bases.size());
+  }
+  if (contigs.empty() || !offsets.back()) {
+    std::cerr << "no reference sequence found in "
+              << vm["fasta"].as<std::string>() << std::endl;
+    return 2;
+  }
+
+  std::vector<std::ofstream> os;
+  for (const auto &suffix : p.paired ? std::vector<std::string>{"_1", "_2"}
+                                     : std::vector<std::string>{""}) {
+    const std::string path = prefix + suffix + ".fastq";
+    os.emplace_back(path);
+    if (!os.back()) {
+      std::cerr << "failed to create " << path << ": " << errno << ": "
+                << strerror(errno) << std::endl;
+      return 2;
+    }
+  }
+
+  // one chunk per thread at a time, written in chunk order
+  const std::size_t chunks = (reads + CHUNK_READS - 1) / CHUNK_READS;
+  std::vector<std::string> fastq1(threads), fastq2(threads);
+  for (std::size_t first = 0; chunks > first; first += threads) {
+    const std::size_t count = std::min<std::size_t>(threads, chunks - first);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; count > t; ++t) {
+      const std::size_t chunk = first + t;
+      workers.emplace_back([&, t, chunk]() {
+        simulateChunk(contigs, offsets, p, chunk, chunk * CHUNK_READS,
+                      std::min(reads, (chunk + 1) * CHUNK_READS), fastq1[t],
+                      fastq2[t]);
+      });
+    }
+    for (std::size_t t = 0; count > t; ++t) {
+      workers[t].join();
+      os[0] << fastq1[t];
+      if (p.paired) {
+        os[1] << fastq2[t];
+      }
+    }
+  }
+  for (auto &stream : os) {
+    stream.flush();
+    if (!stream) {
+      std::cerr << "failed to write the reads: " << errno << ": "
+                << strerror(errno) << std::endl;
+      return 2;
+    }
+  }
+  std::cerr << "simulated " << reads << (p.paired ? " pairs" : " reads")
+            << " from " << contigs.size() << " sequences" << std::endl;
+  return 0;
+}
@@ -0,0 +1,251 @@
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/program_options.hpp>
+
+// run dragen-os on the same input with several thread counts and report the
+// throughput, the peak memory, the scaling efficiency and the per stage
+// profile of each run
+
+namespace bfs = boost::filesystem;
+
+struct Run {
+  unsigned threads;
+  double seconds;
+  double userSeconds;
+  double systemSeconds;
+  long maxRssKb;
+  std::string profile;
+};
+
+static std::size_t countReads(const std::string &path) {
+  std::ifstream file(path, std::ios_base::binary);
+  if (!file) {
+    std::cerr << "failed to open " << path << ": " << errno << ": "
+              << strerror(errno) << std::endl;
+    exit(2);
+  }
+  boost::iostreams::filtering_istream is;
+  if (boost::algorithm::ends_with(path, ".gz")) {
+    is.push(boost::iostreams::gzip_decompressor());
+  }
+  is.push(file);
+  std::size_t lines = 0;
+  std::string line;
+  while (std::getline(is, line)) {
+    ++lines;
+  }
+  return lines / 4;
+}
+
+static std::string readFile(const bfs::path &path) {
+  std::ifstream is(path.string());
+  std::ostringstream contents;
+  contents << is.rdbuf();
+  return contents.str();
+}
+
+// runs the command with stdout and stderr redirected to the log, returns false
+// if it could not start or did not succeed
+static bool execute(const std::vector<std::string> &command,
+                    const bfs::path &log, Run &run) {
+  std::vector<char *> argv;
+  for (const auto &argument : command) {
+    argv.push_back(const_cast<char *>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+  const auto start = std::chrono::steady_clock::now();
+  const pid_t pid = fork();
+  if (-1 == pid) {
+    std::cerr << "failed to fork: " << errno << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+  if (!pid) {
+    const int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (-1 == fd || -1 == dup2(fd, 1) || -1 == dup2(fd, 2)) {
+      _exit(127);
+    }
+    execvp(argv[0], argv.data());
+    std::cerr << "failed to execute " << argv[0] << ": " << errno << ": "
+              << strerror(errno) << std::endl;
+    _exit(127);
+  }
+  int status = 0;
+  struct rusage usage;
+  if (-1 == wait4(pid, &status, 0, &usage)) {
+    std::cerr << "failed to wait for " << command[0] << ": " << errno << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  run.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  run.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+  run.systemSeconds = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  run.maxRssKb = usage.ru_maxrss;
+  if (WIFSIGNALED(status)) {
+    std::cerr << command[0] << " was killed by signal " << WTERMSIG(status)
+              << ", see " << log << std::endl;
+    return false;
+  }
+  if (WEXITSTATUS(status)) {
+    std::cerr << command[0] << " failed with exit status "
+              << WEXITSTATUS(status) << ", see " << log << std::endl;
+    return false;
+  }
+  return true;
+}
+
+static void writeReport(std::ostream &os, const std::size_t reads,
+                        const bool paired, const std::vector<Run> &runs) {
+  const Run &base = runs.front();
+  os << std::fixed << std::setprecision(3) << "{\n  \"reads\": " << reads
+     << ",\n  \"paired\": " << (paired ? "true" : "false")
+     << ",\n  \"runs\": [";
+  for (const auto &run : runs) {
+    const double speedup = base.seconds / run.seconds;
+    os << (&run == &base ? "" : ",") << "\n    {\n      \"threads\": "
+       << run.threads << ",\n      \"seconds\": " << run.seconds
+       << ",\n      \"readsPerSecond\": " << reads / run.seconds
+       << ",\n      \"userSeconds\": " << run.userSeconds
+       << ",\n      \"systemSeconds\": " << run.systemSeconds
+       << ",\n      \"maxRssKb\": " << run.maxRssKb
+       << ",\n      \"speedup\": " << speedup
+       << ",\n      \"efficiency\": " << speedup * base.threads / run.threads
+       << ",\n      \"profile\": "
+       << (run.profile.empty() ? std::string("null") : run.profile)
+       << "\n    }";
+  }
+  os << "\n  ]\n}\n";
+}
+
+static void writeSummary(std::ostream &os, const std::size_t reads,
+                         const std::vector<Run> &runs) {
+  const Run &base = runs.front();
+  os << "threads\tseconds\treads/s\tcpu%\tmaxRssMb\tspeedup\tefficiency\n"
+     << std::fixed << std::setprecision(2);
+  for (const auto &run : runs) {
+    const double speedup = base.seconds / run.seconds;
+    os << run.threads << '\t' << run.seconds << '\t'
+       << std::setprecision(0) << reads / run.seconds << std::setprecision(2)
+       << '\t' << 100 * (run.userSeconds + run.systemSeconds) / run.seconds
+       << '\t' << run.maxRssKb / 1024.0 << '\t' << speedup << '\t'
+       << speedup * base.threads / run.threads << '\n';
+  }
+}
+
+int main(int argc, char *argv[]) {
+  namespace po = boost::program_options;
+  po::options_description options(
+      "Usage: throughput -r reference-dir -1 reads_1.fastq [-2 "
+      "reads_2.fastq] -o output [options] [-- dragen-os options]\n"
+      "run dragen-os on the reads once for each thread count, with the "
+      "profile enabled, and write\nthe throughput, peak RSS, scaling "
+      "efficiency and per stage profile of the runs into\n"
+      "output/throughput.json and output/throughput.tsv.\n"
+      "Supported options are:");
+  options.add_options()("help", "produce help message")(
+      "dragen-os", po::value<std::string>()->default_value("dragen-os"),
+      "dragen-os executable")("ref-dir,r", po::value<std::string>(),
+                              "directory with reference and hash tables")(
+      "fastq-file1,1", po::value<std::string>(), "FASTQ file (may be gzipped)")(
+      "fastq-file2,2", po::value<std::string>()->default_value(""),
+      "second FASTQ file with paired-end reads (may be gzipped)")(
+      "output,o", po::value<std::string>()->default_value("./"),
+      "output directory, with one sub-directory per run")(
+      "threads,t", po::value<std::string>()->default_value("1,2,4,8"),
+      "comma separated thread counts, the first one is the base of the "
+      "scaling efficiency")(
+      "reads,n", po::value<std::size_t>()->default_value(0),
+      "number of reads (or pairs) in the input, counted when 0")(
+      "dragen-os-option", po::value<std::vector<std::string>>(),
+      "additional dragen-os options, e.g. -- --Aligner.sw-all 1");
+  po::positional_options_description positional;
+  positional.add("dragen-os-option", -1);
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv)
+                .options(options)
+                .positional(positional)
+                .run(),
+            vm);
+  po::notify(vm);
+  if (vm.count("help") || !vm.count("ref-dir") || !vm.count("fastq-file1")) {
+    std::cout << options << "\n";
+    return 1;
+  }
+  const std::string fastq1 = vm["fastq-file1"].as<std::string>();
+  const std::string fastq2 = vm["fastq-file2"].as<std::string>();
+  const bfs::path output = vm["output"].as<std::string>();
+  std::vector<std::string> extra;
+  if (vm.count("dragen-os-option")) {
+    extra = vm["dragen-os-option"].as<std::vector<std::string>>();
+  }
+  std::vector<std::string> threadList;
+  boost::split(threadList, vm["threads"].as<std::string>(),
+               boost::is_any_of(","), boost::token_compress_on);
+
+  std::size_t reads = vm["reads"].as<std::size_t>();
+  if (!reads) {
+    reads = countReads(fastq1);
+  }
+
+  std::vector<Run> runs;
+  for (const auto &threads : threadList) {
+    Run run{static_cast<unsigned>(std::stoul(threads)), 0, 0, 0, 0, ""};
+    const bfs::path directory = output / ("threads-" + threads);
+    bfs::create_directories(directory);
+    std::vector<std::string> command{vm["dragen-os"].as<std::string>(),
+                                     "-r",
+                                     vm["ref-dir"].as<std::string>(),
+                                     "-1",
+                                     fastq1};
+    if (!fastq2.empty()) {
+      command.insert(command.end(), {"-2", fastq2});
+    }
+    command.insert(command.end(),
+                   {"--num-threads", threads, "--output-directory",
+                    directory.string(), "--output-file-prefix", "run",
+                    "--profile", "true"});
+    command.insert(command.end(), extra.begin(), extra.end());
+    std::cerr << "running " << boost::algorithm::join(command, " ")
+              << std::endl;
+    if (!execute(command, directory / "run.log", run)) {
+      return 2;
+    }
+    run.profile = readFile(directory / "run.perf.json");
+    boost::algorithm::trim(run.profile);
+    std::cerr << "done in " << run.seconds << " seconds" << std::endl;
+    runs.push_back(run);
+  }
+
+  std::ofstream json((output / "throughput.json").string());
+  writeReport(json, reads, !fastq2.empty(), runs);
+  std::ofstream tsv((output / "throughput.tsv").string());
+  writeSummary(tsv, reads, runs);
+  writeSummary(std::cout, reads, runs);
+  if (!json || !tsv) {
+    std::cerr << "failed to write the report into " << output << ": " << errno
+              << ": " << strerror(errno) << std::endl;
+    return 2;
+  }
+  return 0;
+}
@@ -11,6 +11,7 @@
 //
 //
 
+#define _POSIX_C_SOURCE 200809L  // for strdup under -std=c99
 #define __STDC_FORMAT_MACROS  // for PRIu64
 #include <assert.h>
 #include <ctype.h>
@@ -1639,11 +1640,13 @@ char* generateHashTable(hashTableConfig_t* config, int argc, char* argv[])
   if (bytes) {
     addrBits = 0;
     int sixtyfourths;
-    while (bytes && !(bytes & 1)) {
-      bytes >>= 1;
+    // decoded on a copy: bytes is the table capacity below
+    uint64_t units = bytes;
+    while (units && !(units & 1)) {
+      units >>= 1;
       addrBits++;
     }
-    if (bytes < 1 || bytes > 63) {
+    if (units < 1 || units > 63) {
       snprintf(
           ERR_MSG,
           sizeof(ERR_MSG),
@@ -1651,12 +1654,12 @@ char* generateHashTable(hashTableConfig_t* config, int argc, char* argv[])
           config->sizeStr);
       return ERR_MSG;
     }
-    while (bytes <= 32) {
-      bytes <<= 1;
+    while (units <= 32) {
+      units <<= 1;
       addrBits--;
     }
     addrBits += 6;
-    sixtyfourths           = bytes;
+    sixtyfourths           = units;
     cfghdr->tableAddrBits  = addrBits;
     cfghdr->tableSize64ths = sixtyfourths;
   }
@@ -440,6 +440,57 @@ void ReadGroupInsertStats::completeInitialization()
   m_finishedInitialization.notify_all();
 }
 
+//--------------------------------------------------------------------------------
+// Same as completeInitialization, with the stats coming from a previous run instead
+// of the initialization reads: none of the reads need remapping.
+//
+bool ReadGroupInsertStats::loadModel(std::istream& is)
+{
+  assert(m_initState == SENDING && 0 == m_intervals[0]->getNumSent());
+
+  const size_t to   = std::numeric_limits<uint8_t>::max();
+  const size_t from = to - m_intervalDelay - 1;
+
+  StatsInterval model(*m_intervals[from]);
+  if (!model.readModel(is)) {
+    return false;
+  }
+
+  for (size_t i = from; i < to; ++i) {
+    m_intervals[i]->copyStats(model);
+  }
+
+  if (m_rnaMode || !m_continuousUpdate || m_updateLogOnly) {
+    assert(!m_fixedStats);
+    m_fixedStats = new StatsInterval(model);
+  }
+
+  boost::unique_lock<boost::mutex> lock(m_init_mutex);
+  m_initState = DONE;
+  return true;
+}
+
+//--------------------------------------------------------------------------------
+// Find the stats worth reusing at the end of a run
+//
+const StatsInterval& ReadGroupInsertStats::getLatestStats() const
+{
+  if (m_fixedStats) {
+    return *m_fixedStats;
+  }
+
+  for (size_t i = 0; i < m_intervals.size(); ++i) {
+    const size_t idx = (m_sendingInterval + m_intervals.size() - i) % m_intervals.size();
+    if (m_intervals[idx]->isValid()) {
+      return *m_intervals[idx];
+    }
+  }
+
+  // the intervals preceding the first one are always valid
+  assert(false);
+  return *m_intervals[m_sendingInterval];
+}
+
 //--------------------------------------------------------------------------------adamb
 // When we know we've sent all of the records for a read group, someone may need
 // to wait until the results have arrived on the other side.  This does that.
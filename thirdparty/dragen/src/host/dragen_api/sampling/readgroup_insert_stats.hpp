@@ -126,6 +126,15 @@ public:
 
   void setInitDoneSending();
 
+  // The stats to reuse in another run: the fixed stats if any, else the most
+  // recently calculated interval
+  const StatsInterval& getLatestStats() const;
+
+  // Skip the initialization phase, starting with the stats written by
+  // StatsInterval::writeModel in a previous run. Must be called before sending
+  // any record.
+  bool loadModel(std::istream& is);
+
 private:
   void completeInitialization();
 
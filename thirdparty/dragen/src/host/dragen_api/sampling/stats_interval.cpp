@@ -11,6 +11,8 @@
 //
 
 #include "stats_interval.hpp"
+#include <iomanip>
+#include <limits>
 #include "dragen_run_log.hpp"
 #include "input_dbam_record.hpp"
 #include "kernel_density.hpp"
@@ -26,6 +28,9 @@ const double   StatsInterval::MAX_STDDEV                = 4.0;
 const double   StatsInterval::DEFAULT_RESCUE_SIGMAS     = 2.5;
 const uint32_t StatsInterval::DEFAULT_RESCUE_MIN_INSERT = 1;
 const uint32_t StatsInterval::DEFAULT_RESCUE_MAX_INSERT = 1000;
+const char* const StatsInterval::MODEL_HEADER =
+    "Q25\tQ50\tQ75\tS50\tLOW\tHIGH\tNPAIRS\tMEAN\tSTD\tMIN-INS\tMAX-INS\tSIGMA-FACTOR\tRESCUE-SIGMAS\t"
+    "RESCUE-CEIL-FACTOR\tRESCUE-RADIUS\tRESCUE-MIN-INS\tRESCUE-MAX-INS\tWARNING";
 
 //--------------------------------------------------------------------------------adamb
 // constructor
@@ -324,6 +329,59 @@ void StatsInterval::printDescriptiveLog(std::ostream& os) const
      << "(so they are not identical to TLEN)\n";
 }
 
+//--------------------------------------------------------------------------------
+// Write the calculated stats, in the MODEL_HEADER order, so that another run can
+// start with them instead of sampling. Doubles are written with full precision
+// to get back exactly the same insert stats.
+//
+void StatsInterval::writeModel(std::ostream& os) const
+{
+  const std::streamsize precision = os.precision(std::numeric_limits<double>::max_digits10);
+  os << m_q25 << "\t" << m_q50 << "\t" << m_q75 << "\t" << m_s50 << "\t";
+  os << m_low << "\t" << m_high << "\t" << m_numInsertsInMean << "\t";
+  os << m_mean << "\t" << m_stddev << "\t";
+  os << m_minInsert << "\t" << m_maxInsert << "\t" << m_insertSigmaFactor << "\t";
+  os << m_rescueSigmas << "\t" << m_rescueCeilFactor << "\t" << m_rescueRadius << "\t";
+  os << m_rescueMinInsert << "\t" << m_rescueMaxInsert << "\t";
+  os << static_cast<int>(m_warningMode);
+  os.precision(precision);
+}
+
+//--------------------------------------------------------------------------------
+// Read back the stats written by writeModel. The interval becomes valid on success.
+// The rescue settings given to the constructor (ceil factor and overrides) win over
+// the ones of the model, and an overridden rescue sigmas recomputes the rescue radius
+// and whichever of the rescue insert limits isn't overridden.
+//
+bool StatsInterval::readModel(std::istream& is)
+{
+  int      warningMode = WARN_OK;
+  double   rescueSigmas;
+  double   rescueCeilFactor;
+  uint32_t rescueMinInsert;
+  uint32_t rescueMaxInsert;
+  is >> m_q25 >> m_q50 >> m_q75 >> m_s50;
+  is >> m_low >> m_high >> m_numInsertsInMean;
+  is >> m_mean >> m_stddev;
+  is >> m_minInsert >> m_maxInsert >> m_insertSigmaFactor;
+  is >> rescueSigmas >> rescueCeilFactor >> m_rescueRadius;
+  is >> rescueMinInsert >> rescueMaxInsert;
+  is >> warningMode;
+  if (!is || WARN_OK > warningMode || WARN_TWENTYEIGHT < warningMode) {
+    return false;
+  }
+  if (!m_rescueSigmasOverridden) m_rescueSigmas = rescueSigmas;
+  if (!m_rescueMinOverridden) m_rescueMinInsert = rescueMinInsert;
+  if (!m_rescueMaxOverridden) m_rescueMaxInsert = rescueMaxInsert;
+  if (m_rescueSigmasOverridden) {
+    // the radius doesn't depend on the read length when the sigmas are overridden
+    updateRescueInsertLimits(0);
+  }
+  m_warningMode = static_cast<WarningMode>(warningMode);
+  m_valid       = true;
+  return true;
+}
+
 //--------------------------------------------------------------------------------adamb
 // If there weren't enough samples to get good stats, issue a warning.
 //
@@ -16,6 +16,7 @@
 #include <inttypes.h>
 #include <algorithm>
 #include <cmath>
+#include <istream>
 #include <ostream>
 #include <vector>
 
@@ -132,6 +133,13 @@ public:
 
   void printDescriptiveLog(std::ostream& os) const;
 
+  // Tab-separated column names of the values written by writeModel
+  static const char* const MODEL_HEADER;
+
+  void writeModel(std::ostream& os) const;
+
+  bool readModel(std::istream& is);
+
   void logError() const;
 
   void warnIfTooLittleData(std::ostream& os) const;